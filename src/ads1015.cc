@@ -139,10 +139,10 @@ extern "C" {
   
 }
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <memory>
-#include <map>
 #include <mutex>
 #include <string>
 #include <sstream>
@@ -152,6 +152,7 @@ extern "C" {
 #include <vector>
 
 #include "ads1015.h"
+#include "arbiter.h"
 #include "log.h"
 #include "templates.h"
 #include "util.h"
@@ -164,7 +165,12 @@ extern const std::vector< std::string > ads1015_ident {
 
 ads1015::ads1015( void )
   : i2c( default_addr ),
-    myConfigReg( default_config ) {
+    myConfigReg( default_config ), myReady( false ),
+    myLatency{ 0, std::chrono::microseconds( 0 ),
+	       std::chrono::microseconds( 0 ) },
+    myReadyMode( MODE::SINGLE_SHOT ),
+    myTiming{ std::chrono::microseconds( 0 ), 0, 1.0, 0.0, 0.0,
+	      std::chrono::steady_clock::time_point(), 0 } {
   
   _doInit();
   _check();
@@ -173,7 +179,12 @@ ads1015::ads1015( void )
   
 ads1015::ads1015( const int16_t addr )
   : i2c( addr ),
-    myConfigReg( default_config ) {
+    myConfigReg( default_config ), myReady( false ),
+    myLatency{ 0, std::chrono::microseconds( 0 ),
+	       std::chrono::microseconds( 0 ) },
+    myReadyMode( MODE::SINGLE_SHOT ),
+    myTiming{ std::chrono::microseconds( 0 ), 0, 1.0, 0.0, 0.0,
+	      std::chrono::steady_clock::time_point(), 0 } {
   
   _doInit();
   _check();
@@ -182,7 +193,12 @@ ads1015::ads1015( const int16_t addr )
 
 ads1015::ads1015( const std::string& bus, const int16_t addr )
   : i2c( bus, addr ),
-    myConfigReg( default_config ) {
+    myConfigReg( default_config ), myReady( false ),
+    myLatency{ 0, std::chrono::microseconds( 0 ),
+	       std::chrono::microseconds( 0 ) },
+    myReadyMode( MODE::SINGLE_SHOT ),
+    myTiming{ std::chrono::microseconds( 0 ), 0, 1.0, 0.0, 0.0,
+	      std::chrono::steady_clock::time_point(), 0 } {
   
   _doInit();
   _check();
@@ -198,6 +214,11 @@ ads1015::operator=( ads1015& ad ) {
   i2c::operator=( ad );
   
   myConfigReg = ad.myConfigReg;
+  myReady     = ad.myReady;
+  myAlert     = ad.myAlert;
+  myLatency   = ad.ready_latency();
+  myReadyMode = ad.myReadyMode;
+  myTiming    = ad.myTiming;
   
   return *this;
 }
@@ -209,8 +230,14 @@ ads1015::operator=( ads1015&& ad ) {
   i2c::operator=( ad );
   
   myConfigReg = ad.myConfigReg;
+  myReady     = ad.myReady;
+  myAlert     = std::move( ad.myAlert );
+  myLatency   = ad.ready_latency();
+  myReadyMode = ad.myReadyMode;
+  myTiming    = ad.myTiming;
   
   ad.myConfigReg = 0;
+  ad.myReady     = false;
   
   return *this;
 }
@@ -222,6 +249,23 @@ ads1015::reset( void ) {
   return i2c::_reset();
 }
 
+
+int
+ads1015::resync( void ) noexcept {
+
+  int     rVal = -1;
+  int32_t reg  = _read_cfg();
+
+  if( reg >= 0 ) {
+
+    myConfigReg = uint16_t( reg ) & ~OS_FIELD.mask;
+    rVal        = 0;
+
+  }
+
+  return rVal;
+}
+
   
 bool
 ads1015::_doInit( void ) noexcept {
@@ -230,7 +274,10 @@ ads1015::_doInit( void ) noexcept {
   
   if( i2c::_doInit()) {
     
-    // Write out the configuration register.
+    // Write out the configuration register. The mirror never holds
+    // the OS bit, start() sets it on the way out.
+
+    myConfigReg &= ~OS_FIELD.mask;
     
     if( _write_cfg() >= 0 )
       retVal = true;
@@ -244,171 +291,54 @@ ads1015::_doInit( void ) noexcept {
 void
 ads1015::_check( void ) noexcept {
 
-#ifdef _DPG_DEBUG
-  _check_masking< OS_x          >( OS_MAP          );
-  _check_masking< PGA_GAIN_x    >( PGA_GAIN_MAP    );
-  _check_masking< MODE_x        >( MODE_MAP        );
-  _check_masking< SAMPLE_RATE_x >( SAMPLE_RATE_MAP );
-  _check_masking< COMP_MODE_x   >( COMP_MODE_MAP   );
-  _check_masking< COMP_POL_x    >( COMP_POL_MAP    );
-  _check_masking< COMP_LAT_x    >( COMP_LAT_MAP    );
-  _check_masking< COMP_QUE_x    >( COMP_QUE_MAP    );
-
-  { assert( MUX_MAP.size());
-    
-    constexpr std::tuple< AINp_x, AINn_x > mask_tuple =
-      std::make_tuple< AINp_x, AINn_x >( AINp_x::_MASK, AINn_x::_MASK );
-    const uint16_t mask = MUX_MAP.at( mask_tuple );
-    for( const auto& [k,m] : MUX_MAP )
-      if( k != mask_tuple ) {
-	assert(( m & ~mask ) == 0 );
-	assert(( m &  mask ) == m );
-      }
-  }
-  
-  _check_bit_overlap< decltype( OS_MAP          ),
-		      decltype( MUX_MAP         )>( OS_MAP,
-						    MUX_MAP );
-  _check_bit_overlap< decltype( OS_MAP          ),
-		      decltype( PGA_GAIN_MAP    )>( OS_MAP,
-						    PGA_GAIN_MAP );
-  _check_bit_overlap< decltype( OS_MAP          ),
-		      decltype( MODE_MAP        )>( OS_MAP,
-						    MODE_MAP );
-  _check_bit_overlap< decltype( OS_MAP          ),
-		      decltype( SAMPLE_RATE_MAP )>( OS_MAP,
-						    SAMPLE_RATE_MAP );
-  _check_bit_overlap< decltype( OS_MAP          ),
-		      decltype( COMP_MODE_MAP   )>( OS_MAP,
-						    COMP_MODE_MAP );
-  _check_bit_overlap< decltype( OS_MAP          ),
-		      decltype( COMP_POL_MAP    )>( OS_MAP,
-						    COMP_POL_MAP );
-  _check_bit_overlap< decltype( OS_MAP          ),
-		      decltype( COMP_LAT_MAP    )>( OS_MAP,
-						    COMP_LAT_MAP );
-  _check_bit_overlap< decltype( OS_MAP          ),
-		      decltype( COMP_QUE_MAP    )>( OS_MAP,
-						    COMP_QUE_MAP );
-  
-  _check_bit_overlap< decltype( MUX_MAP         ),
-		      decltype( PGA_GAIN_MAP    )>( MUX_MAP,
-						    PGA_GAIN_MAP );
-  _check_bit_overlap< decltype( MUX_MAP         ),
-		      decltype( MODE_MAP        )>( MUX_MAP, 
-						    MODE_MAP );
-  _check_bit_overlap< decltype( MUX_MAP         ),
-		      decltype( SAMPLE_RATE_MAP )>( MUX_MAP,
-						    SAMPLE_RATE_MAP );
-  _check_bit_overlap< decltype( MUX_MAP         ),
-		      decltype( COMP_MODE_MAP   )>( MUX_MAP,
-						    COMP_MODE_MAP );
-  _check_bit_overlap< decltype( MUX_MAP         ),
-		      decltype( COMP_POL_MAP    )>( MUX_MAP,
-						    COMP_POL_MAP );
-  _check_bit_overlap< decltype( MUX_MAP         ),
-		      decltype( COMP_LAT_MAP    )>( MUX_MAP,
-						    COMP_LAT_MAP );
-  _check_bit_overlap< decltype( MUX_MAP         ),
-		      decltype( COMP_QUE_MAP    )>( MUX_MAP,
-						    COMP_QUE_MAP );
-  
-  _check_bit_overlap< decltype( PGA_GAIN_MAP    ),
-		      decltype( MODE_MAP        )>( PGA_GAIN_MAP,
-						    MODE_MAP );
-  _check_bit_overlap< decltype( PGA_GAIN_MAP    ),
-		      decltype( SAMPLE_RATE_MAP )>( PGA_GAIN_MAP,
-						    SAMPLE_RATE_MAP );
-  _check_bit_overlap< decltype( PGA_GAIN_MAP    ),
-		      decltype( COMP_MODE_MAP   )>( PGA_GAIN_MAP,
-						    COMP_MODE_MAP );
-  _check_bit_overlap< decltype( PGA_GAIN_MAP    ),
-		      decltype( COMP_POL_MAP    )>( PGA_GAIN_MAP,
-						    COMP_POL_MAP );
-  _check_bit_overlap< decltype( PGA_GAIN_MAP    ),
-		      decltype( COMP_LAT_MAP    )>( PGA_GAIN_MAP,
-						    COMP_LAT_MAP );
-  _check_bit_overlap< decltype( PGA_GAIN_MAP    ),
-		      decltype( COMP_QUE_MAP    )>( PGA_GAIN_MAP,
-						    COMP_QUE_MAP );
-  
-  _check_bit_overlap< decltype( MODE_MAP        ),
-		      decltype( SAMPLE_RATE_MAP )>( MODE_MAP,
-						    SAMPLE_RATE_MAP );    
-  _check_bit_overlap< decltype( MODE_MAP        ),
-		      decltype( COMP_MODE_MAP   )>( MODE_MAP,
-						    COMP_MODE_MAP );
-  _check_bit_overlap< decltype( MODE_MAP        ),
-		      decltype( COMP_POL_MAP    )>( MODE_MAP,
-						    COMP_POL_MAP );
-  _check_bit_overlap< decltype( MODE_MAP        ),
-		      decltype( COMP_LAT_MAP    )>( MODE_MAP,
-						    COMP_LAT_MAP );
-  _check_bit_overlap< decltype( MODE_MAP        ),
-		      decltype( COMP_QUE_MAP    )>( MODE_MAP,
-						    COMP_QUE_MAP );
-  
-  _check_bit_overlap< decltype( SAMPLE_RATE_MAP ),
-		      decltype( COMP_MODE_MAP   )>( SAMPLE_RATE_MAP,
-						    COMP_MODE_MAP );
-  _check_bit_overlap< decltype( SAMPLE_RATE_MAP ),
-		      decltype( COMP_POL_MAP    )>( SAMPLE_RATE_MAP,
-						    COMP_POL_MAP );
-  _check_bit_overlap< decltype( SAMPLE_RATE_MAP ),
-		      decltype( COMP_LAT_MAP    )>( SAMPLE_RATE_MAP,
-						    COMP_LAT_MAP );
-  _check_bit_overlap< decltype( SAMPLE_RATE_MAP ),
-		      decltype( COMP_QUE_MAP    )>( SAMPLE_RATE_MAP,
-						    COMP_QUE_MAP );
-  
-  _check_bit_overlap< decltype( COMP_MODE_MAP   ),
-		      decltype( COMP_POL_MAP    )>( COMP_MODE_MAP,
-						    COMP_POL_MAP );
-  _check_bit_overlap< decltype( COMP_MODE_MAP   ),
-		      decltype( COMP_LAT_MAP    )>( COMP_MODE_MAP,
-						    COMP_LAT_MAP );
-  _check_bit_overlap< decltype( COMP_MODE_MAP   ),
-		      decltype( COMP_QUE_MAP    )>( COMP_MODE_MAP,
-						    COMP_QUE_MAP );
-  
-  _check_bit_overlap< decltype( COMP_POL_MAP    ),
-		      decltype( COMP_LAT_MAP    )>( COMP_POL_MAP,
-						    COMP_LAT_MAP );
-  _check_bit_overlap< decltype( COMP_POL_MAP    ),
-		      decltype( COMP_QUE_MAP    )>( COMP_POL_MAP,
-						    COMP_QUE_MAP );
-  
-  _check_bit_overlap< decltype( COMP_LAT_MAP    ),
-		      decltype( COMP_QUE_MAP    )>( COMP_LAT_MAP,
-						    COMP_QUE_MAP );
-  
-  assert( gain_xlate_f.size() == gain_xlate_r.size());
-  for( const auto& i : gain_xlate_f )
-    assert( i.first == gain_xlate_r.at( i.second ));
-  for( const auto& i : gain_xlate_r )
-    assert( i.first == gain_xlate_f.at( i.second ));
-
-  assert( rate_xlate_f.size() == rate_xlate_r.size());
-  for( const auto& i : rate_xlate_f )
-    assert( i.first == rate_xlate_r.at( i.second ));
-  for( const auto& i : rate_xlate_r )
-    assert( i.first == rate_xlate_f.at( i.second ));
+  // The field tables are consistent and the fields tile the
+  // configuration register.
+
+  static_assert( OS_FIELD.ok()          && MUX_FIELD.ok()
+		 && PGA_GAIN_FIELD.ok()  && MODE_FIELD.ok()
+		 && SAMPLE_RATE_FIELD.ok()
+		 && COMP_MODE_FIELD.ok() && COMP_POL_FIELD.ok()
+		 && COMP_LAT_FIELD.ok()  && COMP_QUE_FIELD.ok());
+  static_assert( _disjoint< uint16_t >({ OS_FIELD.mask,
+					 MUX_FIELD.mask,
+					 PGA_GAIN_FIELD.mask,
+					 MODE_FIELD.mask,
+					 SAMPLE_RATE_FIELD.mask,
+					 COMP_MODE_FIELD.mask,
+					 COMP_POL_FIELD.mask,
+					 COMP_LAT_FIELD.mask,
+					 COMP_QUE_FIELD.mask }) == 0xffff );
+  static_assert( gain_mv.size()  == size_t( PGA_GAIN_x::FS_256     ) + 1 );
+  static_assert( rate_sps.size() == size_t( SAMPLE_RATE_x::SR_3300 ) + 1 );
+  static_assert( MUX_FIELD.decode( default_config ) == MUX_x::DIFF01 );
+  static_assert( PGA_GAIN_FIELD.decode( default_config )
+		 == PGA_GAIN_x::FS_2048 );
+  static_assert( SAMPLE_RATE_FIELD.decode( default_config )
+		 == SAMPLE_RATE_x::SR_1600 );
+
+  static constexpr uint8_t lo_code[] = { 0x80, 0x00 }, hi_code[] = { 0x7f, 0xf0 };
+
+  static_assert( code( lo_code ) == -2048 );
+  static_assert( code( hi_code ) ==  2047 );
+  static_assert( scale( PGA_GAIN::FS_6144 ) == 0.003f );
+  static_assert( scale( PGA_GAIN::FS_256  ) == 0.000125f );
   
+#ifdef _DPG_DEBUG
   decltype( myConfigReg ) cfg = myConfigReg;
  
-  for( const auto& [e,i] : gain_xlate_f ) {
+  for( size_t e = 1; e < gain_mv.size(); ++e ) {
     gain( static_cast< PGA_GAIN >( e ));
-    assert( i_gain() == i );
-    i_gain( i );
+    assert( i_gain() == gain_mv[e] );
+    i_gain( gain_mv[e] );
     assert( gain() == static_cast< PGA_GAIN >( e ));
   }
   
-  for( const auto& [e,i] : rate_xlate_f ) {
+  for( size_t e = 1; e < rate_sps.size(); ++e ) {
     rate( static_cast< SAMPLE_RATE >( e ));
-    assert( i_rate() == i );
-    i_rate( i );
+    assert( i_rate() == rate_sps[e] );
+    i_rate( rate_sps[e] );
     assert( rate() == static_cast< SAMPLE_RATE >( e ));
-  }    
+  }
   
   myConfigReg = cfg;
   _write_cfg();
@@ -421,19 +351,17 @@ ads1015::_check( void ) noexcept {
 int32_t
 ads1015::_write_cfg( void ) const noexcept {
   
-  const uint8_t w_buf[] = { REG_CFG,
-			    uint8_t(( myConfigReg & 0xff00 ) >> 8 ),
-			    uint8_t(  myConfigReg & 0x00ff )
-  };
-  int32_t rVal = sizeof( w_buf );
+  // The register is sent MSB first.
+
+  int32_t rVal = 3;
     
-  size_t w_num = _write( w_buf, sizeof( w_buf ));
+  ssize_t w_num = _write_word( REG_CFG, myConfigReg );
   
-  if( w_num != sizeof( w_buf )) {
+  if( w_num != rVal ) {
     
     _LOG_WARN(( _id( "Failure to write to configuration register" ),
-		"w_num=", w_num, ", val=",
-		_vtoa( w_buf, sizeof( w_buf )), errno2str()));
+		"w_num=", w_num, ", val=", t2hex( myConfigReg ),
+		errno2str()));
     rVal = -1;
     
   } 
@@ -445,37 +373,25 @@ ads1015::_write_cfg( void ) const noexcept {
 int32_t
 ads1015::_read_cfg(  void ) const noexcept {
   
-  constexpr uint8_t w_buf[] = { REG_CFG };
-            uint8_t r_buf[] = { 0x00, 0x00 };
+  uint16_t w    = 0;
   int32_t  rVal = -1;
 
-  ssize_t w_num = _write( w_buf, sizeof( w_buf ));
-  ssize_t r_num = _read(  r_buf, sizeof( r_buf ));
+  // Select the register and read it back.
   
-  if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Failure to set configuration register" ),
-		"w_num=", w_num, "val=", _vtoa( w_buf, sizeof( w_buf )),
-		errno2str()));
-    
-  } else
-    if( r_num != sizeof( r_buf )) {
-      
-      _LOG_WARN(( _id( "Failure to read configuration register" ),
-		  "r_num=", r_num, errno2str()));
+  ssize_t r_num = _read_word( REG_CFG, w );
+
+  if( r_num != sizeof( w )) {
       
-    } else {
+    _LOG_WARN(( _id( "Failure to read configuration register" ),
+		"r_num=", r_num, errno2str()));
       
-      // Convert the read data to a return value.  Note that the sign
-      // is zero thereby indicating no error.
+  } else {
       
-      for( int i = 0; i < r_num; ++i ) {
-	rVal <<= 8;
-	rVal |= r_buf[ i ];
-      }
-      rVal &= 0xffff;
+    // Note that the sign is zero thereby indicating no error.
       
-    }
+    rVal = w;
+
+  }
   
   return rVal;
 }
@@ -483,9 +399,20 @@ ads1015::_read_cfg(  void ) const noexcept {
 
 const ads1015::OS
 ads1015::os( void ) const noexcept {
+
+  // The one dynamic bit so it comes from the device.
+
+  OS_x    rVal = OS_x::_NONE;
+  int32_t reg  = _read_cfg();
   
-  return static_cast< OS >
-    ( _reg_read_map_cfg< OS_x >( OS_MAP ));
+  if( reg < 0 )
+    _LOG_WARN(( _id( "Failed to read config register." )));
+  else
+    rVal = OS_FIELD.decode( uint16_t( reg ));
+
+  // Note: A "none" is expected while a conversion is in progress.
+
+  return static_cast< OS >( rVal );
 }
 
 
@@ -494,9 +421,9 @@ ads1015::os( const OS o ) {
   
   if( o == OS::BEGIN ) {
     
-    myConfigReg |= OS_MAP.at( OS_x::BEGIN );
+    myConfigReg |= OS_FIELD.mask;
     _write_cfg();
-    myConfigReg &= ~OS_MAP.at( OS_x::BEGIN );
+    myConfigReg &= ~OS_FIELD.mask;
     
   }
   
@@ -508,15 +435,15 @@ const ads1015::PGA_GAIN
 ads1015::gain( void ) const noexcept {
   
   return static_cast< PGA_GAIN >
-    ( _reg_read_map_cfg< PGA_GAIN_x >( PGA_GAIN_MAP ));
+    ( _reg_read_map_cfg( PGA_GAIN_FIELD ));
 }
 
 
 const ads1015::PGA_GAIN
 ads1015::gain( const PGA_GAIN g ) {
   
-  (void)_reg_write_map_cfg< PGA_GAIN_x >
-    ( static_cast< PGA_GAIN_x >( g ), PGA_GAIN_MAP );
+  (void)_reg_write_map_cfg
+    ( static_cast< PGA_GAIN_x >( g ), PGA_GAIN_FIELD );
   
   return gain();
 }
@@ -525,23 +452,24 @@ ads1015::gain( const PGA_GAIN g ) {
 const int
 ads1015::i_gain( void ) const noexcept {
   
-  decltype( gain_xlate_f )::const_iterator
-    it = gain_xlate_f.find( static_cast< PGA_GAIN_x >( gain()));
+  const int g = int( gain());
 
-  assert( it != gain_xlate_f.end());
+  assert(( g > 0 ) && ( size_t( g ) < gain_mv.size()));
 
-  return  it->second;
+  return ( g > 0 ) ? gain_mv[ g ] : 0;
 }
 
 
 const int
 ads1015::i_gain( const int i_g ) {
   
-  decltype( gain_xlate_r )::const_iterator
-    it = gain_xlate_r.find( i_g );
+  size_t g = 1;
 
-  if( it != gain_xlate_r.end())
-    gain( static_cast< PGA_GAIN >( it->second ));
+  while(( g < gain_mv.size()) && ( gain_mv[ g ] != i_g ))
+    ++g;
+
+  if( g < gain_mv.size())
+    gain( static_cast< PGA_GAIN >( g ));
   else
     _LOG_ERR(( _id( "I am lost to set gain" ), ", from ", quote( i_g )));
   
@@ -553,15 +481,15 @@ const ads1015::MODE
 ads1015::mode( void ) const noexcept {
   
   return static_cast< MODE >
-    ( _reg_read_map_cfg< MODE_x >( MODE_MAP ));
+    ( _reg_read_map_cfg( MODE_FIELD ));
 }
 
 
 const ads1015::MODE
 ads1015::mode( const MODE m ) {
   
-  (void)_reg_write_map_cfg< MODE_x >
-    ( static_cast< MODE_x >( m ), MODE_MAP );
+  (void)_reg_write_map_cfg
+    ( static_cast< MODE_x >( m ), MODE_FIELD );
   
   return mode();
 }
@@ -571,15 +499,15 @@ const ads1015::SAMPLE_RATE
 ads1015::rate( void ) const noexcept {
   
   return static_cast< SAMPLE_RATE>
-    ( _reg_read_map_cfg< SAMPLE_RATE_x >( SAMPLE_RATE_MAP ));
+    ( _reg_read_map_cfg( SAMPLE_RATE_FIELD ));
 }
 
 
 const ads1015::SAMPLE_RATE
 ads1015::rate( const SAMPLE_RATE r ) {
   
-  (void)_reg_write_map_cfg< SAMPLE_RATE_x >
-    ( static_cast< SAMPLE_RATE_x >( r ), SAMPLE_RATE_MAP );
+  (void)_reg_write_map_cfg
+    ( static_cast< SAMPLE_RATE_x >( r ), SAMPLE_RATE_FIELD );
   
   return rate();
 }
@@ -588,12 +516,11 @@ ads1015::rate( const SAMPLE_RATE r ) {
 const int
 ads1015::i_rate( void ) const noexcept {
   
-  decltype( rate_xlate_f )::const_iterator
-    it = rate_xlate_f.find( static_cast< SAMPLE_RATE_x >( rate()));
-  
-  assert( it != rate_xlate_f.end());
+  const int r = int( rate());
+
+  assert(( r > 0 ) && ( size_t( r ) < rate_sps.size()));
   
-  return it->second;
+  return ( r > 0 ) ? rate_sps[ r ] : 0;
 }
 
 
@@ -601,11 +528,13 @@ const int
 ads1015::i_rate( const int i_r ) {
 
 
-  decltype( rate_xlate_r )::const_iterator
-    it = rate_xlate_r.find( i_r );
+  size_t r = 1;
+
+  while(( r < rate_sps.size()) && ( rate_sps[ r ] != i_r ))
+    ++r;
 
-  if( it != rate_xlate_r.end())
-    rate( static_cast< SAMPLE_RATE >( it->second ));
+  if( r < rate_sps.size())
+    rate( static_cast< SAMPLE_RATE >( r ));
   else    
     _LOG_ERR(( _id( "I am lost to set sample rate" ), ", from ",
 	       quote( i_r )));
@@ -618,15 +547,15 @@ const ads1015::COMP_MODE
 ads1015::comp_mode( void ) const noexcept {
   
   return static_cast< COMP_MODE >
-    ( _reg_read_map_cfg< COMP_MODE_x >( COMP_MODE_MAP ));
+    ( _reg_read_map_cfg( COMP_MODE_FIELD ));
 }
 
 
 const ads1015::COMP_MODE
 ads1015::comp_mode( const COMP_MODE m ) {
   
-  (void)_reg_write_map_cfg< COMP_MODE_x >
-    ( static_cast< COMP_MODE_x >( m ), COMP_MODE_MAP );
+  (void)_reg_write_map_cfg
+    ( static_cast< COMP_MODE_x >( m ), COMP_MODE_FIELD );
   
   return comp_mode();
 }
@@ -636,15 +565,15 @@ const ads1015::COMP_POL
 ads1015::comp_pol( void ) const noexcept {
   
   return static_cast< COMP_POL >
-    ( _reg_read_map_cfg< COMP_POL_x >( COMP_POL_MAP ));
+    ( _reg_read_map_cfg( COMP_POL_FIELD ));
 }
 
 
 const ads1015::COMP_POL
 ads1015::comp_pol( const COMP_POL p ) {
   
-  (void)_reg_write_map_cfg< COMP_POL_x >
-    ( static_cast< COMP_POL_x >( p ), COMP_POL_MAP );
+  (void)_reg_write_map_cfg
+    ( static_cast< COMP_POL_x >( p ), COMP_POL_FIELD );
   
   return comp_pol();
 }
@@ -654,14 +583,14 @@ const ads1015::COMP_LAT
 ads1015::comp_lat( void ) const noexcept {
   
   return static_cast < COMP_LAT >
-    ( _reg_read_map_cfg< COMP_LAT_x >( COMP_LAT_MAP ));
+    ( _reg_read_map_cfg( COMP_LAT_FIELD ));
 }
 
 const ads1015::COMP_LAT
 ads1015::comp_lat( const COMP_LAT l ) {
   
-  (void)_reg_write_map_cfg< COMP_LAT_x >
-    ( static_cast< COMP_LAT_x >( l ), COMP_LAT_MAP );
+  (void)_reg_write_map_cfg
+    ( static_cast< COMP_LAT_x >( l ), COMP_LAT_FIELD );
   
   return comp_lat();
 }
@@ -671,144 +600,991 @@ const ads1015::COMP_QUE
 ads1015::comp_que( void ) const noexcept {
   
   return static_cast< COMP_QUE >
-    ( _reg_read_map_cfg< COMP_QUE_x >( COMP_QUE_MAP ));
+    ( _reg_read_map_cfg( COMP_QUE_FIELD ));
 }
 
 
 const ads1015::COMP_QUE
 ads1015::comp_que( const COMP_QUE q ) {
   
-  (void)_reg_write_map_cfg< COMP_QUE_x >
-    ( static_cast< COMP_QUE_x >( q ), COMP_QUE_MAP );
+  (void)_reg_write_map_cfg
+    ( static_cast< COMP_QUE_x >( q ), COMP_QUE_FIELD );
   
   return comp_que();
 }
 
 
-const std::tuple< ads1015::AINp_x, ads1015::AINn_x >
+const ads1015::MUX_x
 ads1015::_mux( void ) const noexcept {
   
-            std::tuple< AINp_x, AINn_x >  rVal {
-	      AINp_x::_NONE, AINn_x::_NONE
-	    };
-  constexpr std::tuple< AINp_x, AINn_x > _mask {
-	      AINp_x::_MASK, AINn_x::_MASK
-  };
-  int32_t reg = _read_cfg();
+  return _reg_read_map_cfg( MUX_FIELD );
+}
+
+
+const ads1015::MUX_x
+ads1015::_mux( const MUX_x m ) {
   
-  if( reg >= 0 ) {
-      
-    const uint16_t mask = MUX_MAP.at( _mask );
-    
-    for( const auto& [k,m] : MUX_MAP )
-      if( k != _mask )
-	if(( reg & mask ) == m ) {
-	  std::get<0>( rVal ) = std::get<0>( k );
-	  std::get<1>( rVal ) = std::get<1>( k );
-	  break;
+  (void)_reg_write_map_cfg( m, MUX_FIELD );
+  
+  return _mux();
+}
+
+
+const float
+ads1015::operator[]( const CREG& r ) {
+  
+  const int16_t c = raw( r );
+
+  return ( c == no_code ) ? 0.0 : float( c ) * scale();
+}
+
+
+int16_t
+ads1015::raw( const CREG& r ) {
+
+  int16_t rVal = no_code;
+
+  // Conversion-ready or not, start the conversion and wait for it.
+  // Edges from earlier conversions are stale.
+
+  std::chrono::steady_clock::time_point ready;
+
+  if( myReady && myAlert )
+    (void)myAlert->flush();
+
+  // Not started and the conversion register is a stale conversion.
+
+  if( start( r ) < 0 )
+    return rVal;
+
+  if( myReady )
+    ready = _ready_wait( std::chrono::steady_clock::now());
+  else
+    std::this_thread::sleep_for( conv_wait());
+
+  uint16_t w = 0;
+
+  // Select the conversion register and read it.
+
+  ssize_t r_num = _read_word( REG_CONV, w );
+
+  if( r_num != sizeof( w )) {
+
+    _LOG_WARN(( _id( "Failure to read conversion register" ),
+		"r_num=", r_num, errno2str()));
+
+  } else {
+
+    const uint8_t r_buf[] { uint8_t( w >> 8 ), uint8_t( w & 0xff ) };
+
+    rVal = code( r_buf );
+
+  }
+
+  if( myReady )
+    ready_latency( ready );
+
+  return rVal;
+}
+
+
+void
+ads1015::ready_latency( const std::chrono::steady_clock::time_point ready )
+  noexcept {
+
+  const auto l = std::chrono::duration_cast< std::chrono::microseconds >
+    ( std::chrono::steady_clock::now() - ready );
+
+  std::lock_guard< std::mutex > lck( myLatencyLock );
+
+  ++myLatency.count;
+  myLatency.total += l;
+  if( l > myLatency.max )
+    myLatency.max = l;
+}
+
+
+std::chrono::steady_clock::time_point
+ads1015::_ready_wait( const std::chrono::steady_clock::time_point t0 )
+  noexcept {
+
+  // Give up at twice the worst case, then read whatever is there.
+
+  const auto deadline = t0 + 2 * conv_wait();
+
+  std::chrono::steady_clock::time_point rVal;
+
+  if( myAlert ) {
+
+    const auto timeout = std::chrono::duration_cast
+      < std::chrono::microseconds >( deadline - t0 );
+
+    if( myAlert->wait( timeout, rVal ) == 1 )
+      return rVal;
+
+    _LOG_VERB(( _id( "No ALERT/RDY edge, polling" )));
+
+  } else {
+
+    const int sps = rate_sps[ int( _reg_read_map_cfg( SAMPLE_RATE_FIELD ))];
+
+    std::this_thread::sleep_until
+      ( t0 + std::chrono::microseconds
+	( int64_t( poll_sleep_pct ) * 1000000 / ( 100 * sps )));
+
+  }
+
+  // Poll the OS bit.
+
+  auto interval = poll_first;
+
+  while( true ) {
+
+    const bool ready = ( os() == OS::CONVERSION_READY );
+
+    rVal = std::chrono::steady_clock::now();
+
+    if( ready )
+      break;
+
+    if( rVal >= deadline ) {
+      _LOG_WARN(( _id( "Conversion not ready in time" )));
+      break;
+    }
+
+    std::this_thread::sleep_for( interval );
+    interval = std::min( 2 * interval, poll_last );
+
+  }
+
+  return rVal;
+}
+
+
+int
+ads1015::conv_ready( const bool on,
+		     std::shared_ptr< alert_line > line ) noexcept {
+
+  // The thresholds first so the comparator never runs with a stale
+  // pair.
+
+  const uint16_t lo = on ? uint16_t( 0x0000 ) : default_lo_thresh;
+  const uint16_t hi = on ? uint16_t( 0x8000 ) : default_hi_thresh;
+
+  if(( _write_word( REG_LO_THRESH, lo ) != 3 )
+     || ( _write_word( REG_HI_THRESH, hi ) != 3 )) {
+    _LOG_WARN(( _id( "Failed to write the thresholds" ), errno2str()));
+    return -1;
+  }
+
+  if( _reg_write_map_cfg( on ? COMP_QUE_x::ONE : COMP_QUE_x::DISABLE,
+			  COMP_QUE_FIELD ) < 0 )
+    return -1;
+
+  // A continuous converter's OS bit never reads ready.
+
+  if( on && !myReady ) {
+
+    myReadyMode = mode();
+
+    if( _reg_write_map_cfg( MODE_x::SINGLE_SHOT, MODE_FIELD ) < 0 )
+      return -1;
+
+  } else
+    if( !on && myReady &&
+	( _reg_write_map_cfg( static_cast< MODE_x >( myReadyMode ),
+			      MODE_FIELD ) < 0 ))
+      return -1;
+
+  myReady = on;
+  myAlert = on ? line : nullptr;
+
+  return 0;
+}
+
+
+int
+ads1015::thresholds( const int16_t lo, const int16_t hi ) noexcept {
+
+  int rVal = 0;
+
+  if(( _write_word( REG_LO_THRESH, _thresh_reg( lo )) != 3 )
+     || ( _write_word( REG_HI_THRESH, _thresh_reg( hi )) != 3 )) {
+    _LOG_WARN(( _id( "Failed to write the thresholds" ), errno2str()));
+    rVal = -1;
+  }
+
+  return rVal;
+}
+
+
+ssize_t
+ads1015::queue_thresholds( i2c_batch& b, const int16_t lo,
+			   const int16_t hi ) const noexcept {
+
+  const uint16_t l        = _thresh_reg( lo ), h = _thresh_reg( hi );
+  const uint8_t  lo_buf[] = { uint8_t( l >> 8 ), uint8_t( l & 0xff ) };
+  const uint8_t  hi_buf[] = { uint8_t( h >> 8 ), uint8_t( h & 0xff ) };
+
+  ssize_t rVal = b.write_reg( *this, REG_LO_THRESH, lo_buf, sizeof( lo_buf ));
+
+  if( rVal >= 0 )
+    rVal = b.write_reg( *this, REG_HI_THRESH, hi_buf, sizeof( hi_buf ));
+
+  return rVal;
+}
+
+
+int16_t
+ads1015::code( const float volts ) const noexcept {
+
+  // volts() backwards, clamped to the 12-bit range.
+
+  const float c = ::roundf( volts / scale());
+
+  return int16_t( std::max( -2048.0f, std::min( 2047.0f, c )));
+}
+
+
+const ads1015::stream_stats
+ads1015::stream( const CREG& r, const SAMPLE_RATE rate, sample_ring& ring,
+		 const std::atomic< bool >& stop, const uint64_t max ) noexcept {
+
+  stream_stats   rVal  { 0, 0, 0 };
+  const uint16_t saved = myConfigReg;
+
+  // One write selects everything and, being continuous, starts
+  // converting.
+
+  myConfigReg = MUX_FIELD.set( myConfigReg, static_cast< MUX_x >( r ));
+  myConfigReg = SAMPLE_RATE_FIELD.set
+    ( myConfigReg, static_cast< SAMPLE_RATE_x >( rate ));
+  myConfigReg = MODE_FIELD.set( myConfigReg, MODE_x::CONTINUOUS );
+
+  const auto t0 = std::chrono::steady_clock::now();
+
+  if(( _write_cfg() < 0 ) || ( _write( &REG_CONV, 1 ) != 1 )) {
+
+    _LOG_WARN(( _id( "Failed to start streaming" ), errno2str()));
+    ++rVal.errors;
+
+  } else {
+
+    const std::chrono::nanoseconds period
+      ( _period_ns( rate_sps[ int( rate )]));
+
+    bool paced = myReady && myAlert;
+    auto next  = t0 + conv_wait();
+
+    if( paced )
+      (void)myAlert->flush();
+
+    while(( stop.load( std::memory_order_relaxed ) == false )
+	  && (( max == 0 ) || ( rVal.samples < max ))) {
+
+      std::chrono::steady_clock::time_point when;
+
+      if( paced ) {
+
+	// A line that stops pulsing is given up on.
+
+	if( myAlert->wait( 2 * conv_wait(), when ) != 1 ) {
+	  _LOG_WARN(( _id( "No ALERT/RDY edge, pacing by the clock" )));
+	  paced = false;
+	  next  = std::chrono::steady_clock::now();
+	  continue;
 	}
-    
+
+      } else {
+
+	std::this_thread::sleep_until( next );
+
+	// Whole periods late and those conversions were overwritten.
+
+	const auto late = std::chrono::steady_clock::now() - next;
+
+	if( late >= period ) {
+	  const auto n = late / period;
+	  rVal.missed += n;
+	  next        += n * period;
+	}
+
+	next += period;
+
+      }
+
+      uint8_t buf[2];
+
+      if( _read( buf, sizeof( buf )) != sizeof( buf )) {
+	++rVal.errors;
+	continue;
+      }
+
+      if( !paced )
+	when = std::chrono::steady_clock::now();
+
+      (void)ring.push({ code( buf ), when });
+      ++rVal.samples;
+
+    }
   }
-  
+
+  // Back to how it was.
+
+  myConfigReg = saved;
+
+  if( _write_cfg() < 0 )
+    _LOG_WARN(( _id( "Failed to restore the configuration" )));
+
+  _LOG_VERB(( _id( "Streamed" ), " samples=", rVal.samples,
+	      ", missed=", rVal.missed, ", errors=", rVal.errors,
+	      ", overruns=", ring.overruns()));
+
   return rVal;
 }
 
 
-const std::tuple< ads1015::AINp_x, ads1015::AINn_x >
-ads1015::_mux( AINp_x p, AINn_x n ) {
+int
+ads1015::window( const bool on ) noexcept {
+
+  // Off, the comparator is disabled and the thresholds can never
+  // trip it. On, the caller sets the thresholds.
+
+  if( !on && (( _write_word( REG_LO_THRESH, default_lo_thresh ) != 3 )
+	       || ( _write_word( REG_HI_THRESH, default_hi_thresh ) != 3 ))) {
+    _LOG_WARN(( _id( "Failed to write the thresholds" ), errno2str()));
+    return -1;
+  }
+
+  if(( _reg_write_map_cfg( on ? COMP_MODE_x::WINDOW : COMP_MODE_x::TRADITIONAL,
+			   COMP_MODE_FIELD ) < 0 )
+     || ( _reg_write_map_cfg( COMP_LAT_x::NON_LATCHING, COMP_LAT_FIELD ) < 0 )
+     || ( _reg_write_map_cfg( on ? COMP_QUE_x::ONE : COMP_QUE_x::DISABLE,
+			      COMP_QUE_FIELD ) < 0 ))
+    return -1;
+
+  // Conversion-ready is off, so its mode goes back.
+
+  if( myReady &&
+      ( _reg_write_map_cfg( static_cast< MODE_x >( myReadyMode ),
+			    MODE_FIELD ) < 0 ))
+    return -1;
+
+  myReady = false;
+  myAlert = nullptr;
+
+  return 0;
+}
+
+
+int
+ads1015::start( const CREG& r ) {
   
-  constexpr std::tuple< AINp_x, AINn_x > _mask {
-    AINp_x::_MASK, AINn_x::_MASK
-  };
-  const std::tuple< AINp_x, AINn_x > _cmp  { p, n };
+  // The multiplexer codes are in CREG order. Select the input and
+  // begin the conversion in one write. (Not queue_start(), because
+  // the word write can go by SMBus.)
+
+  myConfigReg = MUX_FIELD.set( myConfigReg, static_cast< MUX_x >( r ));
+
+  const uint16_t cfg  = myConfigReg | OS_FIELD.mask;
+  int            rVal = 0;
+
+  if( _write_word( REG_CFG, cfg ) != 3 ) {
+    _LOG_WARN(( _id( "Failure to start a conversion" ),
+		", val=", t2hex( cfg ), errno2str()));
+    rVal = -1;
+  }
   
-  myConfigReg &= ~MUX_MAP.at( _mask );
+  return rVal;
+}
+
+
+ssize_t
+ads1015::queue_start( i2c_batch& b, const CREG& r ) {
+
+  myConfigReg = MUX_FIELD.set( myConfigReg, static_cast< MUX_x >( r ));
+
+  const uint16_t cfg     = myConfigReg | OS_FIELD.mask;
+  const uint8_t  w_buf[] = { uint8_t( cfg >> 8 ), uint8_t( cfg & 0xff ) };
+
+  return b.write_reg( *this, REG_CFG, w_buf, sizeof( w_buf ));
+}
+
+
+const std::chrono::microseconds
+ads1015::conv_wait( void ) const noexcept {
+
+  const int rate = i_rate();
+  int       us_sleep_time;
+
+  if( rate <= 0 )
+    us_sleep_time = 1000000;
+  else {
+
+    const int period = ( myTiming.count == 0 )
+      ? (( 100 + osc_tolerance_pct ) * 1000000 ) / ( 100 * rate )
+      : int(( _period_ns( rate ) * ( 100 + cal_guard_pct )) / ( 100 * 1000 ));
+
+    // Continuous, the conversion under way finishes first.
+
+    us_sleep_time = (( mode() == MODE::CONTINUOUS ) ? 2 * period : period )
+      + wake_up_us + 1;
+
+  }
   
-  for( const auto& [k,m] : MUX_MAP )
-    if( k != _mask )
-      if( _cmp == k ) {
-	myConfigReg |= m;
+  _LOG_VERB(( "thread=", _tid(), ", sleep=", us_sleep_time, "us",
+	      ", rate=", rate ));
+
+  return std::chrono::microseconds( us_sleep_time );
+}
+
+
+int64_t
+ads1015::_period_ns( const int rate ) const noexcept {
+
+  const double nominal = 1.0e9 / double( rate );
+
+  return int64_t( nominal * (( myTiming.count > 0 ) ? myTiming.ratio : 1.0 ));
+}
+
+
+int
+ads1015::calibrate( const size_t n ) noexcept {
+
+  using clock = std::chrono::steady_clock;
+
+  const int rate = i_rate();
+
+  if(( rate <= 0 ) || ( n == 0 ))
+    return -1;
+
+  // Only single shot conversions have an OS bit to poll.
+
+  const uint16_t saved = myConfigReg;
+
+  myConfigReg = MODE_FIELD.set( myConfigReg, MODE_x::SINGLE_SHOT );
+
+  if( _write_cfg() < 0 ) {
+    myConfigReg = saved;
+    return -1;
+  }
+
+  const CREG chan = static_cast< CREG >( _mux());
+
+  // Each trial bounds its conversion: it began during the start's
+  // write, so after t0 and by t1, and ended after the last poll that
+  // saw it busy was issued (lower) and by the time the first that
+  // saw it ready returned (upper). A trial whose start or any poll
+  // failed bounds nothing (an idle converter reads ready) and is
+  // dropped. The trial with the smallest upper bound is kept.
+
+  clock::duration lower = clock::duration::zero();
+  clock::duration upper = clock::duration::max();
+  size_t          good  = 0;
+
+  for( size_t i = 0; i < n; ++i ) {
+
+    const auto t0 = clock::now();
+
+    if( start( chan ) < 0 )
+      continue;
+
+    const auto t1       = clock::now();
+    const auto deadline = t1 + 4 * conv_wait();
+    auto       busy     = t1;
+
+    while( true ) {
+
+      const auto    before = clock::now();
+      const int32_t reg    = _read_cfg();
+      const auto    after  = clock::now();
+
+      if( reg < 0 )
+	break;
+
+      if( OS_FIELD.decode( uint16_t( reg )) == OS_x::CONVERSION_READY ) {
+
+	if(( after - t0 ) < upper ) {
+	  lower = busy  - t1;
+	  upper = after - t0;
+	}
+
+	++good;
 	break;
+
       }
-  int32_t reg = _write_cfg();
-  
-  if( reg < 0 )
-    _LOG_WARN(( _id( "Unable to write to configuration register" ),
-		errno2str()));
+
+      if( after > deadline )
+	break;
+
+      busy = before;
+
+    }
+  }
+
+  myConfigReg = saved;
+
+  int rVal = ( _write_cfg() < 0 ) ? -1 : 0;
+
+  if( good == 0 ) {
+
+    _LOG_WARN(( _id( "Calibration failed" ), ", rate=", rate ));
+    return -1;
+
+  }
+
+  // The oscillator's ratio, from the smallest upper bound (so never
+  // short) less the wake up, and how well it's known.
+
+  const double nominal_us = 1.0e6 / double( rate );
+  const double up_us      =
+    std::chrono::duration< double, std::micro >( upper ).count();
+  const double lo_us      =
+    std::chrono::duration< double, std::micro >( lower ).count();
+  const float  ratio      =
+    float( std::max( up_us - wake_up_us, 1.0 ) / nominal_us );
+
+  // The datasheet's oscillator is good to osc_tolerance_pct, so
+  // anything else is a bad measurement (e.g., polls slower than a
+  // conversion) and the model stays as it was.
+
+  if(( ratio < float( 100 - osc_tolerance_pct ) / 100.0f )
+     || ( ratio > float( 100 + osc_tolerance_pct ) / 100.0f )) {
+
+    _LOG_WARN(( _id( "Calibration out of tolerance" ), ", rate=", rate,
+		", ratio=", ratio, ", good=", good ));
+    return -1;
+
+  }
+
+  const auto now = clock::now();
+
+  if( myTiming.count > 0 ) {
+
+    const double hours =
+      std::chrono::duration< double, std::ratio< 3600 >>
+      ( now - myTiming.when ).count();
+
+    if( hours > 0.0 )
+      myTiming.drift = float((( ratio - myTiming.ratio ) / myTiming.ratio )
+			     * 1.0e6 / hours );
+
+  }
+
+  myTiming.measured = std::chrono::duration_cast
+    < std::chrono::microseconds >( upper );
+  myTiming.rate     = rate;
+  myTiming.ratio    = ratio;
+  myTiming.spread   = float(( up_us - lo_us ) / ( 2.0 * nominal_us ));
+  myTiming.when     = now;
+  ++myTiming.count;
+
+  _LOG_VERB(( _id( "Calibrated" ), " rate=", rate,
+	      ", measured=", myTiming.measured.count(), "us",
+	      ", ratio=", ratio, ", spread=", myTiming.spread,
+	      ", drift=", myTiming.drift, "ppm/h, good=", good ));
+
+  return rVal;
+}
+
+
+size_t
+ads1015::scan( const CREG* chans, const size_t n, reading* out ) {
+
+  assert( chans || ( n == 0 ));
+  assert( out   || ( n == 0 ));
+
+  size_t    rVal = 0;
+  arbiter&  bus  = arbiter::get( myBus );
+  i2c_batch b( 3 );
+
+  for( size_t i = 0; i < n; ++i )
+    out[i] = { chans[i], 0.0, 0, -1, std::chrono::steady_clock::time_point() };
+
+  // A continuous converter finishes the conversion under way with
+  // the old input before starting one with the new, a period later
+  // than the wait, so the scan is single shot. Once the last
+  // continuous conversion is done.
+
+  if( mode() != MODE::SINGLE_SHOT ) {
+
+    (void)bus.submit( arbiter::PRIORITY::SAMPLER, [this]( void ) {
+	return mode( MODE::SINGLE_SHOT );
+      }).get();
+
+    std::this_thread::sleep_for( conv_wait());
+
+  }
+
+  // Step i starts channel i (if any) and collects channel i - 1 (if
+  // any). The start goes first in the transaction since a new
+  // conversion takes a full period to overwrite the conversion
+  // register.
+
+  bool started = false;
+
+  for( size_t i = 0; i <= n; ++i ) {
+
+    started = bus.submit( arbiter::PRIORITY::SAMPLER, [&]( void ) {
+
+	uint8_t r_buf[2];
+	ssize_t s_idx = -1, r_idx = -1;
+
+	b.clear();
+	if( i < n )
+	  s_idx = queue_start( b, chans[i] );
+	if( i > 0 )
+	  r_idx = queue_conv( b, r_buf );
+	b.submit();
+
+	if(( i > 0 ) && started && ( r_idx >= 0 )
+	   && ( b.status( r_idx ) == 0 )) {
+
+	  reading& r = out[ i - 1 ];
+
+	  r.volts  = volts( r_buf );
+	  r.code   = code( r_buf );
+	  r.status = 0;
+	  r.when   = std::chrono::steady_clock::now();
+	  ++rVal;
+
+	}
+
+	return ( s_idx >= 0 ) && ( b.status( s_idx ) == 0 );
+
+      }).get();
+
+    if( i < n )
+      std::this_thread::sleep_for( conv_wait());
+
+  }
+
+  return rVal;
+}
+
+
+ssize_t
+ads1015::queue_conv( i2c_batch& b, uint8_t* r_buf ) const noexcept {
+
+  assert( r_buf );
+
+  ssize_t rVal = -1;
   
-  return _mux();
+  // Point at the conversion register then read it.
+
+  if( b.write_reg( *this, REG_CONV, nullptr, 0 ) >= 0 )
+    rVal = b.read( *this, r_buf, 2 );
+
+  return rVal;
 }
 
 
 const float
-ads1015::operator[]( const CREG& r ) {
-  
-  int16_t rSamp = 0;
-  float   rVal = 0.0;
-  
-  static const std::map
-    < const CREG,
-      const std::tuple< AINp_x, AINn_x >> conversion_mux_map {
-	{ CREG::DIFF01, { AINp_x::AIN0, AINn_x::AIN1 }},
-	{ CREG::DIFF03, { AINp_x::AIN0, AINn_x::AIN3 }},
-	{ CREG::DIFF13, { AINp_x::AIN1, AINn_x::AIN3 }},
-	{ CREG::DIFF23, { AINp_x::AIN2, AINn_x::AIN3 }},
-	{ CREG::CHAN0,  { AINp_x::AIN0, AINn_x::GND  }},
-	{ CREG::CHAN1,  { AINp_x::AIN1, AINn_x::GND  }},
-	{ CREG::CHAN2,  { AINp_x::AIN2, AINn_x::GND  }},
-	{ CREG::CHAN3,  { AINp_x::AIN3, AINn_x::GND  }}
-  };
-  
-  _mux( std::get<0>( conversion_mux_map.at( r )),
-	std::get<1>( conversion_mux_map.at( r )));
-  os( OS::BEGIN );
-  
-  const int us_sleep_time =
-    ( int(( 1.0 * 12.0 * 1000000.0 ) / float( i_rate())) + 1 );
-  
-  _LOG_VERB(( "thread=", _tid(), ", sleep=", us_sleep_time, "us",
-	      ", rate=", i_rate()));
-  
-  std::this_thread::sleep_for( std::chrono::microseconds( us_sleep_time ));
-  
-  constexpr uint8_t w_buf[] = { REG_CONV };
-            uint8_t r_buf[] = { 0x00, 0x00 };
-    
-  size_t w_num = _write( w_buf, sizeof( w_buf ));
-  size_t r_num = _read(  r_buf, sizeof( r_buf ));
+ads1015::volts( const uint8_t* r_buf ) const noexcept {
+
+  assert( r_buf );
+
+  return float( code( r_buf )) * scale();
+}
+
+
+ads1015_group::ads1015_group( void )
+  : myAllocs( 0 ) {}
+
+
+size_t
+ads1015_group::add( ads1015& a, const std::vector< ads1015::CREG >& chans ) {
+
+  // Converters on the same bus share a batch.
+
+  size_t b = 0;
+
+  while(( b < myBuses.size()) && ( myBuses[b].arb->bus() != a.bus()))
+    ++b;
+
+  if( b == myBuses.size())
+    myBuses.push_back({ &arbiter::get( a.bus()),
+			std::make_unique< i2c_batch >( 5 * chans.size()) });
+
+  // Single shot, as a continuous converter converts each channel a
+  // period late (see ads1015::scan()), once the last continuous
+  // conversion is done.
+
+  if( a.mode() != ads1015::MODE::SINGLE_SHOT ) {
+
+    (void)myBuses[b].arb->submit( arbiter::PRIORITY::SAMPLER,
+				  [&a]( void ) {
+				    return a.mode
+				      ( ads1015::MODE::SINGLE_SHOT );
+				  }).get();
+
+    std::this_thread::sleep_for( a.conv_wait());
+
+  }
+
+  // The converter's thresholds are unknown until written.
+
+  member m { &a, b, {}, {}, { 0, -1, false }, false, { 0, 0 }, -1, -1, -1,
+	     false, {} };
+
+  for( const auto c : chans ) {
+    m.out.push_back
+      ({ c, 0.0, 0, -1, std::chrono::steady_clock::time_point() });
+    m.win.push_back({ INT16_MIN, INT16_MAX, false });
+  }
+
+  myMembers.push_back( std::move( m ));
+  myPending.reserve( myBuses.size());
+
+  return myMembers.size() - 1;
+}
+
+
+size_t
+ads1015_group::_step( const size_t b, const size_t step ) noexcept {
+
+  const size_t allocs = alloc_count();
+  size_t       rVal   = 0;
+  i2c_batch&   batch  = *myBuses[b].batch;
+
+  // Start the next channel then collect the last, per converter. See
+  // ads1015::scan() for why that order.
+
+  batch.clear();
+
+  for( auto& m : myMembers )
+    if( m.bus == b ) {
+
+      m.s_idx = m.r_idx = m.t_idx = -1;
+
+      // The window goes in ahead of the conversion it applies to.
+
+      if( m.comp && ( step < m.out.size())) {
+
+	const window& w = m.win[ step ];
+
+	if(( w.lo != m.dev.lo ) || ( w.hi != m.dev.hi ))
+	  m.t_idx = m.adc->queue_thresholds( batch, w.lo, w.hi );
+
+      }
+
+      if( step < m.out.size())
+	m.s_idx = m.adc->queue_start( batch, m.out[ step ].chan );
+      if(( step > 0 ) && (( step - 1 ) < m.out.size()))
+	m.r_idx = m.adc->queue_conv( batch, m.r_buf );
+
+    }
+
+  batch.submit();
+
+  const auto now = std::chrono::steady_clock::now();
+
+  for( auto& m : myMembers )
+    if( m.bus == b ) {
+
+      if(( m.r_idx >= 0 ) && m.started && ( batch.status( m.r_idx ) == 0 )) {
+
+	ads1015::reading& r = m.out[ step - 1 ];
+
+	r.volts  = m.adc->volts( m.r_buf );
+	r.code   = ads1015::code( m.r_buf );
+	r.status = 0;
+	r.when   = now;
+	++rVal;
+
+      }
+
+      m.started = ( m.s_idx >= 0 ) && ( batch.status( m.s_idx ) == 0 );
+
+      if( m.t_idx >= 0 ) {
+	if( batch.status( m.t_idx ) == 0 )
+	  m.dev = m.win[ step ];
+	else
+	  m.dev = { 0, -1, false };
+      }
 
-  if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Unable to select conversion register" ),
-		"w_num=", w_num, "val=", _vtoa( w_buf, sizeof( w_buf )),
-		errno2str()));
-    
-  } else {
-    
-    if( r_num != sizeof( r_buf )) {
-      
-      _LOG_WARN(( _id( "Failure to read conversion register" ),
-		  "r_num=", r_num, errno2str()));
-      
-    } else {
-      
-      // I have a valid conversion.
-      //
-      // Now a bit of hokey-pokey.  
-      
-      rSamp   = ( r_buf[0] << 8 ) | r_buf[1];
-      rSamp >>= 4;
-      rSamp  &= 0x0fff;
-      
-      if( rSamp & 0b100000000000 )
-	rSamp |= 0xf000;
-      
-      rVal  = ::roundf((( float( rSamp ) / 2047.0 ) * float( i_gain())));
-      rVal /= 1000.0;
-      
     }
+
+  myAllocs += alloc_count() - allocs;
+
+  return rVal;
+}
+
+
+int
+ads1015_group::alarm( const size_t i, const size_t k,
+		      const int16_t lo, const int16_t hi ) {
+
+  assert( i < myMembers.size());
+  assert( k < myMembers[i].out.size());
+  assert( lo <= hi );
+
+  member& m = myMembers[i];
+  int     rVal = 0;
+
+  m.win[k].lo = lo;
+  m.win[k].hi = hi;
+
+  // The window comparator goes on with the first alarm. It's a
+  // configuration change so it goes through the arbiter.
+
+  if( !m.comp && (( lo != INT16_MIN ) || ( hi != INT16_MAX ))) {
+
+    rVal = myBuses[ m.bus ].arb->submit( arbiter::PRIORITY::SAMPLER,
+					 [&m]( void ) {
+					   return m.adc->window( true );
+					 }).get();
+    m.comp = ( rVal == 0 );
+
   }
-  
+
+  return rVal;
+}
+
+
+void
+ads1015_group::on_alarm( alarm_fn f ) {
+
+  myAlarm = std::move( f );
+}
+
+
+size_t
+ads1015_group::scan( void ) {
+
+  size_t rVal  = 0;
+  size_t steps = 0;
+
+  myAllocs = 0;
+
+  for( auto& m : myMembers ) {
+
+    for( auto& r : m.out )
+      r.status = -1;
+
+    m.started = false;
+    steps     = std::max( steps, m.out.size());
+
+  }
+
+  for( size_t step = 0; step <= steps; ++step ) {
+
+    // Edges from earlier conversions are stale.
+
+    for( auto& m : myMembers )
+      if(( step < m.out.size()) && m.adc->ready_line())
+	(void)m.adc->ready_line()->flush();
+
+    // Every bus at once.
+
+    myPending.clear();
+
+    for( size_t b = 0; b < myBuses.size(); ++b )
+      myPending.push_back
+	( myBuses[b].arb->submit( arbiter::PRIORITY::SAMPLER,
+				  [this,b,step]( void ) {
+				    return _step( b, step );
+				  }));
+
+    for( auto& f : myPending )
+      rVal += f.get();
+
+    // Alarms, as soon as the step's readings are in.
+
+    if( step > 0 )
+      for( size_t i = 0; i < myMembers.size(); ++i ) {
+
+	member& m = myMembers[i];
+	const size_t k = step - 1;
+
+	if(( k >= m.out.size()) || ( m.out[k].status != 0 ))
+	  continue;
+
+	// From the edge the last wait saw to the reading.
+
+	if( m.ready != std::chrono::steady_clock::time_point())
+	  m.adc->ready_latency( m.ready );
+
+	window&       w = m.win[k];
+	const int16_t c = m.out[k].code;
+	bool          in;
+
+	if( w.in ) {
+
+	  // Out of alarm only well inside the window, see alarm().
+
+	  auto margin = []( const int16_t t ) {
+	    return std::max( hysteresis_codes,
+			     std::abs( int( t )) * hysteresis_pct / 100 );
+	  };
+
+	  in = (( w.lo != INT16_MIN ) && ( c < w.lo + margin( w.lo )))
+	    || (( w.hi != INT16_MAX ) && ( c > w.hi - margin( w.hi )));
+
+	} else
+	  in = ( c < w.lo ) || ( c > w.hi );
+
+	if( in != w.in ) {
+	  w.in = in;
+	  if( myAlarm )
+	    myAlarm( i, k, m.out[k], in );
+	}
+
+      }
+
+    // One wait, for the slowest converter with a conversion running.
+    // When all of them have a conversion-ready line it's for their
+    // edges instead, never longer than the wait.
+
+    std::chrono::microseconds wait( 0 );
+    bool                      edges = true;
+
+    for( auto& m : myMembers ) {
+
+      m.ready = std::chrono::steady_clock::time_point();
+
+      if( step < m.out.size()) {
+	wait  = std::max( wait, m.adc->conv_wait());
+	edges = edges && m.adc->ready_line();
+      }
+
+    }
+
+    if( wait.count()) {
+
+      const auto deadline = std::chrono::steady_clock::now() + wait;
+
+      if( edges ) {
+
+	// A missing edge (or a failed wait) and it's the wait after all.
+
+	bool all = true;
+
+	for( auto& m : myMembers )
+	  if( all && ( step < m.out.size())) {
+
+	    const auto left = std::chrono::duration_cast
+	      < std::chrono::microseconds >
+	      ( deadline - std::chrono::steady_clock::now());
+
+	    all = ( left.count() > 0 )
+	      && ( m.adc->ready_line()->wait( left, m.ready ) == 1 );
+
+	    if( !all )
+	      m.ready = std::chrono::steady_clock::time_point();
+
+	  }
+
+	if( !all )
+	  std::this_thread::sleep_until( deadline );
+
+      } else
+	std::this_thread::sleep_for( wait );
+
+    }
+
+  }
+
   return rVal;
 }
 
@@ -917,21 +1693,17 @@ operator<<( std::ostream& os, ads1015::COMP_QUE q ) {
 }
 
 
-std::ostream& operator<<( std::ostream& os,
-                          const std::tuple< ads1015::AINp_x,
-			                    ads1015::AINn_x >& m ) {
+std::ostream& operator<<( std::ostream& os, ads1015::MUX_x m ) {
 
-  switch( std::get<0>( m )) {
-  case ads1015::AINp_x::AIN0: os << "AIN0:"; break;
-  case ads1015::AINp_x::AIN1: os << "AIN1:"; break;
-  case ads1015::AINp_x::AIN2: os << "AIN2:"; break;
-  case ads1015::AINp_x::AIN3: os << "AIN3:"; break;
-  default: os.setstate(std::ios_base::failbit);
-  }
-  switch( std::get<1>( m )) {
-  case ads1015::AINn_x::AIN1: os << "AIN0"; break;
-  case ads1015::AINn_x::AIN3: os << "AIN3"; break;
-  case ads1015::AINn_x::GND:  os << "GNDS"; break;
+  switch( m ) {
+  case ads1015::MUX_x::DIFF01: os << "AIN0:AIN1"; break;
+  case ads1015::MUX_x::DIFF03: os << "AIN0:AIN3"; break;
+  case ads1015::MUX_x::DIFF13: os << "AIN1:AIN3"; break;
+  case ads1015::MUX_x::DIFF23: os << "AIN2:AIN3"; break;
+  case ads1015::MUX_x::CHAN0:  os << "AIN0:GNDS"; break;
+  case ads1015::MUX_x::CHAN1:  os << "AIN1:GNDS"; break;
+  case ads1015::MUX_x::CHAN2:  os << "AIN2:GNDS"; break;
+  case ads1015::MUX_x::CHAN3:  os << "AIN3:GNDS"; break;
   default: os.setstate(std::ios_base::failbit);
   }
   return os;
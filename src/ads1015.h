@@ -29,8 +29,7 @@
  *
  *
  * Notes: 
- *  1, Threshold is unimplemented.
- *  2, The "comp" modes are untested.
+ *  1, The "comp" modes are untested.
  *
  *
  * $Log: ads1015.h,v $
@@ -135,18 +134,28 @@ extern "C" {
   
 }
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
-#include <map>
 #include <mutex>
 #include <ostream>
 #include <string>
 #include <sstream>
 #include <tuple>
 #include <utility>
+#include <vector>
 
+#include "arbiter.h"
+#include "gpio.h"
 #include "i2c.h"
 #include "log.h"
+#include "templates.h"
 #include "util.h"
 
 
@@ -181,7 +190,11 @@ private:
                                    REG_LO_THRESH = uint8_t( 0b10 ),
                                    REG_HI_THRESH = uint8_t( 0b11 );
 
-  // Mirrored configuration register.
+  // Mirrored configuration register. The mirror is the truth: every
+  // write goes through it and the getters read it rather than the
+  // device, so a conversion is one write to start it and one read of
+  // the result. The OS bit is always clear in the mirror. resync()
+  // reloads the mirror from the device.
   
   uint16_t myConfigReg;
   
@@ -195,62 +208,27 @@ private:
   int32_t _write_cfg( void ) const noexcept;
   int32_t _read_cfg(  void ) const noexcept;
   
-  // This template is used in the simple functions that read the
-  // configuration register and return a bit sequence mapped to an
+  // This template is used in the simple functions that return a
+  // field of the (mirrored) configuration register mapped to an
   // enumerated type.
   
-  template< typename E >
+  template< typename F >
   inline
-  E _reg_read_map_cfg( const std::map< E, uint16_t>& m ) const noexcept {
+  typename F::key_type _reg_read_map_cfg( const F& f ) const noexcept {
     
-    E       e_type = E::_NONE;
-    int32_t reg    = _read_cfg();
-    
-    if( reg < 0 ) {
-      
-      _LOG_WARN(( _id( "Failed to read config register." )));
-      
-    } else {
-      
-      const uint16_t mask = m.at( E::_MASK );
-      
-      for( const auto& i : m )
-	if(( i.first != E::_NONE ) && ( i.first != E::_MASK ))
-	  if(( reg & mask ) == i.second ) {
-	    e_type = i.first;
-	    break;
-	  }
-      
-      // Note: A E-type of none is always possible for bits
-      //       indicating a process, such as whether a conversion
-      //       is complete or not. In other cases, bits are fairly
-      //       static where "none" is not a possibility. Therefore,
-      //       this point of the code is slightly flawed because it
-      //       doesn't know the difference between static and
-      //       dynamic bits and therefore cannot test whether "none"
-      //       is an impossibility.
-      
-    }
-    
-    return e_type;
+    return f.decode( myConfigReg );
   }
   
   // Similar to the last template function, this template is used as
   // the bulk of the simple functions that write an enumerated type
-  // mapped to a bit sequence to the configuration register.
+  // mapped to a field's bits to the configuration register.
     
-  template< typename E >
+  template< typename F >
   inline
-  int32_t _reg_write_map_cfg( const E& e, const std::map< E, uint16_t>& m ) {
-    
-    myConfigReg &= ~m.at( E::_MASK );
+  int32_t _reg_write_map_cfg( const typename F::key_type& e, const F& f ) {
     
-    for( const auto& i : m )
-      if(( i.first != E::_NONE ) && ( i.first != E::_MASK ))
-	if( e == i.first ) {
-	  myConfigReg |= i.second;
-	  break;
-	}
+    myConfigReg = f.set( myConfigReg, e );
+
     int32_t rVal = _write_cfg();
     
     if( rVal < 0 )
@@ -287,9 +265,16 @@ public:
   bool operator!=( const ads1015& d ) const noexcept;
   
   int reset( void );
+
+  // Reload the mirrored configuration register from the device, such
+  // as when the device may have been reset behind our back. Returns
+  // zero or -1 on error.
+
+  int resync( void ) noexcept;
   
   // Set/get the operational status.  Only the BEGIN bit can be set
-  // and only the READY bit can be read.
+  // and only the READY bit can be read. Unlike the other getters,
+  // os() reads the device.
 
   enum class OS : int { BEGIN = 1, CONVERSION_READY };
 
@@ -364,18 +349,252 @@ public:
   
   const float operator[]( const CREG& r );
 
+  // operator[] without the volts: the conversion's signed 12-bit
+  // code or no_code on error. A code times scale() is volts and a
+  // gain's scale is a constant, so codes can be summed and averaged
+  // exactly and turned into volts once:
+  //
+  //   constexpr float s = ads1015::scale( ads1015::PGA_GAIN::FS_6144 );
+  //   const float     v = s * ad.raw( ads1015::CREG::CHAN0 );
+  //
+  // code() of the conversion register's two bytes is their code.
+
+  inline static constexpr int16_t no_code = INT16_MIN;
+
+  int16_t raw( const CREG& r );
+
+  static constexpr float   scale( const PGA_GAIN g ) noexcept;
+  float                    scale( void ) const noexcept;
+  static constexpr int16_t code( const uint8_t* r_buf ) noexcept;
+
+  // Conversion-ready wakeup for operator[]. Rather than sleeping the
+  // worst case conversion time, operator[] wakes when the conversion
+  // is done. On, the thresholds are set to the datasheet's
+  // conversion-ready pattern (HI_THRESH MSB set, LO_THRESH MSB
+  // clear) with the comparator queue enabled so ALERT/RDY asserts at
+  // the end of each conversion. With a line, operator[] waits for
+  // its edge; without one, or if the edge never comes, it sleeps 90%
+  // of a conversion then polls the OS bit with a backoff. Only
+  // single shot conversions have an OS bit to poll, so on puts the
+  // converter in single shot mode and off puts back the mode it was
+  // in. Off also restores the default thresholds and disables the
+  // queue, which disables the comparator. Returns zero or -1 on
+  // error.
+  //
+  // ready_line() is the line while conversion-ready is on with one,
+  // otherwise nullptr.
+  //
+  // ready_latency() is how long from the conversion being ready
+  // (the edge's timestamp or the poll that saw it) to its value
+  // being delivered. ready_latency( ready ) counts a conversion
+  // ready at ready being delivered now, for callers that wait for
+  // the edges themselves (see ads1015_group). Either may be called
+  // from any thread.
+
+  struct latency {
+    uint64_t                  count;
+    std::chrono::microseconds total;
+    std::chrono::microseconds max;
+  };
+
+  int  conv_ready( const bool on,
+		   std::shared_ptr< alert_line > line = nullptr ) noexcept;
+  bool conv_ready( void ) const noexcept;
+
+  const std::shared_ptr< alert_line > ready_line( void ) const noexcept;
+
+  const latency ready_latency( void ) const noexcept;
+  void          ready_latency
+		  ( const std::chrono::steady_clock::time_point ready )
+		  noexcept;
+
+  // The comparator's thresholds, as codes. code() is the code a
+  // voltage reads as at the current gain, the inverse of volts().
+  // thresholds() writes both registers and queue_thresholds() queues
+  // writing them onto a batch, returning the last write's index or
+  // -1.
+  //
+  // window() turns on the window comparator: ALERT/RDY asserts after
+  // any conversion above HI_THRESH or below LO_THRESH and releases
+  // after one within them. Off restores the traditional comparator,
+  // the default thresholds, and disables it. The thresholds are
+  // shared with conv_ready() so turning one on turns the other off.
+  // Both return zero or -1 on error.
+
+  int     thresholds( const int16_t lo, const int16_t hi ) noexcept;
+  ssize_t queue_thresholds( i2c_batch& b, const int16_t lo,
+			    const int16_t hi ) const noexcept;
+  int16_t code( const float volts ) const noexcept;
+
+  int window( const bool on ) noexcept;
+
+  // Stream one input. The input, rate, and continuous mode are
+  // written once then the conversion register is pointed at once,
+  // so each sample is a bare two byte read. Reads are paced by the
+  // ALERT/RDY line when conversion-ready is on with one (see
+  // conv_ready()) and otherwise by the clock at the nominal rate.
+  // Each sample and when it was read is pushed onto ring, where a
+  // full ring counts an overrun. It runs on the caller's thread
+  // until stop is set or max (if not zero) samples are read, then
+  // puts the configuration back.
+  //
+  // The stream reads around the arbiter, each read one transaction,
+  // so other devices' jobs fit between reads. Nothing else may use
+  // this converter while it streams.
+
+  struct sample {
+    int16_t                               code;   // 12-bit
+    std::chrono::steady_clock::time_point when;
+  };
+
+  using sample_ring = spsc_ring< sample >;
+
+  struct stream_stats {
+    uint64_t samples;  // read and pushed (or overrun)
+    uint64_t missed;   // conversions overwritten before being read
+    uint64_t errors;   // failed reads
+  };
+
+  const stream_stats stream( const CREG& r, const SAMPLE_RATE rate,
+			     sample_ring& ring,
+			     const std::atomic< bool >& stop,
+			     const uint64_t max = 0 ) noexcept;
+
+  // The pieces of operator[] for sampling several converters at
+  // once. start() selects the input and begins a conversion,
+  // returning zero or -1 on error, queue_start() does the same on a
+  // batch and returns the write's index in the batch or -1,
+  // conv_wait() is how long a conversion takes at the current rate,
+  // queue_conv() queues reading the conversion register onto a batch
+  // (r_buf is two bytes and MUST outlive the batch's submit()) and
+  // returns the read's index in the batch or -1, and volts()
+  // converts what was read.
+  //
+  //   ad1.start( CREG::CHAN0 ); ad2.start( CREG::CHAN0 );
+  //   sleep( max( ad1.conv_wait(), ad2.conv_wait()));
+  //   ad1.queue_conv( b, buf1 ); ad2.queue_conv( b, buf2 );
+  //   b.submit();
+  //
+  // conv_wait() is the datasheet's conversion time, one period at
+  // the data rate stretched by the oscillator's tolerance plus the
+  // wake up from power down, until calibrate() has measured the
+  // converter's oscillator. From then on it's the measured period,
+  // plus a small guard, at the data rate. In continuous mode it's
+  // two periods, since a conversion started on a new input waits
+  // for the one under way to finish.
+
+  int     start(       const CREG& r );
+  ssize_t queue_start( i2c_batch& b, const CREG& r );
+  const std::chrono::microseconds conv_wait( void ) const noexcept;
+  ssize_t queue_conv( i2c_batch& b, uint8_t* r_buf ) const noexcept;
+  const float volts( const uint8_t* r_buf ) const noexcept;
+
+  // Measure this converter's conversion time. n single shot
+  // conversions of the current input at the current rate are timed
+  // against CLOCK_MONOTONIC (steady_clock) by polling the OS bit
+  // back to back. Each conversion's end lies between the last poll
+  // that saw it busy and the first that saw it ready; the smallest
+  // of the latter bounds is the measurement, so a wait sized from it
+  // never reads a stale conversion. The measurement, less the wake
+  // up, over the nominal period is the oscillator's ratio, which
+  // scales every rate's period. Calibrating again tracks the
+  // ratio's drift. Trials with a failed start or poll are dropped,
+  // and a ratio outside the oscillator's tolerance is rejected,
+  // keeping the model as it was. Returns zero or -1 on error.
+  //
+  // It's bus I/O from the caller's thread, the bus busy the whole
+  // time (about n conversions), so calibrate at start up and now and
+  // then rather than every sample.
+
+  struct conv_timing {
+    std::chrono::microseconds             measured; // at the rate below
+    int                                   rate;     // SPS calibrated at
+    float                                 ratio;    // actual/nominal period
+    float                                 spread;   // +/- of the ratio
+    float                                 drift;    // ratio, ppm per hour
+    std::chrono::steady_clock::time_point when;
+    uint64_t                              count;    // calibrations
+  };
+
+  int                calibrate( const size_t n = 8 ) noexcept;
+  const conv_timing& timing( void ) const noexcept;
+
+  // Convert a sequence of channels as a pipeline. Each step is one
+  // transaction, run as a SAMPLER job on the bus's arbiter, that
+  // starts the next channel's conversion and reads the previous
+  // channel's result, so n channels take n + 1 transactions and n
+  // conversion waits with the bus free during the waits. A
+  // converter in continuous mode is put in single shot mode, where
+  // it stays, since a continuous one would convert each channel a
+  // period late. out MUST hold n readings. Returns the number of
+  // channels read.
+  //
+  // Because it waits on the arbiter, scan() MUST NOT be called from
+  // an arbiter job.
+
+  struct reading {
+    CREG                                  chan;
+    float                                 volts;
+    int16_t                               code;   // 12-bit
+    int                                   status; // 0 or -1
+    std::chrono::steady_clock::time_point when;   // when it was read
+  };
+
+  size_t scan( const CREG* chans, const size_t n, reading* out );
+
+  template< size_t N >
+  std::array< reading, N > scan( const std::array< CREG, N >& chans );
+
 private:
 
+  // Conversion-ready wakeup: whether it is on, the line ALERT/RDY is
+  // wired to (if any), the ready to delivery latency and its lock,
+  // and the mode to put back when it goes off.
+
+  bool                          myReady;
+  std::shared_ptr< alert_line > myAlert;
+  latency                       myLatency;
+  mutable std::mutex            myLatencyLock;
+  MODE                          myReadyMode;
+
+  // The conversion timing model, see calibrate().
+
+  conv_timing myTiming;
+
+  // The fields of the configuration register, most significant
+  // first. The OS bit means "begin a conversion" when written and
+  // "conversion ready" when read so only the latter is in the table.
+
   enum class OS_x : int {
     _NONE = -1, _MASK = -2,
                BEGIN = int( OS::BEGIN ),
     CONVERSION_READY = int( OS::CONVERSION_READY )
   };
-  inline static const std::map< OS_x, uint16_t > OS_MAP {
-    { OS_x::BEGIN,                   0b1000000000000000 },
-    { OS_x::CONVERSION_READY,        0b1000000000000000 },
-    { OS_x::_MASK,                   0b1000000000000000 }
+  inline static constexpr field< OS_x, uint16_t, 15, 1 > OS_FIELD {{
+    { OS_x::CONVERSION_READY,        0b1 }
+  }};
+
+  enum class MUX_x : int {
+    _NONE = -1, _MASK = -2,
+    DIFF01 = int( CREG::DIFF01 ),
+    DIFF03 = int( CREG::DIFF03 ),
+    DIFF13 = int( CREG::DIFF13 ),
+    DIFF23 = int( CREG::DIFF23 ),
+    CHAN0  = int( CREG::CHAN0  ),
+    CHAN1  = int( CREG::CHAN1  ),
+    CHAN2  = int( CREG::CHAN2  ),
+    CHAN3  = int( CREG::CHAN3  )
   };
+  inline static constexpr field< MUX_x, uint16_t, 12, 3 > MUX_FIELD {{
+    { MUX_x::DIFF01,                 0b000 }, /* DEFAULT */
+    { MUX_x::DIFF03,                 0b001 },
+    { MUX_x::DIFF13,                 0b010 },
+    { MUX_x::DIFF23,                 0b011 },
+    { MUX_x::CHAN0,                  0b100 },
+    { MUX_x::CHAN1,                  0b101 },
+    { MUX_x::CHAN2,                  0b110 },
+    { MUX_x::CHAN3,                  0b111 }
+  }};
 
   enum class PGA_GAIN_x : int {
     _NONE = -1, _MASK = -2,
@@ -386,26 +605,24 @@ private:
     FS_512  = int( PGA_GAIN::FS_512  ),
     FS_256  = int( PGA_GAIN::FS_256  )
   };
-  inline static const std::map< PGA_GAIN_x, uint16_t > PGA_GAIN_MAP {
-    { PGA_GAIN_x::FS_6144,          0b0000000000000000 },
-    { PGA_GAIN_x::FS_4096,          0b0000001000000000 },
-    { PGA_GAIN_x::FS_2048,          0b0000010000000000 }, /* DEFAULT */
-    { PGA_GAIN_x::FS_1024,          0b0000011000000000 },
-    { PGA_GAIN_x::FS_512,           0b0000100000000000 },
-    { PGA_GAIN_x::FS_256,           0b0000101000000000 },
-    { PGA_GAIN_x::_MASK,            0b0000111000000000 }
-  };
+  inline static constexpr field< PGA_GAIN_x, uint16_t, 9, 3 > PGA_GAIN_FIELD {{
+    { PGA_GAIN_x::FS_6144,           0b000 },
+    { PGA_GAIN_x::FS_4096,           0b001 },
+    { PGA_GAIN_x::FS_2048,           0b010 }, /* DEFAULT */
+    { PGA_GAIN_x::FS_1024,           0b011 },
+    { PGA_GAIN_x::FS_512,            0b100 },
+    { PGA_GAIN_x::FS_256,            0b101 }
+  }};
   
   enum class MODE_x : int {
     _NONE = -1, _MASK = -2,
      CONTINUOUS = int( MODE::CONTINUOUS  ),
     SINGLE_SHOT = int( MODE::SINGLE_SHOT )
   };
-  inline static const std::map< MODE_x, uint16_t > MODE_MAP {
-    { MODE_x::CONTINUOUS,           0b0000000000000000 },
-    { MODE_x::SINGLE_SHOT,          0b0000000100000000 }, /* DEFAULT */
-    { MODE_x::_MASK,                0b0000000100000000 }
-  };
+  inline static constexpr field< MODE_x, uint16_t, 8, 1 > MODE_FIELD {{
+    { MODE_x::CONTINUOUS,            0b0 },
+    { MODE_x::SINGLE_SHOT,           0b1 }  /* DEFAULT */
+  }};
 
   enum class SAMPLE_RATE_x : int {
     _NONE = -1, _MASK = -2,
@@ -417,49 +634,46 @@ private:
     SR_2400 = int( SAMPLE_RATE::SR_2400 ),
     SR_3300 = int( SAMPLE_RATE::SR_3300 )
   };
-  inline static const std::map< SAMPLE_RATE_x, uint16_t > SAMPLE_RATE_MAP {
-    { SAMPLE_RATE_x::SR_128,        0b0000000000000000 },
-    { SAMPLE_RATE_x::SR_250,        0b0000000000100000 },
-    { SAMPLE_RATE_x::SR_490,        0b0000000001000000 },
-    { SAMPLE_RATE_x::SR_920,        0b0000000001100000 },
-    { SAMPLE_RATE_x::SR_1600,       0b0000000010000000 }, /* DEFAULT */
-    { SAMPLE_RATE_x::SR_2400,       0b0000000010100000 },
-    { SAMPLE_RATE_x::SR_3300,       0b0000000011000000 },
-    { SAMPLE_RATE_x::_MASK,         0b0000000011100000 }
-  };
+  inline static constexpr
+  field< SAMPLE_RATE_x, uint16_t, 5, 3 > SAMPLE_RATE_FIELD {{
+    { SAMPLE_RATE_x::SR_128,         0b000 },
+    { SAMPLE_RATE_x::SR_250,         0b001 },
+    { SAMPLE_RATE_x::SR_490,         0b010 },
+    { SAMPLE_RATE_x::SR_920,         0b011 },
+    { SAMPLE_RATE_x::SR_1600,        0b100 }, /* DEFAULT */
+    { SAMPLE_RATE_x::SR_2400,        0b101 },
+    { SAMPLE_RATE_x::SR_3300,        0b110 }
+  }};
 
   enum class COMP_MODE_x : int {
     _NONE = -1, _MASK = -2,
     TRADITIONAL = int( COMP_MODE::TRADITIONAL ),
          WINDOW = int( COMP_MODE::WINDOW      )
   };
-  inline static const std::map< COMP_MODE_x, uint16_t > COMP_MODE_MAP {
-    { COMP_MODE_x::TRADITIONAL,     0b0000000000000000 }, /* DEFAULT */
-    { COMP_MODE_x::WINDOW,          0b0000000000010000 },
-    { COMP_MODE_x::_MASK,           0b0000000000010000 }
-  };
+  inline static constexpr field< COMP_MODE_x, uint16_t, 4, 1 > COMP_MODE_FIELD {{
+    { COMP_MODE_x::TRADITIONAL,      0b0 }, /* DEFAULT */
+    { COMP_MODE_x::WINDOW,           0b1 }
+  }};
 
   enum class COMP_POL_x :int {
     _NONE = -1, _MASK = -2,
     ACTIVE_LOW = int( ads1015::COMP_POL::ACTIVE_LOW  ),
     ACTIVE_HIGH = int( ads1015::COMP_POL::ACTIVE_HIGH )
   };
-  inline static const std::map< COMP_POL_x, uint16_t > COMP_POL_MAP {
-    { COMP_POL_x::ACTIVE_LOW,       0b0000000000000000 }, /* DEFAULT */
-    { COMP_POL_x::ACTIVE_HIGH,      0b0000000000001000 },
-    { COMP_POL_x::_MASK,            0b0000000000001000 }
-  };
+  inline static constexpr field< COMP_POL_x, uint16_t, 3, 1 > COMP_POL_FIELD {{
+    { COMP_POL_x::ACTIVE_LOW,        0b0 }, /* DEFAULT */
+    { COMP_POL_x::ACTIVE_HIGH,       0b1 }
+  }};
 
   enum class COMP_LAT_x : int {
     _NONE = -1, _MASK = -2,
     NON_LATCHING = int( COMP_LAT::NON_LATCHING ),
         LATCHING = int( COMP_LAT::LATCHING     )
   };
-  inline static const std::map< COMP_LAT_x, uint16_t > COMP_LAT_MAP {
-    { COMP_LAT_x::NON_LATCHING,     0b0000000000000000 }, /* DEFAULT */
-    { COMP_LAT_x::LATCHING,         0b0000000000000100 },
-    { COMP_LAT_x::_MASK,            0b0000000000000100 }
-  };
+  inline static constexpr field< COMP_LAT_x, uint16_t, 2, 1 > COMP_LAT_FIELD {{
+    { COMP_LAT_x::NON_LATCHING,      0b0 }, /* DEFAULT */
+    { COMP_LAT_x::LATCHING,          0b1 }
+  }};
 
   enum class COMP_QUE_x : int {
     _NONE = -1, _MASK = -2,
@@ -468,76 +682,69 @@ private:
         FOUR = int( COMP_QUE::FOUR    ),
     DISABLE  = int( COMP_QUE::DISABLE )
   };
-  inline static const std::map< COMP_QUE_x, uint16_t > COMP_QUE_MAP {
-    { COMP_QUE_x::ONE,               0b0000000000000000 },
-    { COMP_QUE_x::TWO,               0b0000000000000001 },
-    { COMP_QUE_x::FOUR,              0b0000000000000010 },
-    { COMP_QUE_x::DISABLE,           0b0000000000000011 }, /* DEFAULT */
-    { COMP_QUE_x::_MASK,             0b0000000000000011 }
-  };
- 
-  enum class AINp_x : int {
-    _NONE = -1, _MASK = -2,
-    AIN0 = 1, AIN1, AIN2, AIN3
-  };
-  enum class AINn_x : int {
-    _NONE = -1, _MASK = -2,
-    AIN1 = 1, AIN3, GND
+  inline static constexpr field< COMP_QUE_x, uint16_t, 0, 2 > COMP_QUE_FIELD {{
+    { COMP_QUE_x::ONE,               0b00 },
+    { COMP_QUE_x::TWO,               0b01 },
+    { COMP_QUE_x::FOUR,              0b10 },
+    { COMP_QUE_x::DISABLE,           0b11 }  /* DEFAULT */
+  }};
+
+  // Full scale millivolts and samples per second, indexed by
+  // PGA_GAIN_x and SAMPLE_RATE_x.
+
+  inline static constexpr std::array< int, 7 > gain_mv {
+    0, 6144, 4096, 2048, 1024, 512, 256
   };
-  inline static const
-  std::map< std::tuple< AINp_x, AINn_x >, uint16_t > MUX_MAP {
-    { { AINp_x::AIN0,  AINn_x::AIN1  }, 0b0000000000000000 }, /* DEFAULT */
-    { { AINp_x::AIN0,  AINn_x::AIN3  }, 0b0001000000000000 },
-    { { AINp_x::AIN1,  AINn_x::AIN3  }, 0b0010000000000000 },
-    { { AINp_x::AIN2,  AINn_x::AIN3  }, 0b0011000000000000 },
-    { { AINp_x::AIN0,  AINn_x::GND   }, 0b0100000000000000 },
-    { { AINp_x::AIN1,  AINn_x::GND   }, 0b0101000000000000 },
-    { { AINp_x::AIN2,  AINn_x::GND   }, 0b0110000000000000 },
-    { { AINp_x::AIN3,  AINn_x::GND   }, 0b0111000000000000 },
-    { { AINp_x::_MASK, AINn_x::_MASK }, 0b0111000000000000 }
+  inline static constexpr std::array< int, 8 > rate_sps {
+    0, 128, 250, 490, 920, 1600, 2400, 3300
   };
 
-  inline static const std::map< PGA_GAIN_x, int > gain_xlate_f {
-    { PGA_GAIN_x::FS_6144, 6144 },
-    { PGA_GAIN_x::FS_4096, 4096 },
-    { PGA_GAIN_x::FS_2048, 2048 },
-    { PGA_GAIN_x::FS_1024, 1024 },
-    { PGA_GAIN_x::FS_512,   512 },
-    { PGA_GAIN_x::FS_256,   256 }
-  };
-  inline static const std::map< int, PGA_GAIN_x > gain_xlate_r {
-    { 6144, PGA_GAIN_x::FS_6144 },
-    { 4096, PGA_GAIN_x::FS_4096 },
-    { 2048, PGA_GAIN_x::FS_2048 },
-    { 1024, PGA_GAIN_x::FS_1024 },
-    {  512, PGA_GAIN_x::FS_512  },
-    {  256, PGA_GAIN_x::FS_256  }
-  };
+  // The conversion time's slop: the internal oscillator is good to
+  // 10% and a single shot conversion first wakes from power down.
 
-  inline static const std::map< SAMPLE_RATE_x, int > rate_xlate_f {
-    { SAMPLE_RATE_x::SR_128,   128 },
-    { SAMPLE_RATE_x::SR_250,   250 },
-    { SAMPLE_RATE_x::SR_490,   490 },
-    { SAMPLE_RATE_x::SR_920,   920 },
-    { SAMPLE_RATE_x::SR_1600, 1600 },
-    { SAMPLE_RATE_x::SR_2400, 2400 },
-    { SAMPLE_RATE_x::SR_3300, 3300 }
-  };
-  inline static const std::map< int, SAMPLE_RATE_x > rate_xlate_r {
-    {  128, SAMPLE_RATE_x::SR_128  },
-    {  250, SAMPLE_RATE_x::SR_250  },
-    {  490, SAMPLE_RATE_x::SR_490  },
-    {  920, SAMPLE_RATE_x::SR_920  },
-    { 1600, SAMPLE_RATE_x::SR_1600 },
-    { 2400, SAMPLE_RATE_x::SR_2400 },
-    { 3300, SAMPLE_RATE_x::SR_3300 }
-  };
+  inline static constexpr int osc_tolerance_pct = 10;
+  inline static constexpr int wake_up_us        = 25;
+
+  // Once calibrated, the guard on the measured period.
+
+  inline static constexpr int cal_guard_pct = 2;
+
+  // The period at a rate, in nanoseconds, nominal or as measured.
+
+  int64_t _period_ns( const int rate ) const noexcept;
+
+  // Conversion-ready polling: sleep this much of a nominal conversion
+  // first then poll the OS bit, the interval doubling from the first
+  // to the last.
+
+  inline static constexpr int                       poll_sleep_pct = 90;
+  inline static constexpr std::chrono::microseconds poll_first{ 10 };
+  inline static constexpr std::chrono::microseconds poll_last{ 100 };
+
+  // A threshold register's value for a code, which is left justified
+  // like the conversion register.
+
+  static uint16_t _thresh_reg( const int16_t c ) noexcept {
+    return uint16_t( std::max( -2048, std::min( 2047, int( c ))) * 16 );
+  }
+
+  // Default thresholds, restored when conversion-ready or the window
+  // comparator is off. No conversion is outside of them.
+
+  inline static constexpr uint16_t default_lo_thresh = 0x8000,
+				   default_hi_thresh = 0x7fff;
+
+  // Wait for the conversion operator[] started at t0 to be ready by
+  // edge or polling. Returns when it was ready or, on timeout, now.
+
+  std::chrono::steady_clock::time_point
+  _ready_wait( const std::chrono::steady_clock::time_point t0 ) noexcept;
 
   // Set/get the multiplexer. The multiplexer is used to select which
   // A/D value is read.
 
-  const std::tuple< AINp_x, AINn_x > _mux( void ) const noexcept;
-  const std::tuple< AINp_x, AINn_x > _mux( AINp_x p, AINn_x n );
+  const MUX_x _mux( void ) const noexcept;
+  const MUX_x _mux( const MUX_x m );
 
   // Helpful output operators.
   
@@ -549,12 +756,232 @@ private:
   friend std::ostream& operator<<( std::ostream& os, COMP_POL p );
   friend std::ostream& operator<<( std::ostream& os, COMP_LAT l );
   friend std::ostream& operator<<( std::ostream& os, COMP_QUE q );
-  friend std::ostream& operator<<( std::ostream&,
-				   const std::tuple< AINp_x, AINn_x >& );
+  friend std::ostream& operator<<( std::ostream&, MUX_x m );
 
 };
 
 
+template< size_t N >
+std::array< ads1015::reading, N >
+ads1015::scan( const std::array< CREG, N >& chans ) {
+
+  std::array< reading, N > rVal;
+
+  (void)scan( chans.data(), N, rVal.data());
+
+  return rVal;
+}
+
+
+// Samples several converters together. Each converter has its own
+// sequence of channels and the group converts the k-th channel of
+// every converter at the same time, so a round takes as long as the
+// longest sequence rather than the sum of them. Like ads1015::scan(),
+// each step is one transaction per bus, run as a SAMPLER job on the
+// bus's arbiter, that starts the next conversions and collects the
+// previous ones, and each step sleeps once for the slowest
+// converter's conv_wait(). Buses are driven in parallel.
+//
+// The converters MUST outlive the group and scan() MUST NOT be
+// called from an arbiter job.
+//
+// Each channel may have an alarm window. The group programs each
+// conversion's window into its converter's window comparator in the
+// step that starts it, so ALERT/RDY follows the channel being
+// converted, and checks each reading against the same codes as it
+// arrives - one conversion after the start rather than after any
+// smoothing the caller does.
+
+class ads1015_group {
+
+public:
+
+  ads1015_group( void );
+
+  ads1015_group( const ads1015_group&  g ) = delete;
+  ads1015_group( const ads1015_group&& g ) = delete;
+
+  ads1015_group& operator=( const ads1015_group&  g ) = delete;
+  ads1015_group& operator=( const ads1015_group&& g ) = delete;
+
+  // Add a converter and its channels. A converter in continuous
+  // mode is put in single shot mode, like ads1015::scan() does, and
+  // MUST stay in it while in the group. Returns the converter's
+  // index in the group.
+
+  size_t add( ads1015& a, const std::vector< ads1015::CREG >& chans );
+
+  // Convert every converter's channels. Returns the number of
+  // channels read. When every converter has a conversion-ready line
+  // (see ads1015::conv_ready()) a step ends at their edges rather
+  // than after the conversion wait.
+
+  size_t scan( void );
+
+  // Set channel k of converter i's alarm window in conversion
+  // register codes (see ads1015::code()). A reading above hi or
+  // below lo is in alarm. lo = INT16_MIN and hi = INT16_MAX, the
+  // default, never alarm. on_alarm()'s function is called on scan()'s
+  // thread when a channel goes into alarm (in is true) or comes out
+  // of it. Neither may be called during a scan().
+  //
+  // A channel comes out of alarm only once its reading is back
+  // inside the window by a margin, the larger of hysteresis_codes
+  // and hysteresis_pct of the threshold, so a reading hovering at the
+  // level doesn't toggle the alarm every scan.
+
+  using alarm_fn = std::function< void( const size_t i, const size_t k,
+					const ads1015::reading& r,
+					const bool in ) >;
+
+  int  alarm( const size_t i, const size_t k,
+	      const int16_t lo, const int16_t hi );
+  void on_alarm( alarm_fn f );
+
+  // The last scan's readings of converter i, in channel order, and
+  // the heap allocations its bus I/O made (zero in steady state).
+
+  const std::vector< ads1015::reading >& readings( const size_t i )
+    const noexcept;
+  size_t allocs( void ) const noexcept;
+
+  size_t size( void ) const noexcept;
+
+private:
+
+  struct window {
+    int16_t lo;
+    int16_t hi;
+    bool    in;    // in alarm
+  };
+
+  struct member {
+    ads1015*                              adc;
+    size_t                                bus;
+    std::vector< ads1015::reading >       out;
+    std::vector< window >                 win;
+    window                                dev;   // what the converter has
+    bool                                  comp;  // window comparator on
+    uint8_t                               r_buf[2];
+    ssize_t                               s_idx;
+    ssize_t                               r_idx;
+    ssize_t                               t_idx;
+    bool                                  started;
+    std::chrono::steady_clock::time_point ready; // its edge, if one came
+  };
+
+  struct bus {
+    arbiter*                     arb;
+    std::unique_ptr< i2c_batch > batch;
+  };
+
+  // The alarms' hysteresis, see alarm().
+
+  inline static constexpr int hysteresis_codes = 4, hysteresis_pct = 2;
+
+  std::vector< member >                myMembers;
+  std::vector< bus >                   myBuses;
+  std::vector< std::future< size_t > > myPending;
+  std::atomic< size_t >                myAllocs;
+  alarm_fn                             myAlarm;
+
+  // Run step of a scan on bus b's members. Returns the number of
+  // channels read.
+
+  size_t _step( const size_t b, const size_t step ) noexcept;
+
+};
+
+
+constexpr
+float
+ads1015::scale( const PGA_GAIN g ) noexcept {
+
+  // Full scale is 2048 codes.
+
+  return (( int( g ) > 0 ) && ( size_t( g ) < gain_mv.size()))
+    ? float( gain_mv[ int( g )]) / 2048000.0f : 0.0f;
+}
+
+
+inline
+float
+ads1015::scale( void ) const noexcept {
+
+  return scale( gain());
+}
+
+
+constexpr
+int16_t
+ads1015::code( const uint8_t* r_buf ) noexcept {
+
+  // The code is left justified so an arithmetic shift sign extends.
+
+  return int16_t( int16_t(( r_buf[0] << 8 ) | r_buf[1] ) >> 4 );
+}
+
+
+inline
+const ads1015::conv_timing&
+ads1015::timing( void ) const noexcept {
+
+  return myTiming;
+}
+
+
+inline
+bool
+ads1015::conv_ready( void ) const noexcept {
+
+  return myReady;
+}
+
+
+inline
+const std::shared_ptr< alert_line >
+ads1015::ready_line( void ) const noexcept {
+
+  return myReady ? myAlert : nullptr;
+}
+
+
+inline
+const ads1015::latency
+ads1015::ready_latency( void ) const noexcept {
+
+  std::lock_guard< std::mutex > lck( myLatencyLock );
+
+  return myLatency;
+}
+
+
+inline
+const std::vector< ads1015::reading >&
+ads1015_group::readings( const size_t i ) const noexcept {
+
+  assert( i < myMembers.size());
+
+  return myMembers[i].out;
+}
+
+
+inline
+size_t
+ads1015_group::allocs( void ) const noexcept {
+
+  return myAllocs.load();
+}
+
+
+inline
+size_t
+ads1015_group::size( void ) const noexcept {
+
+  return myMembers.size();
+}
+
+
 std::ostream& operator<<( std::ostream& os, ads1015::OS o );
 std::ostream& operator<<( std::ostream& os, ads1015::PGA_GAIN g );
 std::ostream& operator<<( std::ostream& os, ads1015::MODE m );
@@ -563,9 +990,7 @@ std::ostream& operator<<( std::ostream& os, ads1015::COMP_MODE m );
 std::ostream& operator<<( std::ostream& os, ads1015::COMP_POL p );
 std::ostream& operator<<( std::ostream& os, ads1015::COMP_LAT l );
 std::ostream& operator<<( std::ostream& os, ads1015::COMP_QUE q );
-std::ostream& operator<<( std::ostream& os,
-                          const std::tuple< ads1015::AINp_x,
-			                    ads1015::AINn_x >& m );
+std::ostream& operator<<( std::ostream& os, ads1015::MUX_x m );
 
 
 #endif
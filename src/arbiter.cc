@@ -0,0 +1,205 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019, Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * $Log$
+ *
+ */
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "arbiter.h"
+#include "log.h"
+#include "util.h"
+
+
+extern const std::vector< std::string > arbiter_ident {
+  _ARBITER_H_ID, "$Id$"
+};
+
+
+// The arbiters, one per bus. Arbiters are never deleted, only
+// stopped, so references handed out stay valid.
+
+static std::mutex                                    arbiters_lock;
+static std::map< std::string, std::unique_ptr< arbiter >> arbiters;
+
+
+arbiter&
+arbiter::get( const std::string& bus ) {
+
+  std::lock_guard< std::mutex > lck( arbiters_lock );
+
+  auto it = arbiters.find( bus );
+
+  if( it == arbiters.end())
+    it = arbiters.emplace
+      ( bus, std::unique_ptr< arbiter >( new arbiter( bus ))).first;
+
+  return *it->second;
+}
+
+
+void
+arbiter::stop_all( void ) noexcept {
+
+  std::lock_guard< std::mutex > lck( arbiters_lock );
+
+  for( auto& [b,a] : arbiters )
+    a->stop();
+
+}
+
+
+arbiter::arbiter( const std::string& bus )
+  : myBus( bus ), mySeq( 0 ), myStop( false ) {
+
+  for( auto& s : myStats )
+    s = { 0, std::chrono::microseconds( 0 ), std::chrono::microseconds( 0 ) };
+
+}
+
+
+arbiter::~arbiter( void ) {
+
+  stop();
+
+}
+
+
+void
+arbiter::stop( void ) noexcept {
+
+  {
+    std::lock_guard< std::mutex > lck( myLock );
+
+    myStop = true;
+  }
+
+  myCV.notify_all();
+
+  if( myWorker.joinable())
+    myWorker.join();
+
+  // Anything left in the queue still gets run so nobody waits
+  // forever on a future.
+
+  std::unique_lock< std::mutex > lck( myLock );
+
+  while( myQueue.empty() == false ) {
+
+    job j = std::move( const_cast< job& >( myQueue.top()));
+
+    myQueue.pop();
+    lck.unlock();
+    j.f();
+    lck.lock();
+
+  }
+}
+
+
+void
+arbiter::_push( const PRIORITY p, std::function< void( void ) >&& f ) {
+
+  std::unique_lock< std::mutex > lck( myLock );
+
+  if( myStop ) {
+
+    // No worker, do it here.
+
+    lck.unlock();
+    f();
+
+  } else {
+
+    if( myWorker.joinable() == false )
+      myWorker = std::thread( &arbiter::_run, this );
+
+    myQueue.push( { int( p ), mySeq++, std::chrono::steady_clock::now(),
+		    std::move( f ) } );
+
+    lck.unlock();
+    myCV.notify_one();
+
+  }
+}
+
+
+void
+arbiter::_run( void ) noexcept {
+
+  _LOG_VERB(( "bus=", quote( myBus ), " tid=", _tid(), " running" ));
+
+  std::unique_lock< std::mutex > lck( myLock );
+
+  while( true ) {
+
+    myCV.wait( lck, [this]{ return myStop || ( myQueue.empty() == false ); });
+
+    if( myStop )
+      break;
+
+    job j = std::move( const_cast< job& >( myQueue.top()));
+
+    myQueue.pop();
+
+    // Account for how long the job sat in the queue.
+
+    const auto waited = std::chrono::duration_cast< std::chrono::microseconds >
+      ( std::chrono::steady_clock::now() - j.queued );
+    stats&     s      = myStats[ j.prio ];
+
+    ++s.count;
+    s.total += waited;
+    if( waited > s.max )
+      s.max = waited;
+
+    // Run the job without the lock so more can be queued.
+
+    lck.unlock();
+    j.f();
+    lck.lock();
+
+  }
+
+  _LOG_VERB(( "bus=", quote( myBus ), " exiting" ));
+}
+
+
+const arbiter::stats
+arbiter::wait( const PRIORITY p ) const noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  return myStats[ int( p )];
+}
@@ -0,0 +1,173 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019, Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * $Log$
+ *
+ */
+
+#ifndef __ARBITER_H__
+#define __ARBITER_H__
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "log.h"
+
+
+#define _ARBITER_H_ID "$Id$"
+
+
+// An arbiter owns an i2c bus. Rather than threads taking a lock and
+// talking to devices, they hand the arbiter a job (a function doing
+// the bus I/O) and the arbiter's worker thread runs the jobs one at a
+// time, highest priority first and first-come first-served within a
+// priority. The caller gets a std::future for the job's result.
+//
+// A job runs to completion once started. Therefore, a job SHOULD be
+// one short transaction or a few of them - never a sleep and never
+// a whole display frame - so a higher priority job never waits
+// long. Formatting and other non-bus work belongs in the caller.
+//
+// The worker thread is started on the first submit(), which matters
+// because the daemon fork()s after initializing devices.
+
+class arbiter {
+
+public:
+
+  // The priorities, highest first. The sampler MUST never wait
+  // behind the display.
+
+  enum class PRIORITY : int { SAMPLER = 0, MUNIN, DISPLAY };
+
+  // How long jobs of a priority waited in the queue before running.
+
+  struct stats {
+    uint64_t                  count;
+    std::chrono::microseconds total;
+    std::chrono::microseconds max;
+  };
+
+  // The arbiter of a bus, created on first use, and a way to stop
+  // every arbiter's worker when the program exits. Jobs submitted
+  // after stop() run on the caller's thread.
+
+  static arbiter& get( const std::string& bus );
+  static void     stop_all( void ) noexcept;
+
+  ~arbiter( void );
+
+  arbiter( const arbiter&  a ) = delete;
+  arbiter( const arbiter&& a ) = delete;
+
+  arbiter& operator=( const arbiter&  a ) = delete;
+  arbiter& operator=( const arbiter&& a ) = delete;
+
+  template< typename F >
+  std::future< std::invoke_result_t< F >>
+  submit( const PRIORITY p, F&& f );
+
+  const stats        wait( const PRIORITY p ) const noexcept;
+  const std::string& bus(  void             ) const noexcept;
+
+  void stop( void ) noexcept;
+
+private:
+
+  explicit arbiter( const std::string& bus );
+
+  inline static constexpr size_t num_priorities = 3;
+
+  struct job {
+    int                                   prio;
+    uint64_t                              seq;
+    std::chrono::steady_clock::time_point queued;
+    std::function< void( void ) >         f;
+  };
+
+  // std::priority_queue puts the "largest" on top so the ordering is
+  // backwards: lower priority numbers and older jobs are larger.
+
+  struct later {
+    bool operator()( const job& a, const job& b ) const noexcept {
+      return ( a.prio != b.prio ) ? ( a.prio > b.prio ) : ( a.seq > b.seq );
+    }
+  };
+
+  const std::string                                     myBus;
+  mutable std::mutex                                    myLock;
+  std::condition_variable                               myCV;
+  std::priority_queue< job, std::vector< job >, later > myQueue;
+  uint64_t                                              mySeq;
+  bool                                                  myStop;
+  std::thread                                           myWorker;
+  std::array< stats, num_priorities >                   myStats;
+
+  void _push( const PRIORITY p, std::function< void( void ) >&& f );
+  void _run( void ) noexcept;
+
+};
+
+
+template< typename F >
+std::future< std::invoke_result_t< F >>
+arbiter::submit( const PRIORITY p, F&& f ) {
+
+  using R = std::invoke_result_t< F >;
+
+  // std::function wants something copyable and a packaged_task isn't.
+
+  auto t = std::make_shared< std::packaged_task< R( void ) >>
+    ( std::forward< F >( f ));
+  std::future< R > rVal = t->get_future();
+
+  _push( p, [t]( void ) { (*t)(); } );
+
+  return rVal;
+}
+
+
+inline
+const std::string&
+arbiter::bus( void ) const noexcept {
+
+  return myBus;
+}
+
+
+#endif
@@ -0,0 +1,410 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019 Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * A small benchmark of the i2c transaction paths. It reads, writes,
+ * and reads back an ADS1015's 16-bit config register N times, first
+ * with a separate write() and read() per register access, then with
+ * one combined (repeated start) I2C_RDWR transaction, and then with
+ * SMBus word data transfers, and prints the system calls and wall
+ * time per sample of each.
+ *
+ * This is a separate program rather than an option of the daemon
+ * so it can be run while the daemon owns the bus. With -s it runs
+ * on the simulated bus instead (see sim.h), and then also times
+ * Micro Dot pHAT frames, drawn and rendered, and drawn and shown.
+ *
+ *
+ * $Log$
+ *
+ */
+
+extern "C" {
+
+#include <getopt.h>
+#include <stdlib.h>
+
+}
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ads1015.h"
+#include "i2c.h"
+#include "log.h"
+#include "microdotphat.h"
+#include "sim.h"
+#include "util.h"
+
+
+static const std::string bench_ident = "$Id$";
+
+
+// Starts a conversion and reads the config register back n times
+// through a and returns the number of syscalls and the elapsed
+// microseconds. There are no conversion waits so the numbers are the
+// transaction path's.
+
+static std::pair< uint64_t, double >
+run( ads1015& a, const size_t n ) {
+
+  const uint64_t s_cnt = i2c::syscalls();
+  const auto     s_tm  = std::chrono::steady_clock::now();
+
+  for( size_t i = 0; i < n; ++i ) {
+
+    a.start( ads1015::CREG::CHAN0 );
+    a.resync();
+
+  }
+
+  const auto     e_tm  = std::chrono::steady_clock::now();
+  const uint64_t e_cnt = i2c::syscalls();
+
+  return std::make_pair
+    ( e_cnt - s_cnt,
+      std::chrono::duration< double, std::micro >( e_tm - s_tm ).count());
+}
+
+
+// Takes n samples through a, conversion waits and all.
+
+static std::pair< uint64_t, double >
+sample( ads1015& a, const size_t n ) {
+
+  const uint64_t s_cnt = i2c::syscalls();
+  const auto     s_tm  = std::chrono::steady_clock::now();
+
+  for( size_t i = 0; i < n; ++i )
+    (void)a[ ads1015::CREG::CHAN0 ];
+
+  const auto     e_tm  = std::chrono::steady_clock::now();
+  const uint64_t e_cnt = i2c::syscalls();
+
+  return std::make_pair
+    ( e_cnt - s_cnt,
+      std::chrono::duration< double, std::micro >( e_tm - s_tm ).count());
+}
+
+
+// Scans all four channels n times through a.
+
+static std::pair< uint64_t, double >
+scan( ads1015& a, const size_t n ) {
+
+  const std::array< ads1015::CREG, 4 > chans {
+    ads1015::CREG::CHAN0, ads1015::CREG::CHAN1,
+    ads1015::CREG::CHAN2, ads1015::CREG::CHAN3
+  };
+
+  const uint64_t s_cnt = i2c::syscalls();
+  const auto     s_tm  = std::chrono::steady_clock::now();
+
+  for( size_t i = 0; i < n; ++i )
+    (void)a.scan( chans );
+
+  const auto     e_tm  = std::chrono::steady_clock::now();
+  const uint64_t e_cnt = i2c::syscalls();
+
+  return std::make_pair
+    ( e_cnt - s_cnt,
+      std::chrono::duration< double, std::micro >( e_tm - s_tm ).count());
+}
+
+
+static void
+report( const std::string& what, const size_t n,
+	const std::pair< uint64_t, double >& r ) {
+
+  std::cout << std::left << std::setw( 10 ) << what
+	    << " samples=" << n
+	    << " syscalls/sample=" << double( r.first ) / double( n )
+	    << " us/sample=" << r.second / double( n )
+	    << std::endl;
+}
+
+
+// Samples n times with conversion-ready wakeup, by line if there is
+// one or by polling, and reports the ready to delivery latency too.
+
+static void
+ready( ads1015& a, const std::string& what, const size_t n,
+       std::shared_ptr< alert_line > line ) {
+
+  if( a.conv_ready( true, line ) < 0 ) {
+    std::cout << std::left << std::setw( 10 ) << what
+	      << " conversion-ready failed" << std::endl;
+    return;
+  }
+
+  const auto s_l = a.ready_latency();
+
+  report( what, n, sample( a, n ));
+
+  const auto e_l = a.ready_latency();
+  const auto cnt = e_l.count - s_l.count;
+
+  if( cnt > 0 )
+    std::cout << std::left << std::setw( 10 ) << ""
+	      << " ready->delivered us avg="
+	      << double(( e_l.total - s_l.total ).count()) / double( cnt )
+	      << " max=" << e_l.max.count() << std::endl;
+
+  (void)a.conv_ready( false );
+}
+
+
+// Streams n samples of CHAN3 at 3300 SPS with a consumer thread
+// draining the ring, the way a transient capture would.
+
+static void
+stream( ads1015& a, const size_t n ) {
+
+  ads1015::sample_ring ring( 1024 );
+  std::atomic< bool >  stop( false ), done( false );
+  size_t               got  = 0;
+  int16_t              lo   = INT16_MAX, hi = INT16_MIN;
+
+  std::thread consumer( [&]( void ) {
+
+      ads1015::sample s;
+
+      while( true ) {
+
+	const bool last = done.load();
+
+	while( ring.pop( s )) {
+	  ++got;
+	  lo = std::min( lo, s.code );
+	  hi = std::max( hi, s.code );
+	}
+
+	if( last )
+	  break;
+
+	std::this_thread::sleep_for( std::chrono::milliseconds( 1 ));
+
+      }
+    });
+
+  const uint64_t s_cnt = i2c::syscalls();
+  const auto     s_tm  = std::chrono::steady_clock::now();
+
+  const ads1015::stream_stats st =
+    a.stream( ads1015::CREG::CHAN3, ads1015::SAMPLE_RATE::SR_3300,
+	      ring, stop, n );
+
+  const auto     e_tm  = std::chrono::steady_clock::now();
+  const uint64_t e_cnt = i2c::syscalls();
+
+  done = true;
+  consumer.join();
+
+  report( "stream", n, std::make_pair
+	  ( e_cnt - s_cnt,
+	    std::chrono::duration< double, std::micro >( e_tm - s_tm ).count()));
+
+  std::cout << std::left << std::setw( 10 ) << ""
+	    << " missed=" << st.missed << " errors=" << st.errors
+	    << " overruns=" << ring.overruns() << " consumed=" << got
+	    << " codes=[" << lo << "," << hi << "]" << std::endl;
+}
+
+
+// Draws n full frames on d, a six digit number with a decimal point
+// that changes every frame, and either renders each (the frame buffer
+// to the chips' matrices) or shows it (render and upload).
+
+static void
+frames( MicroDotpHAT& d, const std::string& what, const size_t n,
+	const bool upload ) {
+
+  const uint64_t s_cnt = i2c::syscalls();
+  const auto     s_tm  = std::chrono::steady_clock::now();
+
+  for( size_t i = 0; i < n; ++i ) {
+
+    char buf[ 8 ];
+
+    ::snprintf( buf, sizeof( buf ), "%06zu", i % 1000000 );
+
+    d.clear();
+    d.write_string( buf );
+    d.set_decimal( i % d.num_digits(), true );
+
+    if( upload )
+      (void)d.show();
+    else
+      d.render();
+
+  }
+
+  const auto     e_tm  = std::chrono::steady_clock::now();
+  const uint64_t e_cnt = i2c::syscalls();
+  const double   us    =
+    std::chrono::duration< double, std::micro >( e_tm - s_tm ).count();
+
+  report( what, n, std::make_pair( e_cnt - s_cnt, us ));
+
+  std::cout << std::left << std::setw( 10 ) << ""
+	    << " frames/s=" << ( us > 0.0 ? 1e6 * double( n ) / us : 0.0 )
+	    << std::endl;
+}
+
+
+int
+main( int argc, char* argv[] ) {
+
+  std::string bus  = "/dev/i2c-1";
+  int16_t     addr = 0x49;
+  size_t      n    = 1000;
+  double      sim  = 0.0;
+  int         ch;
+
+  while(( ch = ::getopt( argc, argv, "a:b:n:s:h" )) != -1 ) {
+
+    switch( ch ) {
+
+    case 'a':
+      addr = int16_t( ::strtol( optarg, nullptr, 0 ));
+      break;
+
+    case 'b':
+      bus = optarg;
+      break;
+
+    case 'n':
+      n = size_t( ::strtoul( optarg, nullptr, 0 ));
+      break;
+
+    case 's':
+      sim = ::strtod( optarg, nullptr );
+      break;
+
+    case 'h':
+    default:
+      std::cerr << "usage: " << argv[0]
+		<< " [-a addr] [-b bus] [-n samples] [-s sim_speed]"
+		<< std::endl;
+      return ch == 'h' ? 0 : 1;
+
+    }
+  }
+
+  if( n == 0 )
+    n = 1;
+
+  std::shared_ptr< i2c_sim > simulator;
+
+  if( sim > 0.0 )
+    i2c::transport( simulator = i2c_sim::attic( sim ));
+
+  ads1015 a( bus, addr );
+
+  if( a.fd() < 0 ) {
+
+    std::cerr << "No ADS1015 at " << bus << ", addr=" << addr << std::endl;
+    return 1;
+
+  }
+
+  a.smbus( false );
+
+  if( !a.combined( false )) {
+
+    report( "separate", n, run( a, n ));
+
+    if( a.combined( true ))
+      report( "combined", n, run( a, n ));
+    else
+      std::cout << "combined  not supported by adapter" << std::endl;
+
+  }
+
+  if( a.smbus( true ))
+    report( "smbus", n, run( a, n ));
+  else
+    std::cout << "smbus     not supported by adapter" << std::endl;
+
+  // Whole samples are slow, conversion waits and all, so fewer.
+
+  report( "sample", ( n + 99 ) / 100, sample( a, ( n + 99 ) / 100 ));
+  report( "scan",   4 * (( n + 99 ) / 100 ), scan( a, ( n + 99 ) / 100 ));
+
+  // Again with the conversion waits sized from a measurement.
+
+  const auto wait = a.conv_wait();
+
+  if( a.calibrate() == 0 ) {
+
+    const ads1015::conv_timing& t = a.timing();
+
+    std::cout << std::left << std::setw( 10 ) << "calibrate"
+	      << " measured=" << t.measured.count() << "us"
+	      << " ratio=" << t.ratio << " spread=" << t.spread
+	      << " wait=" << wait.count() << "->" << a.conv_wait().count()
+	      << "us" << std::endl;
+
+    report( "sample",  ( n + 99 ) / 100, sample( a, ( n + 99 ) / 100 ));
+    report( "scan", 4 * (( n + 99 ) / 100 ), scan( a, ( n + 99 ) / 100 ));
+
+  } else
+    std::cout << "calibrate failed" << std::endl;
+
+  // Conversion-ready wakeup. Only the simulator has an ALERT/RDY
+  // line here as the wiring of a real one is unknown.
+
+  ready( a, "polled", ( n + 99 ) / 100, nullptr );
+  if( simulator )
+    ready( a, "alert", ( n + 99 ) / 100, simulator->alert( bus, addr ));
+
+  stream( a, n );
+
+  // The display is only drawn on when simulated so a running daemon's
+  // isn't disturbed.
+
+  if( simulator ) {
+
+    MicroDotpHAT d;
+
+    frames( d, "render", 100 * n, false );
+    frames( d, "show",   n,       true  );
+
+  }
+
+  return 0;
+}
+
+
+// LocalWords:  RDWR syscalls
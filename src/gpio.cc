@@ -0,0 +1,186 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019, Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * $Log$
+ *
+ */
+
+
+extern "C" {
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+#include <sys/types.h>
+
+#include <linux/gpio.h>
+
+}
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "gpio.h"
+#include "log.h"
+#include "util.h"
+
+
+extern const std::vector< std::string > gpio_ident {
+  _GPIO_H_ID, "$Id$"
+};
+
+
+gpio_alert::gpio_alert( const std::string& chip, const unsigned offset,
+			const bool falling )
+  : myFD( -1 ) {
+
+  const int chip_fd = ::open( chip.c_str(), O_RDONLY | O_CLOEXEC );
+
+  if( chip_fd < 0 ) {
+
+    _LOG_WARN(( "Cannot open ", quote( chip ), errno2str()));
+
+  } else {
+
+    struct gpio_v2_line_request req;
+
+    ::memset( &req, 0, sizeof( req ));
+
+    req.offsets[0]   = offset;
+    req.num_lines    = 1;
+    req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_BIAS_PULL_UP
+      | ( falling ? GPIO_V2_LINE_FLAG_EDGE_FALLING
+		  : GPIO_V2_LINE_FLAG_EDGE_RISING );
+    ::strncpy( req.consumer, "sensors", sizeof( req.consumer ) - 1 );
+
+    if( ::ioctl( chip_fd, GPIO_V2_GET_LINE_IOCTL, &req ) < 0 )
+      _LOG_WARN(( "Cannot request line ", offset, " of ", quote( chip ),
+		  errno2str()));
+    else {
+
+      // Non-blocking so flush() can drain without waiting.
+
+      myFD = req.fd;
+      ::fcntl( myFD, F_SETFL, ::fcntl( myFD, F_GETFL ) | O_NONBLOCK );
+
+    }
+
+    ::close( chip_fd );
+
+  }
+}
+
+
+gpio_alert::~gpio_alert( void ) {
+
+  if( myFD >= 0 )
+    ::close( myFD );
+
+}
+
+
+int
+gpio_alert::_read( std::chrono::steady_clock::time_point& when ) noexcept {
+
+  struct gpio_v2_line_event ev;
+
+  const ssize_t r_num = ::read( myFD, &ev, sizeof( ev ));
+
+  if( r_num == ssize_t( sizeof( ev ))) {
+
+    when = std::chrono::steady_clock::time_point
+      ( std::chrono::duration_cast< std::chrono::steady_clock::duration >
+	( std::chrono::nanoseconds( ev.timestamp_ns )));
+
+    return 1;
+
+  }
+
+  return (( r_num < 0 ) && ( errno == EAGAIN )) ? 0 : -1;
+}
+
+
+int
+gpio_alert::flush( void ) noexcept {
+
+  int rVal = 0;
+
+  if( myFD < 0 )
+    rVal = -1;
+  else {
+
+    std::chrono::steady_clock::time_point when;
+
+    while( _read( when ) > 0 )
+      ++rVal;
+
+  }
+
+  return rVal;
+}
+
+
+int
+gpio_alert::wait( const std::chrono::microseconds        timeout,
+		  std::chrono::steady_clock::time_point& when ) noexcept {
+
+  if( myFD < 0 )
+    return -1;
+
+  // An edge may already be queued.
+
+  int rVal = _read( when );
+
+  if( rVal == 0 ) {
+
+    struct pollfd   pfd { myFD, POLLIN, 0 };
+    struct timespec ts  { time_t( timeout.count() / 1000000 ),
+			  long(( timeout.count() % 1000000 ) * 1000 ) };
+
+    const int p = ::ppoll( &pfd, 1, &ts, nullptr );
+
+    if( p < 0 )
+      rVal = -1;
+    else
+      if( p > 0 )
+	rVal = _read( when );
+
+  }
+
+  if( rVal < 0 )
+    _LOG_WARN(( "GPIO line wait failed", errno2str()));
+
+  return rVal;
+}
+
+
+//  LocalWords:  uAPI
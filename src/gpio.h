@@ -0,0 +1,116 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019, Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * $Log$
+ *
+ */
+
+
+#ifndef __GPIO_H__
+#define __GPIO_H__
+
+extern "C" {
+
+#include <sys/types.h>
+
+}
+
+#include <chrono>
+#include <string>
+
+
+#define _GPIO_H_ID "$Id$"
+
+
+// An input line that something waits on for an edge, such as an
+// ADS1015's ALERT/RDY pin.
+//
+//   flush() - forget edges already seen, returns how many.
+//   wait()  - wait up to timeout for an edge, returns 1 and when
+//             the edge happened, 0 on timeout, or -1 on error.
+//
+// gpio_alert is a line on a GPIO chip. i2c_sim (sim.h) has simulated
+// ALERT/RDY lines.
+
+class alert_line {
+
+public:
+
+  virtual ~alert_line( void ) {}
+
+  virtual int flush( void ) noexcept = 0;
+  virtual int wait( const std::chrono::microseconds        timeout,
+		    std::chrono::steady_clock::time_point& when ) noexcept = 0;
+
+};
+
+
+// A line of a GPIO chip (e.g., "/dev/gpiochip0") through the
+// character device uAPI, watching for falling edges (ALERT/RDY is
+// open drain and active low unless COMP_POL says otherwise) with a
+// pull up. The kernel timestamps edges against CLOCK_MONOTONIC, the
+// same clock as std::chrono::steady_clock.
+
+class gpio_alert : public alert_line {
+
+public:
+
+  gpio_alert( const std::string& chip, const unsigned offset,
+	      const bool falling = true );
+  ~gpio_alert( void );
+
+  gpio_alert( const gpio_alert&  g ) = delete;
+  gpio_alert( const gpio_alert&& g ) = delete;
+
+  gpio_alert& operator=( const gpio_alert&  g ) = delete;
+  gpio_alert& operator=( const gpio_alert&& g ) = delete;
+
+  // Whether the line was granted.
+
+  bool ok( void ) const noexcept;
+
+  int flush( void ) noexcept override;
+  int wait( const std::chrono::microseconds        timeout,
+	    std::chrono::steady_clock::time_point& when ) noexcept override;
+
+private:
+
+  int myFD; // The line request, not the chip.
+
+  int _read( std::chrono::steady_clock::time_point& when ) noexcept;
+
+};
+
+
+inline
+bool
+gpio_alert::ok( void ) const noexcept {
+
+  return myFD >= 0;
+}
+
+
+#endif
@@ -116,17 +116,20 @@ extern "C" {
 #include <sys/ioctl.h>
 #include <sys/types.h>
   
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
   
 }
 
-#include <functional>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <map>
-#include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -149,15 +152,123 @@ extern const std::vector< std::string > i2c_ident {
 static const std::string i2c_fname = "/dev/i2c-";
 
 
+// The open adapters, by bus name. The registry doesn't keep adapters
+// open - the devices do.
+
+static std::mutex                                           adapters_lock;
+static std::map< std::string, std::weak_ptr< i2c_adapter >> adapters;
+
+
+// What adapters are opened on.
+
+static std::shared_ptr< i2c_transport > xport =
+  std::make_shared< i2c_linux >();
+
+
+// Return the shared, open adapter of a bus, opening it if no device
+// has it open.
+
+static std::shared_ptr< i2c_adapter >
+adapter_open( const std::string& bus ) noexcept {
+
+  std::lock_guard< std::mutex > lck( adapters_lock );
+
+  std::shared_ptr< i2c_adapter > rVal = adapters[ bus ].lock();
+
+  if( rVal.get() == nullptr ) {
+
+    if( int tFD = -1; ( tFD = xport->open( bus )) >= 0 ) {
+
+      // What can the adapter do? Addressed messages need plain i2c
+      // transfers (I2C_RDWR) rather than only SMBus commands.
+
+      unsigned long funcs = 0;
+
+      if( int err; ( err = xport->ioctl( tFD, I2C_FUNCS, &funcs )) < 0 ) {
+
+	_LOG_WARN(( "Unable to fetch adapter functionality, bus=",
+		    quote( bus ), ", err=", err, errno2str()));
+	funcs = 0;
+
+      }
+
+      rVal = std::make_shared< i2c_adapter >( bus, xport, tFD, funcs );
+      adapters[ bus ] = rVal;
+
+      _LOG_VERB(( "Opened bus=", quote( bus ), " fd=", tFD,
+		  " funcs=0x", t2hex( uint32_t( funcs ))));
+
+    }
+  }
+
+  return rVal;
+}
+
+
+// Where discover() found addresses answering. Empty until discover()
+// runs.
+
+static std::mutex                       discovered_lock;
+static std::map< int16_t, std::string > discovered;
+
+
+// The range of addresses discover() probes, which is i2cdetect's
+// default range.
+
+static constexpr int16_t probe_first = 0x08;
+static constexpr int16_t probe_last  = 0x77;
+
+
+i2c_adapter::~i2c_adapter( void ) {
+
+  if( fd >= 0 )
+    xport->close( fd );
+
+}
+
+
+bool
+i2c_adapter::bind( const int16_t addr, const bool warn ) noexcept {
+
+  bool rVal = true;
+
+  if( bound != addr ) {
+
+    i2c::mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+
+    // I2C_SLAVE takes the address itself, not a pointer to it.
+
+    if( int err; ( err = ioctl( I2C_SLAVE,
+				reinterpret_cast< void* >( intptr_t( addr ))))
+	< 0 ) {
+
+      if( warn )
+	_LOG_WARN(( "Unable to bind bus=", quote( bus ),
+		    " to addr=0x", t2hex( uint8_t( addr )),
+		    ", err=", err, errno2str()));
+      bound = -1;
+      rVal  = false;
+
+    } else
+      bound = addr;
+
+  }
+
+  return rVal;
+}
+
+
 i2c::i2c( int16_t a )
-  : myAddr( a ) {
+  : myAddr( a ), myCombined( false ), mySMBus( false ),
+    myShadowLen( 0 ), myShadowPolicy( SHADOW::WRITE_THROUGH ) {
 
   _find( addr());
   _doInit();
 }
 
 i2c::i2c( const std::string& b, int16_t a )
-  : myAddr( a ), myBus( b ) {
+  : myAddr( a ), myBus( b ), myCombined( false ), mySMBus( false ),
+    myShadowLen( 0 ), myShadowPolicy( SHADOW::WRITE_THROUGH ) {
   
   _find( b, a );
   _doInit();
@@ -173,9 +284,15 @@ i2c::~i2c( void ) {
 i2c&
 i2c::operator=( i2c& d ) {
   
-  myFD   = d.myFD;
-  myAddr = d.myAddr;
-  myBus  = d.myBus;
+  myAdapter  = d.myAdapter;
+  myAddr     = d.myAddr;
+  myBus      = d.myBus;
+  myCombined = d.myCombined;
+  mySMBus    = d.mySMBus;
+
+  myShadow       = d.myShadow;
+  myShadowLen    = d.myShadowLen;
+  myShadowPolicy = d.myShadowPolicy;
   
   return *this;
 }
@@ -183,11 +300,18 @@ i2c::operator=( i2c& d ) {
 i2c&
 i2c::operator=( i2c&& d ) {
   
-  myFD   = std::move( d.myFD );
-  myAddr = d.myAddr;
-  myBus  = std::move( d.myBus );
+  myAdapter  = std::move( d.myAdapter );
+  myAddr     = d.myAddr;
+  myBus      = std::move( d.myBus );
+  myCombined = d.myCombined;
+  mySMBus    = d.mySMBus;
+
+  myShadow       = d.myShadow;
+  myShadowLen    = d.myShadowLen;
+  myShadowPolicy = d.myShadowPolicy;
   
-  d.myAddr = -1;
+  d.myAddr      = -1;
+  d.myShadowLen = 0;
   
   return *this;
 }
@@ -195,7 +319,7 @@ i2c::operator=( i2c&& d ) {
 bool
 i2c::_doInit( void ) noexcept {
 
-  return myFD.get() && ( addr() >= 0 ) && bus().length();
+  return myAdapter.get() && ( addr() >= 0 ) && bus().length();
 }
 
 
@@ -212,8 +336,22 @@ i2c::_find( int16_t a ) noexcept {
   assert( a >= 0 );
   
   bool found = false;
+
+  // If discover() saw the address, go straight to its bus.
+
+  std::unique_lock< std::mutex > lck( discovered_lock );
+
+  if( auto it = discovered.find( a ); it != discovered.end()) {
+
+    const std::string b = it->second;
+
+    lck.unlock();
+    found = _find( b, a );
+
+  } else
+    lck.unlock();
   
-  for( u_int adapter = 0; adapter < 10; ++adapter ) {
+  for( u_int adapter = 0; ( found == false ) && ( adapter < 10 ); ++adapter ) {
 
     // Form the device file path.
     
@@ -245,32 +383,27 @@ i2c::_find( const std::string& s, int16_t a ) noexcept {
   assert( s.size());
   assert( a >= 0 );
   
-  myAddr = a;
-  myBus  = s;
-  myFD.reset();
+  myAddr  = a;
+  myBus   = s;
+  myAdapter.reset();
 
   bool retVal = false;
 
-  if( int tFD = -1; ( tFD = ::open( bus().c_str(), O_RDWR )) >= 0 ) {
-    
-    myFD = std::shared_ptr< int >
-      ( new int( tFD ),
-	[](int* f) {
-	  if( f ) {
-	    if( *f >= 0 )
-	      ::close( *f );
-	    delete f;
-	  }
-	});
-    assert( myFD.get());
+  if(( myAdapter = adapter_open( bus())).get()) {
     
-    // Set up the slave.
+    // Set up the slave. Nothing after this relies on the binding -
+    // messages are addressed - but it is how the kernel says whether
+    // the address is sane and not claimed by a kernel driver.
+
+    std::lock_guard< std::mutex > lck( myAdapter->lock );
     
-    if( int err; (err = ::ioctl( fd(), I2C_SLAVE, myAddr )) >= 0 )
+    if( myAdapter->bind( myAddr ))
       retVal = true;
     else 
       _LOG_WARN(( _id( "Unable to acquire bus and/or talk to slave" ),
-		  "err=", err, errno2str()));
+		  errno2str()));
+
+    myCombined = ( funcs() & I2C_FUNC_I2C ) ? true : false;
       
   }
 
@@ -278,9 +411,11 @@ i2c::_find( const std::string& s, int16_t a ) noexcept {
   
   if( retVal == false ) {
     
-    myAddr = -1;
+    myAddr     = -1;
+    myCombined = false;
+    mySMBus    = false;
     myBus.clear();
-    myFD.reset();
+    myAdapter.reset();
     
   }
   
@@ -295,11 +430,11 @@ i2c::operator==( const i2c& d ) const noexcept {
   
   if( addr() == d.addr()) {
     if( bus() == d.bus()) {
-      if( myFD ) {
-	if( d.myFD && ( *myFD == *d.myFD ))
+      if( myAdapter ) {
+	if( myAdapter == d.myAdapter )
 	  rVal = true;
       } else
-	if( ! d.myFD )
+	if( ! d.myAdapter )
 	  rVal = true;
     }
   }
@@ -319,7 +454,7 @@ void
 i2c::_check( void ) noexcept {
 
 #ifdef _DPG_DEBUG
-  assert( myFD.get() && ( fd() >= 0 ));
+  assert( myAdapter.get() && ( fd() >= 0 ));
   assert(( addr() >= 0 )  && ( addr() < 0x78 ));
   assert( bus().length());
 
@@ -338,32 +473,7 @@ i2c::_reset( void ) {
 size_t
 i2c::_write( const std::vector< uint8_t >& b ) const noexcept {
   
-  size_t rVal = 0;
-  
-  if( b.size()) {
-    
-    // Allocate memory to write out the vector's content
-    
-    std::unique_ptr< uint8_t, std::function< void( uint8_t* ) >>
-      tBuf((uint8_t*)::calloc( b.size() + 8, sizeof( uint8_t )),
-	   []( uint8_t* p ) {
-	     if( p )
-	       ::free( p );
-	   });
-    assert( tBuf.get());
-    
-    // copy the vector into memory. 
-    
-    for( size_t i = 0; i < b.size(); ++i )
-      tBuf.get()[i] = b[i];
-    
-    // Write the vector to the device.
-    
-    rVal = _write( tBuf.get(), b.size());
-    
-  }
-  
-  return rVal;  
+  return _write( b.data(), b.size());
 }
 
 
@@ -376,7 +486,31 @@ i2c::_write( const uint8_t* b, const size_t l ) const noexcept {
     
     assert( b );
     
-    ssize_t w_num = ::write( fd(), b, l );
+    ssize_t w_num = -1;
+
+    if( funcs() & I2C_FUNC_I2C ) {
+
+      // One addressed message.
+
+      struct i2c_msg msgs[] {
+	{ __u16( addr()), 0, __u16( l ), const_cast< uint8_t* >( b ) }
+      };
+
+      if( _xfer( msgs, 1 ) == 1 )
+	w_num = ssize_t( l );
+
+    } else
+      if( myAdapter.get()) {
+
+	std::lock_guard< std::mutex > lck( myAdapter->lock );
+
+	if( myAdapter->bind( addr())) {
+
+	  mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+	  w_num = myAdapter->write( b, l );
+
+	}
+      }
     
     if( w_num != ssize_t( l )) {
       
@@ -397,19 +531,11 @@ i2c::_write( const uint8_t* b, const size_t l ) const noexcept {
 size_t
 i2c::_read( std::vector< uint8_t >& b, const size_t l ) const noexcept {
   
-  // Allocate memory to fetch data from the device.
-  
-  std::unique_ptr< uint8_t, std::function< void( uint8_t* )>>
-    tBuf((uint8_t*)::calloc( l + 8, sizeof( uint8_t )),
-	 []( uint8_t* p ) {
-	   if( p )
-	     ::free( p );
-	 });
-  assert( tBuf.get());
+  // Read straight into the caller's vector.
   
-  // Read from the device.
+  b.resize( l );
   
-  return _read( tBuf.get(), l );
+  return _read( b.data(), l );
 }
 
 
@@ -422,7 +548,31 @@ i2c::_read( uint8_t* b, const size_t l ) const noexcept {
     
     assert( b );
     
-    ssize_t r_num = ::read( fd(), b, l );
+    ssize_t r_num = -1;
+
+    if( funcs() & I2C_FUNC_I2C ) {
+
+      // One addressed message.
+
+      struct i2c_msg msgs[] {
+	{ __u16( addr()), I2C_M_RD, __u16( l ), b }
+      };
+
+      if( _xfer( msgs, 1 ) == 1 )
+	r_num = ssize_t( l );
+
+    } else
+      if( myAdapter.get()) {
+
+	std::lock_guard< std::mutex > lck( myAdapter->lock );
+
+	if( myAdapter->bind( addr())) {
+
+	  mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+	  r_num = myAdapter->read( b, l );
+
+	}
+      }
     
     if( r_num != ssize_t( l )) {
       
@@ -439,51 +589,185 @@ i2c::_read( uint8_t* b, const size_t l ) const noexcept {
 }
 
 
+ssize_t
+i2c::_poll_read( uint8_t* b, const size_t l ) const noexcept {
+
+  assert( b && l );
+
+  ssize_t r_num = -1;
+
+  // The same two paths as _read() but without _xfer()'s complaint.
+
+  if( myAdapter.get()) {
+
+    if( funcs() & I2C_FUNC_I2C ) {
+
+      struct i2c_msg msgs[] {
+	{ __u16( addr()), I2C_M_RD, __u16( l ), b }
+      };
+      struct i2c_rdwr_ioctl_data data { msgs, 1 };
+
+      mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+
+      if( myAdapter->ioctl( I2C_RDWR, &data ) == 1 )
+	r_num = ssize_t( l );
+
+    } else {
+
+      std::lock_guard< std::mutex > lck( myAdapter->lock );
+
+      if( myAdapter->bind( addr())) {
+
+	mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+	r_num = myAdapter->read( b, l );
+
+      }
+    }
+  } else
+    errno = EBADF;
+
+  // Adapters differ in how they report an address NAK.
+
+  ssize_t rVal = r_num;
+
+  if( r_num != ssize_t( l )) {
+
+    if(( r_num < 0 ) &&
+       (( errno == EREMOTEIO ) || ( errno == ENXIO ) || ( errno == EIO )))
+      rVal = 0;
+    else {
+      _LOG_WARN(( _id( "Read failure" ), "r_num=", r_num, errno2str()));
+      rVal = -1;
+    }
+  }
+
+  _LOG_VERB(( _id(), " ret=", rVal ));
+
+  return rVal;
+}
+
+
+ssize_t
+i2c::_xfer( struct i2c_msg* msgs, const size_t n ) const noexcept {
+
+  assert( msgs && n );
+  assert( n <= I2C_RDWR_IOCTL_MAX_MSGS );
+
+  struct i2c_rdwr_ioctl_data data { msgs, __u32( n ) };
+
+  mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+
+  int r_num = -1;
+
+  if( myAdapter.get())
+    r_num = myAdapter->ioctl( I2C_RDWR, &data );
+  else
+    errno = EBADF;
+
+  if( r_num != int( n ))
+    _LOG_WARN(( _id( "Combined transaction failure" ),
+		"n=", n, ", r_num=", r_num, errno2str()));
+
+  _LOG_VERB(( _id(), "n=", n, " ret=", r_num ));
+
+  return ssize_t( r_num );
+}
+
+
+ssize_t
+i2c::_write_read( const uint8_t* w_buf, const size_t w_len,
+			uint8_t* r_buf, const size_t r_len ) const noexcept {
+
+  assert( w_buf && w_len );
+  assert( r_buf && r_len );
+
+  ssize_t rVal = -1;
+
+  if( combined()) {
+
+    // Write then read with a repeated start in between.
+
+    struct i2c_msg msgs[] {
+      { __u16( addr()), 0,
+	__u16( w_len ), const_cast< uint8_t* >( w_buf ) },
+      { __u16( addr()), I2C_M_RD,
+	__u16( r_len ), r_buf }
+    };
+
+    if( _xfer( msgs, 2 ) == 2 )
+      rVal = ssize_t( r_len );
+
+  } else {
+
+    // Two transactions with a STOP between them.
+
+    if( _write( w_buf, w_len ) == w_len )
+      if( _read( r_buf, r_len ) == r_len )
+	rVal = ssize_t( r_len );
+
+  }
+
+  _LOG_VERB(( _id(), "w: ", _vtoa( w_buf, w_len ),
+	      " ret=", rVal, " r: ", _vtoa( r_buf, r_len )));
+
+  return rVal;
+}
+
+
+bool
+i2c::combined( const bool c ) noexcept {
+
+  if( c && (( funcs() & I2C_FUNC_I2C ) == 0 ))
+    _LOG_WARN(( _id( "Adapter doesn't support combined transactions" )));
+  else
+    myCombined = c;
+
+  return combined();
+}
+
+
+bool
+i2c::smbus( const bool s ) noexcept {
+
+  constexpr unsigned long words =
+    I2C_FUNC_SMBUS_READ_WORD_DATA | I2C_FUNC_SMBUS_WRITE_WORD_DATA;
+
+  if( s && (( funcs() & words ) != words ))
+    _LOG_WARN(( _id( "Adapter doesn't support SMBus word data" )));
+  else
+    mySMBus = s;
+
+  return smbus();
+}
+
+
 ssize_t
 i2c::_read_reg(  const uint8_t reg,
 		 uint8_t* buf, size_t len ) const noexcept {
 
   assert( buf && len );
+  assert( len <= max_xfer_len );
 
   const uint8_t w_buf[] { reg };
+  uint8_t       r_buf[ max_xfer_len ];
 
-  std::unique_ptr< uint8_t, std::function< void( uint8_t* )>>
-    r_buf((uint8_t*)::calloc( len + 8, sizeof( uint8_t )),
-	  []( uint8_t* p ) {
-	    if( p )
-	      ::free( p );
-	  });
-  assert( r_buf.get());
-
-  ssize_t w_num = _write( w_buf, sizeof( w_buf ));
-  ssize_t r_num = _read( r_buf.get(), len );
+  ssize_t r_num = _write_read( w_buf, sizeof( w_buf ), r_buf, len );
 
-  _LOG_VERB(( _id(),
-              "w=", w_num, " ", _vtoa( w_buf, sizeof( w_buf )),
-              "r=", r_num, " ", _vtoa( r_buf.get(), len )));
-  
-  if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Unable to select register" ),
-                "w_num=", w_num, "val=", _vtoa( w_buf, sizeof( w_buf )),
-                errno2str()));
-    
-  } else
-    if( r_num != ssize_t( len )) {
+  if( r_num != ssize_t( len )) {
 
-      _LOG_WARN(( _id( "Unable to read register" ),
-                  "r_num=", r_num, errno2str()));
+    _LOG_WARN(( _id( "Unable to read register" ),
+		"reg=", t2hex( reg ), ", r_num=", r_num, errno2str()));
       
-    } else {
+  } else {
 
-      // Copy back the read data.
+    // Copy back the read data.
       
-      for( size_t i = 0; i < len; ++i )
-	buf[i] = r_buf.get()[i];
+    for( size_t i = 0; i < len; ++i )
+      buf[i] = r_buf[i];
       
-    }
+  }
 
-  return ssize_t( r_num );
+  return r_num;
 }
 
 
@@ -514,19 +798,757 @@ i2c::_write_reg( const uint8_t reg, const uint8_t* buf ) const noexcept {
 }
 
 
-const std::string
-i2c::_id( const char* m ) const noexcept {
-  
-  std::stringstream s;
-  
-  if( m )
-    s << m;
-  
-  s << " (bus=" << quote( bus()) << ", addr=0x" << t2hex( uint8_t( addr()))
-    << ", f=" << fd() << ") ";
-  
-  return s.str();
+ssize_t
+i2c::_write_reg( const uint8_t reg,
+		 const uint8_t* buf, size_t len ) const noexcept {
+
+  assert( buf && len );
+  assert( len <= max_xfer_len );
+
+  // Stage the register address and data on the stack so they go out
+  // in one write.
+
+  uint8_t w_buf[ 1 + max_xfer_len ];
+
+  w_buf[0] = reg;
+  for( size_t i = 0; i < len; ++i )
+    w_buf[ i + 1 ] = buf[i];
+
+  ssize_t w_num = _write( w_buf, len + 1 );
+  ssize_t rVal  = -1;
+
+  _LOG_VERB(( _id(), "w=", w_num, " ", _vtoa( w_buf, len + 1 )));
+
+  if( w_num != ssize_t( len + 1 )) {
+
+    _LOG_WARN(( _id( "Unable to write to register" ),
+		"w_num=", w_num, ", val=",
+		_vtoa( w_buf, len + 1 ), errno2str()));
+
+  } else 
+    rVal = w_num;
+
+  return rVal;
+}
+
+
+int
+i2c::_shadow_reg( const uint8_t w_reg, const int16_t r_reg,
+		  const uint8_t reset ) const noexcept {
+
+  int rVal = _shadow_find( w_reg );
+
+  if( rVal < 0 ) {
+
+    if( myShadowLen >= max_shadow ) {
+
+      _LOG_ERR(( _id( "Too many shadow registers" ), "reg=", t2hex( w_reg )));
+
+    } else {
+
+      // Write-only registers are known from the start - they're
+      // whatever reset left them as.
+
+      rVal = int( myShadowLen++ );
+      myShadow[ rVal ] = { w_reg, r_reg, reset, reset, r_reg < 0, false };
+
+    }
+  }
+
+  return rVal;
+}
+
+
+int
+i2c::_shadow_find( const uint8_t reg, const bool add ) const noexcept {
+
+  for( size_t i = 0; i < myShadowLen; ++i )
+    if(( myShadow[i].w_reg == reg ) || ( myShadow[i].r_reg == reg ))
+      return int( i );
+
+  return add ? _shadow_reg( reg, reg, 0x00 ) : -1;
+}
+
+
+int
+i2c::_shadow_get( const int r ) const noexcept {
+
+  if(( r < 0 ) || ( size_t( r ) >= myShadowLen ))
+    return -1;
+
+  shadow_reg& s = myShadow[r];
+
+  if( s.valid == false ) {
+
+    uint8_t r_buf[] { 0x00 };
+
+    if( _read_reg( uint8_t( s.r_reg ), r_buf ) != sizeof( r_buf ))
+      return -1;
+
+    s.val   = r_buf[0];
+    s.valid = true;
+
+  }
+
+  return s.val;
 }
 
-//  LocalWords:  Mutex mutex
+
+int
+i2c::_shadow_set( const int r, const uint8_t mask,
+		  const uint8_t bits ) const noexcept {
+
+  // Read-modify-write needs the register's other bits.
+
+  int rVal = _shadow_get( r );
+
+  if( rVal >= 0 ) {
+
+    shadow_reg&   s = myShadow[r];
+    const uint8_t v = uint8_t(( s.val & ~mask ) | ( bits & mask ));
+
+    if( v != s.val ) {
+      s.val   = v;
+      s.dirty = true;
+    }
+
+    if( s.dirty && ( myShadowPolicy == SHADOW::WRITE_THROUGH ))
+      if( _shadow_write( r ) < 0 )
+	return -1;
+
+    rVal = s.val;
+
+  }
+
+  return rVal;
+}
+
+
+int
+i2c::_shadow_write( const int r ) const noexcept {
+
+  shadow_reg& s = myShadow[r];
+
+  if( _write_reg( s.w_reg, &s.val ) != 2 )
+    return -1;
+
+  s.dirty = false;
+
+  // When debugging (-d), check the device took it.
+
+  if( _IS_LOG_DEBUG && ( s.r_reg >= 0 )) {
+
+    uint8_t r_buf[] { 0x00 };
+
+    if( _read_reg( uint8_t( s.r_reg ), r_buf ) != sizeof( r_buf ))
+      _LOG_WARN(( _id( "Unable to verify register" ),
+		  "reg=", t2hex( s.w_reg ), errno2str()));
+    else
+      if( r_buf[0] != s.val )
+	_LOG_WARN(( _id( "Register verify mismatch" ),
+		    "reg=", t2hex( s.w_reg ), ", wrote=", t2hex( s.val ),
+		    ", read=", t2hex( r_buf[0] )));
+
+  }
+
+  return 1;
+}
+
+
+void
+i2c::_shadow_reset( void ) const noexcept {
+
+  for( size_t i = 0; i < myShadowLen; ++i ) {
+
+    shadow_reg& s = myShadow[i];
+
+    s.val   = s.reset;
+    s.valid = true;
+    s.dirty = false;
+
+  }
+}
+
+
+void
+i2c::shadow_invalidate( void ) noexcept {
+
+  for( size_t i = 0; i < myShadowLen; ++i ) {
+
+    shadow_reg& s = myShadow[i];
+
+    if( s.r_reg >= 0 ) {
+      s.valid = false;
+      s.dirty = false;
+    } else
+      s.dirty = true;
+
+  }
+}
+
+
+i2c::SHADOW
+i2c::shadow( const SHADOW p ) noexcept {
+
+  myShadowPolicy = p;
+
+  if( p == SHADOW::WRITE_THROUGH )
+    (void)flush();
+
+  return shadow();
+}
+
+
+int
+i2c::flush( void ) const noexcept {
+
+  int rVal = 0;
+
+  for( size_t i = 0; i < myShadowLen; ++i )
+    if( myShadow[i].dirty ) {
+
+      if( _shadow_write( int( i )) < 0 ) {
+
+	_LOG_WARN(( _id( "Unable to flush register" ),
+		    "reg=", t2hex( myShadow[i].w_reg ), errno2str()));
+	rVal = -1;
+
+      } else
+	if( rVal >= 0 )
+	  ++rVal;
+
+    }
+
+  return rVal;
+}
+
+
+ssize_t
+i2c::_read_word( const uint8_t reg, uint16_t& w,
+		 const bool msb_first ) const noexcept {
+
+  ssize_t rVal = -1;
+
+  if( smbus()) {
+
+    union i2c_smbus_data        d;
+    struct i2c_smbus_ioctl_data data {
+      I2C_SMBUS_READ, reg, I2C_SMBUS_WORD_DATA, &d
+    };
+
+    if( myAdapter.get()) {
+
+      std::lock_guard< std::mutex > lck( myAdapter->lock );
+
+      if( myAdapter->bind( addr())) {
+
+	mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+
+	if( myAdapter->ioctl( I2C_SMBUS, &data ) >= 0 ) {
+
+	  // The first byte on the wire is the word's low byte.
+
+	  w    = msb_first ? uint16_t(( d.word >> 8 ) | ( d.word << 8 )) : d.word;
+	  rVal = sizeof( w );
+
+	}
+      }
+    }
+
+    if( rVal < 0 )
+      _LOG_WARN(( _id( "Unable to read word register" ),
+		  "reg=", t2hex( reg ), errno2str()));
+
+  } else {
+
+    uint8_t r_buf[] { 0x00, 0x00 };
+
+    rVal = _read_reg( reg, r_buf, sizeof( r_buf ));
+
+    if( rVal == sizeof( r_buf ))
+      w = msb_first ? uint16_t(( r_buf[0] << 8 ) | r_buf[1] )
+		    : uint16_t(( r_buf[1] << 8 ) | r_buf[0] );
+
+  }
+
+  _LOG_VERB(( _id(), "reg=", t2hex( reg ), " ret=", rVal, " w=", w ));
+
+  return rVal;
+}
+
+
+ssize_t
+i2c::_write_word( const uint8_t reg, const uint16_t w,
+		  const bool msb_first ) const noexcept {
+
+  ssize_t rVal = -1;
+
+  if( smbus()) {
+
+    union i2c_smbus_data        d;
+    struct i2c_smbus_ioctl_data data {
+      I2C_SMBUS_WRITE, reg, I2C_SMBUS_WORD_DATA, &d
+    };
+
+    d.word = msb_first ? uint16_t(( w >> 8 ) | ( w << 8 )) : w;
+
+    if( myAdapter.get()) {
+
+      std::lock_guard< std::mutex > lck( myAdapter->lock );
+
+      if( myAdapter->bind( addr())) {
+
+	mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+
+	if( myAdapter->ioctl( I2C_SMBUS, &data ) >= 0 )
+	  rVal = 1 + sizeof( w );
+
+      }
+    }
+
+    if( rVal < 0 )
+      _LOG_WARN(( _id( "Unable to write word register" ),
+		  "reg=", t2hex( reg ), ", w=", w, errno2str()));
+
+  } else {
+
+    const uint8_t w_buf[] {
+      uint8_t( msb_first ? ( w >> 8 ) : ( w & 0xff )),
+      uint8_t( msb_first ? ( w & 0xff ) : ( w >> 8 ))
+    };
+
+    rVal = _write_reg( reg, w_buf, sizeof( w_buf ));
+
+  }
+
+  _LOG_VERB(( _id(), "reg=", t2hex( reg ), " ret=", rVal, " w=", w ));
+
+  return rVal;
+}
+
+
+const std::string
+i2c::_id( const char* m ) const noexcept {
+  
+  std::stringstream s;
+  
+  if( m )
+    s << m;
+  
+  s << " (bus=" << quote( bus()) << ", addr=0x" << t2hex( uint8_t( addr()))
+    << ", f=" << fd() << ") ";
+  
+  return s.str();
+}
+
+
+std::shared_ptr< i2c_transport >
+i2c::transport( void ) noexcept {
+
+  std::lock_guard< std::mutex > lck( adapters_lock );
+
+  return xport;
+}
+
+
+void
+i2c::transport( std::shared_ptr< i2c_transport > t ) noexcept {
+
+  assert( t.get());
+
+  std::lock_guard< std::mutex > lck( adapters_lock );
+
+  xport = t;
+}
+
+
+bool
+i2c::_probe( i2c_adapter& a, const int16_t addr ) noexcept {
+
+  std::lock_guard< std::mutex > lck( a.lock );
+
+  bool rVal = false;
+
+  // Like i2cdetect, a read rather than a quick write for the EEPROM
+  // ranges because a quick write can corrupt some EEPROMs. Nearly
+  // everything else, including write-only parts, ACKs a quick write.
+
+  const bool eeprom = (( addr >= 0x30 ) && ( addr <= 0x37 )) ||
+		      (( addr >= 0x50 ) && ( addr <= 0x5f ));
+
+  if(( eeprom == false ) && ( a.funcs & I2C_FUNC_SMBUS_QUICK )) {
+
+    if( a.bind( addr, false )) {
+
+      struct i2c_smbus_ioctl_data data {
+	I2C_SMBUS_WRITE, 0, I2C_SMBUS_QUICK, nullptr
+      };
+
+      mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+      rVal = a.ioctl( I2C_SMBUS, &data ) >= 0;
+
+    }
+
+  } else
+    if( a.funcs & I2C_FUNC_I2C ) {
+
+      uint8_t        r_buf[] { 0x00 };
+      struct i2c_msg msgs[] {
+	{ __u16( addr ), I2C_M_RD, sizeof( r_buf ), r_buf }
+      };
+      struct i2c_rdwr_ioctl_data data { msgs, 1 };
+
+      mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+      rVal = a.ioctl( I2C_RDWR, &data ) == 1;
+
+    } else
+      if( a.bind( addr, false )) {
+
+	uint8_t r_buf[] { 0x00 };
+
+	mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+	rVal = a.read( r_buf, sizeof( r_buf )) == sizeof( r_buf );
+
+      }
+
+  return rVal;
+}
+
+
+bool
+i2c::_read_cache( const std::string& cache,
+		  const std::vector< std::shared_ptr< i2c_adapter >>& adps,
+		  std::vector< std::vector< int16_t >>& found ) noexcept {
+
+  // The cache is a line per adapter, in adapter order:
+  //
+  //   bus funcs addr addr ...
+
+  std::ifstream ifs( cache );
+  std::string   line;
+  size_t        i    = 0;
+  bool          rVal = ifs.good();
+
+  found.assign( adps.size(), std::vector< int16_t >());
+
+  while( rVal && std::getline( ifs, line )) {
+
+    std::istringstream ss( line );
+    std::string        b;
+    unsigned long      f = 0;
+    int                ad;
+
+    ss >> b >> std::hex >> f >> std::dec;
+
+    // Same adapter, in the same place, doing the same things?
+
+    if(( i >= adps.size()) || ( b != adps[i]->bus ) || ( f != adps[i]->funcs ))
+      rVal = false;
+    else {
+
+      // Are the devices still there?
+
+      while( rVal && ( ss >> ad ))
+	if( _probe( *adps[i], int16_t( ad )))
+	  found[i].push_back( int16_t( ad ));
+	else
+	  rVal = false;
+
+      ++i;
+
+    }
+  }
+
+  if( i != adps.size())
+    rVal = false;
+
+  if( rVal == false )
+    _LOG_VERB(( "Discovery cache ", quote( cache ), " is stale or missing" ));
+
+  return rVal;
+}
+
+
+size_t
+i2c::discover( const std::string& cache ) noexcept {
+
+  const auto start = std::chrono::steady_clock::now();
+
+  // Which adapters exist. Opening them also fetches what they can
+  // do.
+
+  std::vector< std::shared_ptr< i2c_adapter >> adps;
+
+  for( u_int adapter = 0; adapter < 10; ++adapter ) {
+
+    std::stringstream ss;
+
+    ss << i2c_fname << adapter;
+
+    if( transport()->exists( ss.str()))
+      if( std::shared_ptr< i2c_adapter > a = adapter_open( ss.str()); a.get())
+	adps.push_back( a );
+
+  }
+
+  // The addresses answering on each adapter.
+
+  std::vector< std::vector< int16_t >> found;
+
+  const bool cached = _read_cache( cache, adps, found );
+
+  if( cached == false ) {
+
+    // Probe the adapters in parallel. Each has its own thread and
+    // its own result vector.
+
+    std::vector< std::thread > threads;
+
+    found.assign( adps.size(), std::vector< int16_t >());
+
+    for( size_t i = 0; i < adps.size(); ++i )
+      threads.emplace_back( [&adps,&found,i]( void ) {
+	  for( int16_t a = probe_first; a <= probe_last; ++a )
+	    if( _probe( *adps[i], a ))
+	      found[i].push_back( a );
+	});
+
+    for( auto& t : threads )
+      t.join();
+
+    // Remember for next time, unless there is no cache.
+
+    std::ofstream ofs;
+
+    if( cache.length())
+      ofs.open( cache, std::ofstream::out | std::ofstream::trunc );
+
+    for( size_t i = 0; ofs.good() && ( i < adps.size()); ++i ) {
+
+      ofs << adps[i]->bus << " " << std::hex << adps[i]->funcs << std::dec;
+      for( const auto a : found[i] )
+	ofs << " " << a;
+      ofs << std::endl;
+
+    }
+
+    if( cache.length() && ( ofs.good() == false ))
+      _LOG_INFO(( "Unable to write discovery cache ", quote( cache )));
+
+  }
+
+  // Map addresses to buses, lowest numbered adapter first.
+
+  std::lock_guard< std::mutex > lck( discovered_lock );
+
+  discovered.clear();
+
+  for( size_t i = 0; i < adps.size(); ++i )
+    for( const auto a : found[i] )
+      discovered.emplace( a, adps[i]->bus );
+
+  for( const auto& [a,b] : discovered )
+    _LOG_VERB(( "addr=0x", t2hex( uint8_t( a )), " bus=", quote( b )));
+
+  _LOG_INFO(( "Discovered ", discovered.size(), " devices on ",
+	      adps.size(), " adapters in ",
+	      std::chrono::duration_cast< std::chrono::milliseconds >
+	      ( std::chrono::steady_clock::now() - start ).count(), "ms",
+	      cached ? " (cached)" : "" ));
+
+  return discovered.size();
+}
+
+
+i2c_batch::i2c_batch( void )
+  : myXfers( 0 ), mySplit( true ) {
+
+}
+
+i2c_batch::i2c_batch( const size_t n )
+  : myXfers( 0 ), mySplit( true ) {
+
+  myMsgs.reserve( n );
+  myData.reserve( n * ( i2c::max_xfer_len + 1 ));
+
+}
+
+
+void
+i2c_batch::clear( void ) noexcept {
+
+  myMsgs.clear();
+  myData.clear();
+  myXfers = 0;
+
+}
+
+
+ssize_t
+i2c_batch::_queue( const i2c& d, const uint16_t flags,
+		   uint8_t* buf, const size_t off, const size_t len ) noexcept {
+
+  assert( len && ( len <= 0xffff ));
+
+  ssize_t rVal = -1;
+
+  // Every message of a batch goes down the same file descriptor and
+  // therefore MUST be on the same adapter.
+
+  if( d.fd() < 0 ) {
+
+    _LOG_WARN(( d._id( "Batched device isn't open" )));
+
+  } else
+    if( myMsgs.size() && ( myMsgs.front().dev->myAdapter != d.myAdapter )) {
+
+      _LOG_WARN(( d._id( "Batched device on a different bus" ),
+		  "batch bus=", quote( myMsgs.front().dev->bus())));
+
+    } else {
+
+      rVal = ssize_t( myMsgs.size());
+      myMsgs.push_back( { &d, flags, uint16_t( len ), buf, off, pending });
+
+    }
+
+  return rVal;
+}
+
+
+ssize_t
+i2c_batch::write( const i2c& d,
+		  const uint8_t* buf, const size_t len ) noexcept {
+
+  assert( buf );
+
+  return _queue( d, 0, const_cast< uint8_t* >( buf ), 0, len );
+}
+
+
+ssize_t
+i2c_batch::write_reg( const i2c& d, const uint8_t reg,
+		      const uint8_t* buf, const size_t len ) noexcept {
+
+  assert( buf || ( len == 0 ));
+
+  // Copy the register address and data into the batch.
+
+  const size_t off = myData.size();
+
+  myData.push_back( reg );
+  myData.insert( myData.end(), buf, buf + len );
+
+  ssize_t rVal = _queue( d, 0, nullptr, off, len + 1 );
+
+  if( rVal < 0 )
+    myData.resize( off );
+
+  return rVal;
+}
+
+
+ssize_t
+i2c_batch::read( const i2c& d, uint8_t* buf, const size_t len ) noexcept {
+
+  assert( buf );
+
+  return _queue( d, I2C_M_RD, buf, 0, len );
+}
+
+
+void
+i2c_batch::_xfer( const size_t b, const size_t e ) noexcept {
+
+  assert(( b < e ) && ( e <= myMsgs.size()));
+  assert(( e - b ) <= max_msgs );
+
+  const i2c& d = *myMsgs[b].dev;
+
+  ++myXfers;
+
+  if( d.funcs() & I2C_FUNC_I2C ) {
+
+    struct i2c_msg msgs[ max_msgs ];
+
+    for( size_t i = b; i < e; ++i ) {
+
+      const msg& m = myMsgs[i];
+
+      msgs[ i - b ] = { __u16( m.dev->addr()), m.flags, m.len,
+			m.buf ? m.buf : myData.data() + m.off };
+
+    }
+
+    struct i2c_rdwr_ioctl_data data { msgs, __u32( e - b ) };
+
+    i2c::mySyscalls.fetch_add( 1, std::memory_order_relaxed );
+
+    const int r_num  = d.myAdapter->ioctl( I2C_RDWR, &data );
+    const int status = ( r_num == int( e - b )) ? 0 : -( errno ? errno : EIO );
+
+    if( status )
+      _LOG_WARN(( d._id( "Batched transaction failure" ),
+		  "msgs=", b, "..", e - 1, ", r_num=", r_num, errno2str()));
+
+    for( size_t i = b; i < e; ++i )
+      myMsgs[i].status = status;
+
+  } else {
+
+    // Plain i2c transfers aren't supported so each message goes out
+    // on its own through its device.
+
+    myXfers += ( e - b ) - 1;
+
+    for( size_t i = b; i < e; ++i ) {
+
+      msg&     m   = myMsgs[i];
+      uint8_t* buf = m.buf ? m.buf : myData.data() + m.off;
+      size_t   num = ( m.flags & I2C_M_RD )
+	? m.dev->_read( buf, m.len ) : m.dev->_write( buf, m.len );
+
+      m.status = ( num == m.len ) ? 0 : -( errno ? errno : EIO );
+
+    }
+  }
+}
+
+
+ssize_t
+i2c_batch::submit( void ) noexcept {
+
+  ssize_t rVal = 0;
+
+  myXfers = 0;
+
+  for( auto& m : myMsgs )
+    m.status = pending;
+
+  // Carve the batch into transfers at the kernel's message limit and,
+  // if asked, after each read.
+
+  for( size_t b = 0, e = 0; b < myMsgs.size(); b = e ) {
+
+    for( e = b; ( e < myMsgs.size()) && (( e - b ) < max_msgs ); ) 
+      if(( myMsgs[ e++ ].flags & I2C_M_RD ) && mySplit )
+	break;
+
+    errno = 0;
+    _xfer( b, e );
+
+  }
+
+  for( const auto& m : myMsgs )
+    if( m.status == 0 )
+      ++rVal;
+
+  _LOG_VERB(( "batch msgs=", myMsgs.size(), " xfers=", myXfers,
+	      " ok=", rVal ));
+
+  return rVal;
+}
+
+
+//  LocalWords:  Mutex mutex RDWR errno
   
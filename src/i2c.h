@@ -99,6 +99,8 @@ extern "C" {
   
 }
 
+#include <array>
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <map>
@@ -110,26 +112,97 @@ extern "C" {
 #include <vector>
 
 #include "log.h"
+#include "transport.h"
 #include "util.h"
 
 
 #define _I2C_H_ID "$Id: i2c.h,v 1.16 2019/10/22 05:47:21 root Exp $"
 
 
+class i2c_batch;
+
+
+// An open adapter (i.e., /dev/i2c-N). Every device on an adapter
+// shares one of these, and therefore one file descriptor, through a
+// registry in i2c.cc: the first device on a bus opens it and the
+// adapter is closed when the last device lets go.
+//
+// Messages are addressed per message through I2C_RDWR so nothing is
+// bound to the descriptor. Adapters that can't do plain i2c
+// transfers fall back to read()/write(), which need the descriptor
+// bound to the device's address with I2C_SLAVE. The bound address is
+// cached so the ioctl is only made when the device changes, and the
+// lock keeps the bind and the transfer together.
+
+struct i2c_adapter {
+
+  std::string                      bus;
+  std::shared_ptr< i2c_transport > xport;
+  int                              fd;
+  unsigned long                    funcs;
+  int16_t                          bound;
+  std::mutex                       lock;
+
+  i2c_adapter( const std::string& b, std::shared_ptr< i2c_transport > x,
+	       const int f, const unsigned long fn )
+    : bus( b ), xport( x ), fd( f ), funcs( fn ), bound( -1 ) {}
+  ~i2c_adapter( void );
+
+  // The adapter's descriptor on its transport.
+
+  int     ioctl( const unsigned long req, void* arg ) noexcept {
+    return xport->ioctl( fd, req, arg );
+  }
+  ssize_t read(  void* buf, const size_t len ) noexcept {
+    return xport->read( fd, buf, len );
+  }
+  ssize_t write( const void* buf, const size_t len ) noexcept {
+    return xport->write( fd, buf, len );
+  }
+
+  i2c_adapter( const i2c_adapter&  a ) = delete;
+  i2c_adapter( const i2c_adapter&& a ) = delete;
+
+  i2c_adapter& operator=( const i2c_adapter&  a ) = delete;
+  i2c_adapter& operator=( const i2c_adapter&& a ) = delete;
+
+  // Bind the descriptor to an address, if not already. The caller
+  // MUST hold the lock. Probing addresses that may be claimed by a
+  // kernel driver is expected to fail, so failure can be quiet.
+
+  bool bind( const int16_t addr, const bool warn = true ) noexcept;
+
+};
+
+
 // This class is a base class for i2c devices that describes a few
 // basic but critical functions.
 
 class i2c {
 
+  // Batches queue messages against a device's address and adapter
+  // and, when the adapter can't do combined transactions, fall back
+  // to the device's own _read()/_write(). Adapters count their
+  // I2C_SLAVE ioctls as syscalls.
+
+  friend class  i2c_batch;
+  friend struct i2c_adapter;
+
+public:
+
+  // The shadow register policies. See shadow() below.
+
+  enum class SHADOW : int { WRITE_THROUGH = 1, DEFERRED };
+
 private:
   
 protected:
   
-  // The file descriptor to the bus is shared and closed when the
-  // final instance is destroyed. The use of a shared pointer negates
-  // the use of const copy operations.
+  // The adapter (and its file descriptor) is shared by all devices
+  // on the bus and closed when the final instance is destroyed. The
+  // use of a shared pointer negates the use of const copy operations.
     
-  std::shared_ptr< int > myFD;
+  std::shared_ptr< i2c_adapter > myAdapter;
     
   // The address of the devce on the bus and the bus. The address is
   // signed such that a negative number might indicate an error. The
@@ -137,6 +210,39 @@ protected:
   
   int16_t     myAddr;
   std::string myBus;
+
+  // Whether combined (I2C_RDWR) transactions are used when the
+  // adapter supports them.
+
+  bool myCombined;
+
+  // Whether 16-bit register reads and writes use SMBus word data
+  // transfers (I2C_SMBUS) rather than the plain i2c paths above.
+
+  bool mySMBus;
+
+  // A shadow of the device's 8-bit configuration registers, so
+  // changing a field is a write (or nothing) rather than a read,
+  // modify, write, and verifying read. A register is written with one
+  // address (or command) and read with another, or is write-only
+  // (r_reg < 0) in which case its value after reset is what the
+  // shadow starts with. Readable registers are read the first time
+  // they're needed.
+
+  inline static constexpr size_t max_shadow = 8;
+
+  struct shadow_reg {
+    uint8_t w_reg;
+    int16_t r_reg;
+    uint8_t reset;
+    uint8_t val;
+    bool    valid;  // val is known
+    bool    dirty;  // val is not yet on the device
+  };
+
+  mutable std::array< shadow_reg, max_shadow > myShadow;
+  mutable size_t                               myShadowLen;
+  SHADOW                                       myShadowPolicy;
   
   // _doInit() is explicitly called in constructors but whether the
   // device is already initialized or needs to be initialized is
@@ -177,8 +283,19 @@ protected:
 
   virtual void _check( void ) noexcept;
   
+  // The largest register transfer (not counting the register
+  // address) the utility routines below stage on the stack. Nothing
+  // on the register I/O path touches the heap, which matters because
+  // the samplers run several transactions per channel per second.
+
+  inline static constexpr size_t max_xfer_len = 32;
+
   // Write length bytes out to the device or read length bytes from
   // device. Return the number of bytes read or written.
+  //
+  // The vector forms use the caller's vector as the buffer. _read()
+  // resizes the vector to the length, which only allocates when the
+  // vector's capacity is too small - reserve() it once up front.
     
   size_t _write( const uint8_t* b, const size_t l ) const noexcept;
   size_t _write( const std::vector< uint8_t >& b  ) const noexcept;
@@ -186,6 +303,32 @@ protected:
   size_t _read( uint8_t* b, const size_t l                ) const noexcept;
   size_t _read( std::vector< uint8_t >& b, const size_t l ) const noexcept;
 
+  // A _read() of a device that NAKs its address while it is busy
+  // (e.g., a no hold master conversion). A NAK isn't an error so it
+  // isn't logged. Returns the length on success, 0 when NAKed, and
+  // a negative number on any other error.
+
+  ssize_t _poll_read( uint8_t* b, const size_t l ) const noexcept;
+
+  // Count a read that failed the device's checksum. See crc_errors().
+
+  void _crc_failed( void ) const noexcept;
+
+  // Combined transactions. The messages are sent as a single
+  // transaction, joined by repeated starts rather than STOPs, in a
+  // single ioctl( I2C_RDWR ). _xfer() returns the number of messages
+  // transferred or a negative number on error.
+  //
+  // _write_read() writes w_len bytes, typically a register address or
+  // command, then reads r_len bytes and returns the number of bytes
+  // read. When combined transactions are unavailable or turned off it
+  // falls back to a _write() then a _read().
+
+  ssize_t _xfer( struct i2c_msg* msgs, const size_t n ) const noexcept;
+
+  ssize_t _write_read( const uint8_t* w_buf, const size_t w_len,
+			     uint8_t* r_buf, const size_t r_len ) const noexcept;
+
   // Utility implementations of _read()/_write() that read and write
   // an 8-bit value to a register. These are fairly common, simple
   // functions.
@@ -200,11 +343,64 @@ protected:
   ssize_t _read_reg(  const uint8_t reg,       uint8_t* buf ) const noexcept;
   ssize_t _write_reg( const uint8_t reg, const uint8_t* buf ) const noexcept;
 
-  // A general form of _read_reg() except the return value isn't one
-  // 8-bit register but some length of bytes.
+  // General forms of _read_reg() and _write_reg() except the value
+  // isn't one 8-bit register but some length of bytes, no more than
+  // max_xfer_len. _write_reg() returns the number of bytes written,
+  // including the register address.
   
   ssize_t _read_reg(  const uint8_t reg,
 		      uint8_t* buf, size_t len ) const noexcept;
+  ssize_t _write_reg( const uint8_t reg,
+		      const uint8_t* buf, size_t len ) const noexcept;
+
+  // The shadow registers.
+  //
+  // _shadow_reg():   Declare a register and return its index, which
+  //                  the other routines take. Subclasses declare
+  //                  their registers in _doInit().
+  // _shadow_find():  The index of the register written or read at
+  //                  reg, declaring it (readable at reg) if add is
+  //                  set and it isn't already. -1 if not found.
+  // _shadow_get():   The register's value, read from the device only
+  //                  when the shadow doesn't know it. Negative on
+  //                  error.
+  // _shadow_set():   Replace the bits under mask. Written at once
+  //                  when the policy is write-through and the value
+  //                  changed, otherwise left dirty for flush().
+  //                  Returns the new value or a negative number on
+  //                  error.
+  // _shadow_reset(): The device was reset, so the shadow is too.
+  //
+  // When logging at debug level (-d) writes to readable registers
+  // are read back and compared.
+
+  int _shadow_reg(   const uint8_t w_reg, const int16_t r_reg,
+		     const uint8_t reset ) const noexcept;
+  int _shadow_find(  const uint8_t reg, const bool add = false ) const noexcept;
+  int _shadow_get(   const int r ) const noexcept;
+  int _shadow_set(   const int r, const uint8_t mask,
+		     const uint8_t bits ) const noexcept;
+  int _shadow_write( const int r ) const noexcept;
+
+  void _shadow_reset( void ) const noexcept;
+
+  // Read and write a 16-bit register. These go through SMBus read
+  // and write word data when smbus() is on and otherwise through
+  // _read_reg() and _write_reg(), so they follow combined().
+  //
+  // SMBus sends a word LSB first. Devices sending their registers
+  // MSB first (e.g., the ADS1015) pass msb_first so the value is
+  // the register's value whichever way it travelled.
+  //
+  // _read_word():  Returns the number of bytes read, which should
+  //                always be 2.
+  // _write_word(): Returns the number of bytes written, including
+  //                the register address, which should always be 3.
+
+  ssize_t _read_word(  const uint8_t reg, uint16_t& w,
+		       const bool msb_first = true ) const noexcept;
+  ssize_t _write_word( const uint8_t reg, const uint16_t w,
+		       const bool msb_first = true ) const noexcept;
 
   // This is a silly little routine used in debug statements and
   // exists to reduce typing errors.
@@ -217,74 +413,55 @@ protected:
   // partitioned registers, specialization SHOULD be implemented in
   // subclasses.
   //
-  // These templates work off a map where the key is an enumeration
-  // holding two predefined values in addition to specific
-  // enumeration/bit maps. The enumeration and maps look like:
+  // These templates work off a field (templates.h) whose key is an
+  // enumeration holding _NONE in addition to the specific values.
+  // The enumeration and field look like:
   //
   // enum class FILTER_x : int {
   //   _NONE = -1, _MASK = -2,
-  //   OFF = 1, x2, x4, x8
-  // }
-  // static const std::map< FILTER_x, uint8_t > FILTER_MAP {
-  //   { FILTER_x::OFF,   0b00000000 },
-  //   { FILTER_x::x2,    0b00000100 },
-  //   { FILTER_x::x4,    0b00001000 },
-  //   { FILTER_x::x8,    0b00001100 },
-  //   { FILTER_x::x16,   0b00010000 },
-  //   { FILTER_x::_MASK, 0b00011100 }
+  //   OFF = 1, x2, x4, x8, x16
   // }
+  // inline static constexpr field< FILTER_x, uint8_t, 2, 3 > FILTER_FIELD {{
+  //   { FILTER_x::OFF,   0b000 },
+  //   { FILTER_x::x2,    0b001 },
+  //   { FILTER_x::x4,    0b010 },
+  //   { FILTER_x::x8,    0b011 },
+  //   { FILTER_x::x16,   0b100 }
+  // }}
   //
-  // The enumeration maps to a register bit map where the enumeration
+  // The enumeration maps to a register bit field where the enumeration
   // is used throughout the code rather than more numerous, and
   // therefore error prone, bit masking against bit sequences.
+  //
+  // The register goes through the shadow, declared readable and
+  // writable at reg unless the subclass declared it otherwise, so a
+  // read is only from the shadow once the register is known and a
+  // write is one write (or none).
   
-  template< typename K, typename V >
+  template< typename F >
   inline
-  K _read_map_8bit( const uint8_t           reg,
-		    const std::map< K, V >&   m ) const noexcept {
+  typename F::key_type _read_map_8bit( const uint8_t reg,
+				       const F&      f ) const noexcept {
 
-    static_assert( sizeof( V ) == sizeof( uint8_t ));
-    
-    // The map size MUST always be greater than zero (i.e., there MUST
-    // be something to map).
-  
-    assert( m.size());
+    static_assert( sizeof( typename F::value_type ) == sizeof( uint8_t ));
     
     // The default (failure) return type.
     
-    K e_type = K::_NONE;
-
-    // Returned register value from the device.
-    
-    V regVal;
+    typename F::key_type e_type = F::key_type::_NONE;
 
-    static_assert( sizeof( regVal ) == sizeof( uint8_t ));
+    // The register's content.
     
-    // Fetch the device register's content.
-    
-    if( _read_reg( reg, &regVal, sizeof( regVal )) == sizeof( regVal )) {
-
-      // Cache the bit mask.
-
-      const V mask = m.at( K::_MASK );
+    const int regVal = _shadow_get( _shadow_find( reg, true ));
 
-      // Find something (other than NONE and MASK) that matches the
-      // bits.
+    if( regVal >= 0 )
+      e_type = f.decode( uint8_t( regVal ));
     
-      for( const auto& [key,val] : m )
-        if(( key != K::_NONE ) && ( key != K::_MASK ))
-          if(( regVal & mask ) == val ) {
-            e_type = key;
-            break;
-          }
-    } 
-    
-    // "NONE" indicates whatever was sought isn't in the map and
+    // "NONE" indicates whatever was sought isn't in the field and
     // therefore is a failure condition, since functions are strongly
     // typed, it's a private enumeration, and shouldn't be a possible
     // value.
     
-    assert( e_type != K::_NONE );
+    assert( e_type != F::key_type::_NONE );
     
     return e_type;
   }
@@ -293,107 +470,64 @@ protected:
   //
   // Note: Errors are effectivly ignored.
   
-  template< typename K, typename V >
+  template< typename F >
   inline
-  K _write_map_8bit( const uint8_t           reg,
-		     const K                   k,
-		     const std::map< K, V >&   m ) const noexcept {
-
-    static_assert( sizeof( V ) == sizeof( uint8_t ));
-
-    // Read the current register value.
-
-    V       buf[] { 0x00 };
-    ssize_t r_num = _read_reg( reg, buf );
-
-    if( r_num == sizeof( buf )) {
-
-      // Set/clear bits.
-      
-      buf[0] &= ~m.at( K::_MASK );
-      buf[0] |=  m.at( k );
-
-      // Write it to the device.
-      
-      ssize_t w_num = _write_reg( reg, buf );
-      
-      if( w_num != ( sizeof( buf ) + 1 ))
-        _LOG_ERR(( _id( "Register write error" ),
-                   "w_num=", w_num, " w=", _vtoa( buf, sizeof( buf )),
-                   errno2str()));
-      
-    } else
-      _LOG_ERR(( _id( "Register read error" ),
-                 "r_num=", r_num, " r=", _vtoa( buf, sizeof( buf )),
-                 errno2str()));
+  typename F::key_type _write_map_8bit( const uint8_t               reg,
+					const typename F::key_type  k,
+					const F&                    f ) const noexcept {
+
+    static_assert( sizeof( typename F::value_type ) == sizeof( uint8_t ));
+
+    // Set/clear bits.
+
+    if( _shadow_set( _shadow_find( reg, true ), f.mask, f.encode( k )) < 0 )
+      _LOG_ERR(( _id( "Register write error" ), "reg=", t2hex( reg ),
+		 errno2str()));
     
-    return _read_map_8bit< K, V >( reg, m );
+    return _read_map_8bit( reg, f );
   }
 
   // These templates are very similar to the read/write map templates
-  // except they work off a boolean setting.
-  //
-  // The problems with the prior templates include:
-  //  1, The mask could be against a multi-bit field, and
-  //  2, The way the _check() and other routines are written assume a
-  //     zero field is a mapped value rather than one or more boolean
-  //     values. Also, they have an assumption that a value within a
-  //     field are unique values rather than a combination of values.
+  // except they work off a boolean setting, the field's bits for
+  // bitKey being set or not.
   //
   // Note: Errors are effectivly ignored.
   
-  template< typename K, typename V >
+  template< typename F >
   inline
-  bool _read_bit_8bit( const uint8_t            reg,
-		       const K&                 bitKey,
-		       const std::map< K, V >&  m ) const noexcept {
+  bool _read_bit_8bit( const uint8_t               reg,
+		       const typename F::key_type& bitKey,
+		       const F&                    f ) const noexcept {
 
-    static_assert( sizeof( V ) == sizeof( uint8_t ));
+    static_assert( sizeof( typename F::value_type ) == sizeof( uint8_t ));
 
-    bool rVal = false;
-    V    r_buf[] { 0x00 };
+    bool      rVal   = false;
+    const int regVal = _shadow_get( _shadow_find( reg, true ));
     
-    if( _read_reg( reg, r_buf ) == sizeof( r_buf )) 
-      if( r_buf[0] &  m.at( bitKey ))
+    if( regVal >= 0 ) 
+      if( regVal & f.encode( bitKey ))
         rVal = true;
     
     return rVal;
   }
 
-  template< typename K, typename V >
+  template< typename F >
   inline
-  bool _write_bit_8bit( const uint8_t            reg,
-			const K&                 bitKey,
-			const bool               setting,
-			const std::map< K, V >&  m ) const noexcept {
-
-    static_assert( sizeof( V ) == sizeof( uint8_t ));
-    
-    V r_buf[] { 0x00 };
-
-    if( _read_reg( reg, r_buf ) == sizeof( r_buf )) {
+  bool _write_bit_8bit( const uint8_t               reg,
+			const typename F::key_type& bitKey,
+			const bool                  setting,
+			const F&                    f ) const noexcept {
 
-      // Set/clear the bit(s).
-      
-      r_buf[0] &= ~m.at( bitKey );
-      if( setting )
-        r_buf[0] |= m.at( bitKey );
+    static_assert( sizeof( typename F::value_type ) == sizeof( uint8_t ));
 
-      // Write it back to the device.
-      
-      ssize_t w_num = _write_reg( reg, r_buf );
+    // Set/clear the bit(s).
 
-      if( w_num != ( sizeof( r_buf ) + 1 ))
-        _LOG_ERR(( _id( "Register write error" ),
-                   "w_num=", w_num, " w=", _vtoa( r_buf, sizeof( r_buf )),
-                   errno2str()));
-
-    } else
-      _LOG_ERR(( _id( "Register read error" ),
-                 " r=", _vtoa( r_buf, sizeof( r_buf )),
-                 errno2str()));
+    if( _shadow_set( _shadow_find( reg, true ), f.encode( bitKey ),
+		     setting ? f.encode( bitKey ) : 0 ) < 0 )
+      _LOG_ERR(( _id( "Register write error" ), "reg=", t2hex( reg ),
+		 errno2str()));
     
-    return _read_bit_8bit< K, V >( reg, bitKey, m );
+    return _read_bit_8bit( reg, bitKey, f );
   }
     
 
@@ -424,12 +558,111 @@ public:
         int16_t      addr( void ) const noexcept;
         int          fd(   void ) const noexcept;
   const std::string& bus( void  ) const noexcept;
+
+  // The adapter's I2C_FUNC_* bits, fetched when the adapter is
+  // opened.
+
+  unsigned long funcs( void ) const noexcept;
+
+  // Set/get whether register reads and other write-then-read
+  // sequences use one combined transaction (repeated start, one
+  // syscall) or a separate write and read (a STOP between them, two
+  // syscalls). Combined cannot be turned on when the adapter doesn't
+  // support plain i2c transfers.
+
+  bool combined( void        ) const noexcept;
+  bool combined( const bool c )       noexcept;
+
+  // Set/get whether 16-bit registers use SMBus word data transfers
+  // (one ioctl( I2C_SMBUS ) each way). Some adapters handle these
+  // more efficiently than plain i2c transfers. SMBus cannot be turned
+  // on when the adapter doesn't support reading and writing words.
+
+  bool smbus( void        ) const noexcept;
+  bool smbus( const bool s )       noexcept;
+
+  // Set/get the shadow register policy. Write-through (the default)
+  // writes a register when a field in it changes. Deferred leaves
+  // changes in the shadow until flush(), so configuring several
+  // fields of a register is one write. Going back to write-through
+  // flushes.
+  //
+  // flush() writes the registers with pending changes and returns
+  // how many were written or a negative number on error.
+  //
+  // shadow_invalidate() is for when the device may have been reset
+  // or changed behind our back: readable registers are read again
+  // when next needed and write-only registers are rewritten at the
+  // next flush().
+
+  SHADOW shadow( void           ) const noexcept;
+  SHADOW shadow( const SHADOW p )       noexcept;
+
+  int  flush( void ) const noexcept;
+  void shadow_invalidate( void ) noexcept;
+
+  // The number of read(), write(), and ioctl() calls made against
+  // i2c adapters by all devices since the program started. Useful to
+  // measure the cost of a transaction path.
+
+  static uint64_t syscalls( void ) noexcept;
+
+  // The number of reads by all devices that failed their device's
+  // checksum (e.g., the Si7021's CRC). A bus health metric: a noisy
+  // or marginal bus shows up here before it shows up as errors.
+
+  static uint64_t crc_errors( void ) noexcept;
+
+  // Probe every adapter, in parallel, for the addresses that answer
+  // and remember which bus each address is on so constructors
+  // needn't scan the adapters one after another. The first (lowest
+  // numbered) adapter wins when an address answers on several.
+  //
+  // The result is cached in a file. On the next start the cache is
+  // trusted when the same adapters exist with the same
+  // functionality and every cached address still answers, which is
+  // one probe per device rather than one per address per
+  // adapter. Otherwise the adapters are probed and the cache
+  // rewritten. Returns the number of addresses found.
+  //
+  // An empty cache name means no cache.
+  //
+  // Call this before constructing devices. Without it, _find() scans
+  // as it always has.
+
+  inline static const std::string discovery_cache = "/run/sensors.i2c";
+
+  // Set/get the transport adapters are opened on. The default is
+  // the Linux i2c-dev transport. Set it before discover() and before
+  // constructing devices - adapters already open stay on the
+  // transport they were opened on.
+
+  static std::shared_ptr< i2c_transport > transport( void ) noexcept;
+  static void transport( std::shared_ptr< i2c_transport > t ) noexcept;
+
+  static size_t discover( const std::string& cache = discovery_cache ) noexcept;
+
+private:
+
+  inline static std::atomic< uint64_t > mySyscalls   { 0 };
+  inline static std::atomic< uint64_t > myCRCErrors  { 0 };
+
+  // discover() helpers. _probe() asks whether an address answers on
+  // an adapter. _read_cache() returns true and fills found when the
+  // cache describes the adapters and its addresses still answer.
+
+  static bool _probe( i2c_adapter& a, const int16_t addr ) noexcept;
+  static bool _read_cache
+  ( const std::string& cache,
+    const std::vector< std::shared_ptr< i2c_adapter >>& adps,
+    std::vector< std::vector< int16_t >>& found ) noexcept;
   
 };
 
 inline
 i2c::i2c( i2c& d )
-  : myAddr( -1 ) {
+  : myAddr( -1 ), myCombined( false ), mySMBus( false ),
+    myShadowLen( 0 ), myShadowPolicy( SHADOW::WRITE_THROUGH ) {
   
   operator=( d );
   
@@ -437,7 +670,8 @@ i2c::i2c( i2c& d )
 
 inline
 i2c::i2c( i2c&& d )
-  : myAddr( -1 ) {
+  : myAddr( -1 ), myCombined( false ), mySMBus( false ),
+    myShadowLen( 0 ), myShadowPolicy( SHADOW::WRITE_THROUGH ) {
   
   operator=( d );
   
@@ -454,7 +688,7 @@ inline
 int
 i2c::fd( void ) const noexcept {
   
-  return myFD.get() ? *myFD : -1;
+  return myAdapter.get() ? myAdapter->fd : -1;
   
 }
 
@@ -465,6 +699,55 @@ i2c::bus( void ) const noexcept {
   return myBus;
 }
 
+inline
+unsigned long
+i2c::funcs( void ) const noexcept {
+
+  return myAdapter.get() ? myAdapter->funcs : 0;
+}
+
+inline
+bool
+i2c::combined( void ) const noexcept {
+
+  return myCombined;
+}
+
+inline
+bool
+i2c::smbus( void ) const noexcept {
+
+  return mySMBus;
+}
+
+inline
+i2c::SHADOW
+i2c::shadow( void ) const noexcept {
+
+  return myShadowPolicy;
+}
+
+inline
+uint64_t
+i2c::syscalls( void ) noexcept {
+
+  return mySyscalls.load( std::memory_order_relaxed );
+}
+
+inline
+uint64_t
+i2c::crc_errors( void ) noexcept {
+
+  return myCRCErrors.load( std::memory_order_relaxed );
+}
+
+inline
+void
+i2c::_crc_failed( void ) const noexcept {
+
+  myCRCErrors.fetch_add( 1, std::memory_order_relaxed );
+}
+
 inline
 const std::string
 i2c::_id( void ) const noexcept {
@@ -481,7 +764,143 @@ i2c::_read_reg(  const uint8_t reg, uint8_t* buf ) const noexcept {
 }
 
 
+// A batch of messages, possibly for several devices on the same
+// adapter, submitted as one ioctl( I2C_RDWR ) rather than one
+// syscall per transaction. For example, the register writes to all
+// three IS31FL3730 chips of the Micro Dot pHAT or the conversion
+// register reads of both ADS1015s.
+//
+// Messages are queued in order and transferred in order. A batch
+// larger than the kernel's limit (I2C_RDWR_IOCTL_MAX_MSGS) is split
+// into several transfers. Some adapters, the Pi's included, only
+// accept a read as the last message of a transfer so, by default, a
+// transfer also ends after every read.
+//
+// Each message has a status after submit(): 0 when transferred, a
+// negative errno when the transfer it was part of failed, and
+// pending (1) when it was never attempted. A failed transfer doesn't
+// stop later transfers of the batch.
+//
+// The caller's read buffers and write() buffers MUST remain valid
+// until submit() returns. write_reg() copies its data into the
+// batch. clear() keeps the batch's storage so a batch built once and
+// reused doesn't touch the heap.
+
+class i2c_batch {
+
+public:
+
+  inline static constexpr size_t max_msgs = I2C_RDWR_IOCTL_MAX_MSGS;
+  inline static constexpr int    pending  = 1;
+
+	   i2c_batch( void );
+  explicit i2c_batch( const size_t n );
+
+  i2c_batch( const i2c_batch&  b ) = delete;
+  i2c_batch( const i2c_batch&& b ) = delete;
+
+  i2c_batch& operator=( const i2c_batch&  b ) = delete;
+  i2c_batch& operator=( const i2c_batch&& b ) = delete;
+
+  // Queue a message. The return is the message's index within the
+  // batch or -1 on error, such as a device on a different bus than
+  // the messages already queued.
+
+  ssize_t write(     const i2c& d,
+		     const uint8_t* buf, const size_t len ) noexcept;
+  ssize_t write_reg( const i2c& d, const uint8_t reg,
+		     const uint8_t* buf, const size_t len ) noexcept;
+  ssize_t read(      const i2c& d,
+			   uint8_t* buf, const size_t len ) noexcept;
+
+  // Transfer the queued messages. Returns the number of messages
+  // successfully transferred, which is size() when all is well.
+
+  ssize_t submit( void ) noexcept;
+
+  // Status of message i and the number of syscalls the last submit()
+  // took.
+
+  int    status( const size_t i ) const noexcept;
+  size_t xfers(  void           ) const noexcept;
+
+  size_t size( void ) const noexcept;
+  void   clear( void ) noexcept;
+
+  // Set/get whether a transfer ends after a read message.
+
+  bool split_after_read( void         ) const noexcept;
+  bool split_after_read( const bool s )       noexcept;
+
+private:
+
+  // A queued message. Messages whose data was copied into the batch
+  // point at an offset into myData rather than a caller's buffer
+  // because myData may move as it grows.
+
+  struct msg {
+    const i2c* dev;
+    uint16_t   flags;
+    uint16_t   len;
+    uint8_t*   buf;
+    size_t     off;
+    int        status;
+  };
+
+  std::vector< msg >     myMsgs;
+  std::vector< uint8_t > myData;
+  size_t                 myXfers;
+  bool                   mySplit;
+
+  ssize_t _queue( const i2c& d, const uint16_t flags,
+		  uint8_t* buf, const size_t off, const size_t len ) noexcept;
+
+  // Transfer messages [b,e) as one transaction.
+
+  void _xfer( const size_t b, const size_t e ) noexcept;
+
+};
+
+
+inline
+int
+i2c_batch::status( const size_t i ) const noexcept {
+
+  assert( i < myMsgs.size());
+
+  return myMsgs[i].status;
+}
+
+inline
+size_t
+i2c_batch::xfers( void ) const noexcept {
+
+  return myXfers;
+}
+
+inline
+size_t
+i2c_batch::size( void ) const noexcept {
+
+  return myMsgs.size();
+}
+
+inline
+bool
+i2c_batch::split_after_read( void ) const noexcept {
+
+  return mySplit;
+}
+
+inline
+bool
+i2c_batch::split_after_read( const bool s ) noexcept {
+
+  return mySplit = s;
+}
+
+
 #endif
 
 
-//  LocalWords:  Mutex mutex subclasses doInit
+//  LocalWords:  Mutex mutex subclasses doInit RDWR errno
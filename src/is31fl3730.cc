@@ -104,8 +104,6 @@ static const std::vector< uint8_t > zero_cols( IS31FL3720_MAX_COLS, 0 );
   
 is31fl3730::is31fl3730( void )
   : i2c( default_addr ),
-    myConfigReg( default_config ), myPwmReg( default_pwm ),
-    myLightingEffectReg( default_lighting_effect ),
     myMatrix1ColumnRegisters( zero_cols ),
     myMatrix2ColumnRegisters( zero_cols ) {
   
@@ -116,8 +114,6 @@ is31fl3730::is31fl3730( void )
   
 is31fl3730::is31fl3730( const u_char ad )
   : i2c( ad ),
-    myConfigReg( default_config ), myPwmReg( default_pwm ),
-    myLightingEffectReg( default_lighting_effect ),
     myMatrix1ColumnRegisters( zero_cols ),
     myMatrix2ColumnRegisters( zero_cols ) {
   
@@ -128,8 +124,6 @@ is31fl3730::is31fl3730( const u_char ad )
   
 is31fl3730::is31fl3730( const std::string& bus, const u_char ad )
   : i2c( bus, ad ),
-    myConfigReg( default_config ), myPwmReg( default_pwm ),
-    myLightingEffectReg( default_lighting_effect ),
     myMatrix1ColumnRegisters( zero_cols ),
     myMatrix2ColumnRegisters( zero_cols ) {
   
@@ -146,8 +140,21 @@ is31fl3730::_doInit( void ) noexcept {
   
   bool retVal = false;
   
-  if( i2c::_doInit()) 
-    retVal = reset();
+  if( i2c::_doInit()) {
+
+    // The write-only registers, shadowed.
+
+    _shadow_reg( 0x00, -1, default_config );
+    _shadow_reg( 0x19, -1, default_pwm );
+    _shadow_reg( 0x0d, -1, default_lighting_effect );
+
+    assert( _shadow_find( 0x00 ) == SH_CFG );
+    assert( _shadow_find( 0x19 ) == SH_PWM );
+    assert( _shadow_find( 0x0d ) == SH_LE  );
+
+    retVal = reset() == 0;
+
+  }
 
   return retVal;
 }
@@ -156,9 +163,6 @@ is31fl3730::_doInit( void ) noexcept {
 is31fl3730::is31fl3730( is31fl3730& ad )
   : i2c( ad ) {
   
-  myConfigReg              = ad.myConfigReg;
-  myPwmReg                 = ad.myPwmReg;
-  myLightingEffectReg      = ad.myLightingEffectReg;
   myMatrix1ColumnRegisters = ad.myMatrix1ColumnRegisters;
   myMatrix2ColumnRegisters = ad.myMatrix2ColumnRegisters;
   
@@ -168,15 +172,9 @@ is31fl3730::is31fl3730( is31fl3730& ad )
 is31fl3730::is31fl3730( is31fl3730&& ad )
   : i2c( ad ) {
 
-  myConfigReg              = ad.myConfigReg;
-  myPwmReg                 = ad.myPwmReg;
-  myLightingEffectReg      = ad.myLightingEffectReg;
   myMatrix1ColumnRegisters = ad.myMatrix1ColumnRegisters;
   myMatrix2ColumnRegisters = ad.myMatrix2ColumnRegisters;
   
-  ad.myConfigReg         = default_config;
-  ad.myPwmReg            = default_pwm;
-  ad.myLightingEffectReg = default_lighting_effect;
   
   ad.myMatrix1ColumnRegisters = zero_cols;
   ad.myMatrix2ColumnRegisters = zero_cols;
@@ -189,9 +187,6 @@ is31fl3730::operator=( is31fl3730& ad ) {
   
   i2c::operator=( ad );
   
-  myConfigReg              = ad.myConfigReg;
-  myPwmReg                 = ad.myPwmReg;
-  myLightingEffectReg      = ad.myLightingEffectReg;
   myMatrix1ColumnRegisters = ad.myMatrix1ColumnRegisters;
   myMatrix2ColumnRegisters = ad.myMatrix2ColumnRegisters;
   
@@ -204,13 +199,7 @@ is31fl3730::operator=( is31fl3730&& ad ) {
   
   i2c::operator=( ad );
 
-  myConfigReg         = ad.myConfigReg;
-  myPwmReg            = ad.myPwmReg;
-  myLightingEffectReg = ad.myLightingEffectReg;
   
-  ad.myConfigReg         = default_config;
-  ad.myPwmReg            = default_pwm;
-  ad.myLightingEffectReg = default_lighting_effect;
   
   ad.myMatrix1ColumnRegisters = zero_cols;
   ad.myMatrix2ColumnRegisters = zero_cols;
@@ -225,9 +214,9 @@ is31fl3730::operator==( const is31fl3730& d ) const noexcept {
   bool retVal = false;
   
   if( i2c::operator==( d ))
-    if( myConfigReg == d.myConfigReg )
-      if( myPwmReg == d.myPwmReg )
-	if( myLightingEffectReg == d.myLightingEffectReg )
+    if( _shadow_get( SH_CFG ) == d._shadow_get( SH_CFG ))
+      if( _shadow_get( SH_PWM ) == d._shadow_get( SH_PWM ))
+	if( _shadow_get( SH_LE ) == d._shadow_get( SH_LE ))
 	  if( myMatrix1ColumnRegisters == d.myMatrix1ColumnRegisters )
 	    if( myMatrix2ColumnRegisters == d.myMatrix2ColumnRegisters )
 	      retVal = true;
@@ -245,6 +234,19 @@ is31fl3730::operator!=( const is31fl3730& d ) const noexcept {
 
 void
 is31fl3730::_check( void ) noexcept {
+
+  // The field tables are consistent and fields sharing a register
+  // don't overlap.
+
+  static_assert( SSD_FIELD.ok() && DISPLAY_FIELD.ok() && MATRIX_FIELD.ok()
+		 && AUDIO_MODE_FIELD.ok() && AUDIO_GAIN_FIELD.ok()
+		 && ROW_CURRENT_FIELD.ok());
+  static_assert( _disjoint< uint8_t >({ SSD_FIELD.mask,
+					DISPLAY_FIELD.mask,
+					AUDIO_MODE_FIELD.mask,
+					MATRIX_FIELD.mask }) != 0 );
+  static_assert( _disjoint< uint8_t >({ AUDIO_GAIN_FIELD.mask,
+					ROW_CURRENT_FIELD.mask }) != 0 );
   
 #ifdef _DPG_DEBUG
   assert( zero_cols.size() == IS31FL3720_MAX_COLS );
@@ -270,42 +272,6 @@ is31fl3730::_check( void ) noexcept {
   assert( myMatrix1ColumnRegisters.size() == IS31FL3720_MAX_COLS );
   assert( myMatrix2ColumnRegisters.size() == IS31FL3720_MAX_COLS );
   
-  _check_masking< SOFTWARE_SHUTDOWN >( SSD_MAP         );
-  _check_masking< DISPLAY_MODE      >( DISPLAY_MAP     );
-  _check_masking< AUDIO_MODE        >( AUDIO_MODE_MAP  );
-  _check_masking< MATRIX_MODE       >( MATRIX_MAP      );
-  _check_masking< AUDIO_GAIN_MODE   >( AUDIO_GAIN_MAP  );
-  _check_masking< ROW_CURRENT_MODE  >( ROW_CURRENT_MAP );
-  
-  // Configuration register.
-  
-  _check_bit_overlap< decltype( SSD_MAP        ),
-		      decltype( DISPLAY_MAP    )>( SSD_MAP, DISPLAY_MAP );
-  _check_bit_overlap< decltype( SSD_MAP        ),
-		      decltype( AUDIO_MODE_MAP )>( SSD_MAP, AUDIO_MODE_MAP );
-  _check_bit_overlap< decltype( SSD_MAP        ),
-		      decltype( MATRIX_MAP     )>( SSD_MAP, MATRIX_MAP );
-  
-  _check_bit_overlap< decltype( DISPLAY_MAP    ),
-		      decltype( AUDIO_MODE_MAP )>( DISPLAY_MAP,
-						   AUDIO_MODE_MAP );
-  _check_bit_overlap< decltype( DISPLAY_MAP    ),
-		      decltype( AUDIO_MODE_MAP )>( DISPLAY_MAP,
-						   AUDIO_MODE_MAP );
-  _check_bit_overlap< decltype( DISPLAY_MAP    ),
-		      decltype( MATRIX_MAP     )>( DISPLAY_MAP,
-						   MATRIX_MAP );
-  
-  _check_bit_overlap< decltype( AUDIO_MODE_MAP ),
-		      decltype( MATRIX_MAP     )>( AUDIO_MODE_MAP,
-						   MATRIX_MAP );
-  
-  // Lighting effect register.
-  
-  _check_bit_overlap< decltype( AUDIO_GAIN_MAP ),
-		      decltype( ROW_CURRENT_MAP )>( AUDIO_GAIN_MAP,
-						    ROW_CURRENT_MAP );
-  
   _LOG_VERB(( "Data structures bit map tests passed" ));
 #endif
 }
@@ -326,12 +292,12 @@ is31fl3730::reset ( void ) {
       
     } else {
       
-      myConfigReg         = default_config;
-      myPwmReg            = default_pwm;
-      myLightingEffectReg = default_lighting_effect;
+      _shadow_reset();
       
       myMatrix1ColumnRegisters = zero_cols;
       myMatrix2ColumnRegisters = zero_cols;
+
+      matrix_invalidate();
       
       rVal = 0;
       
@@ -348,141 +314,103 @@ is31fl3730::reset ( void ) {
 }
 
 
-int32_t 
-is31fl3730::_write_cfg( void ) const noexcept {
-
-  const uint8_t w_buf[] = { 0x00, myConfigReg };
+int32_t
+is31fl3730::_write_matrix( const uint8_t ad,
+			   const std::vector< uint8_t >& regs ) const noexcept {
 
-  int32_t  rVal = std::numeric_limits< int32_t >::min();
-  ssize_t w_num = _write( w_buf, sizeof( w_buf ));
-  
-  if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Unable to write to config register" ),
-		", w_num=", w_num, ", vals: ",
-		_vtoa( w_buf, sizeof( w_buf )), errno2str()));
-    
-  } else
-    rVal = int32_t( w_num );
-  
-  _LOG_VERB(( "fd=", fd(), " addr=0x", t2hex( addr()), " ",
-	      "w=", w_num, " ", _vtoa( w_buf, sizeof( w_buf ))));
+  assert( regs.size() <= IS31FL3720_MAX_COLS );
   
-  return rVal;
-}
-
-
-int32_t
-is31fl3730::_write_pwm( void ) const noexcept {
+  int32_t rVal = std::numeric_limits< int32_t >::min();
   
-  const u_char w_buf[] = { 0x19, myPwmReg };
+  // The matrix data is staged on the stack by _write_reg().
   
-  int32_t  rVal = std::numeric_limits< int32_t >::min();
-  ssize_t w_num = _write( w_buf, sizeof( w_buf ));
+  ssize_t w_num = _write_reg( ad, regs.data(), regs.size());
   
-  if( w_num != sizeof( w_buf )) {
+  if( w_num != ssize_t( regs.size() + 1 )) {
     
-    _LOG_WARN(( _id( "Unable to write to PWM register" ),
-		", w_num=", w_num, ", vals: ",
-		_vtoa( w_buf, sizeof( w_buf )), errno2str()));
+    _LOG_WARN(( _id( "Unable to write to matrix register" ),
+		", w_num=", w_num, ", reg=", t2hex( ad ), ", vals: ",
+		_vtoa( regs ), errno2str()));
     
-  } else
+  } else {
+
+    myBytesWritten += w_num;
     rVal = int32_t( w_num );
+
+  }
   
   _LOG_VERB(( "fd=", fd(), " addr=0x", t2hex( addr()), " ",
-	      "w=", w_num, " ", _vtoa( w_buf, sizeof( w_buf ))));
+	      "w=", w_num, " ", t2hex( ad ), " ", _vtoa( regs )));
   
   return rVal;
 }
-  
+
 
 int32_t
-is31fl3730::_write_le( void ) const noexcept {
-  
-  const u_char w_buf[] = { 0x0d, myLightingEffectReg };
-  
-  int32_t  rVal = std::numeric_limits< int32_t >::min();
+is31fl3730::_latch( void ) const noexcept {
+
+  // Writing any value to the update register latches both matrices.
+
+  constexpr uint8_t w_buf[] = { 0x0c, 0x00 };
+
+  int32_t rVal = std::numeric_limits< int32_t >::min();
+
   ssize_t w_num = _write( w_buf, sizeof( w_buf ));
-  
+
   if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Unable to write to lighting effect register" ),
+
+    _LOG_WARN(( _id( "Unable to update matrix" ),
 		", w_num=", w_num, ", vals: ",
 		_vtoa( w_buf, sizeof( w_buf )), errno2str()));
-    
-  } else
+
+  } else {
+
+    myBytesWritten += w_num;
     rVal = int32_t( w_num );
-  
+
+  }
+
   _LOG_VERB(( "fd=", fd(), " addr=0x", t2hex( addr()), " ",
 	      "w=", w_num, " ", _vtoa( w_buf, sizeof( w_buf ))));
-  
+
   return rVal;
 }
 
 
-int32_t
-is31fl3730::_write_matrix( const uint8_t ad,
-			   const std::vector< uint8_t >& regs ) const noexcept {
+bool
+is31fl3730::_dirty( const std::vector< uint8_t >& regs,
+		    const std::vector< uint8_t >& sent ) const noexcept {
+
+  const bool rVal = ( sent.empty() || ( regs != sent ));
+
+  if( rVal == false )
+    myBytesSaved += regs.size() + 1;
 
-  assert( regs.size() <= IS31FL3720_MAX_COLS );
-  
-  const     size_t  wbuf1_size = 1 + regs.size();
-  constexpr uint8_t   w_buf2[] = { 0x0c, 0x00 };
-  
-  int32_t rVal = std::numeric_limits< int32_t >::min();
-  
-  std::unique_ptr< uint8_t[] > w_buf1( new uint8_t[ wbuf1_size ]);
-  assert( w_buf1.get());
-  
-  // Set up the buffer content.
-  
-  w_buf1.get()[ 0 ] = ad;
-  for( size_t i = 0; i < regs.size(); ++i )
-    w_buf1.get()[ i + 1 ] = regs[ i ];
-  
-  // Send out the matrix data and tell the display to update.
-  
-  ssize_t w_num1 = _write( w_buf1.get(), wbuf1_size );
-  ssize_t w_num2 = _write( w_buf2, sizeof( w_buf2 ));
-  
-  if( w_num1 != ssize_t( wbuf1_size )) {
-    
-    _LOG_WARN(( _id( "Unable to write to matrix register" ),
-		", w_num=", w_num1, ", vals: ",
-		_vtoa( w_buf1.get(), wbuf1_size ), errno2str()));
-    
-  } else
-    if( w_num2 != sizeof( w_buf2 )) {
-      
-      _LOG_WARN(( _id( "Unable to update matrix" ),
-                  ", w_num=", w_num2, ", vals: ",
-		  _vtoa( w_buf2, sizeof( w_buf2 )), errno2str()));
-      
-    } else
-      rVal = int32_t( w_num1 );
-  
-  _LOG_VERB(( "fd=", fd(), " addr=0x", t2hex( addr()), " ",
-	      "w=", w_num1, " ", _vtoa( w_buf1.get(), wbuf1_size )));
-  _LOG_VERB(( "fd=", fd(), " addr=0x", t2hex( addr()), " ",
-	      "w=", w_num2, " ", _vtoa( w_buf2, sizeof( w_buf2 ))));
-  
   return rVal;
 }
 
+
+void
+is31fl3730::matrix_invalidate( void ) const noexcept {
+
+  // clear() keeps the capacity so the next update doesn't allocate.
+
+  mySent1.clear();
+  mySent2.clear();
+}
+
   
 const bool
 is31fl3730::display_on( void ) const noexcept {
   
-  return !_read_bit_cfg< SOFTWARE_SHUTDOWN >
-    ( SSD_MAP, SOFTWARE_SHUTDOWN::SHUTDOWN );
+  return !_read_bit_cfg( SSD_FIELD, SOFTWARE_SHUTDOWN::SHUTDOWN );
 }
 
 
 const bool
 is31fl3730::display_on( const bool f ) noexcept {
   
-  (void)_write_bit_cfg< SOFTWARE_SHUTDOWN >
-    ( SSD_MAP, SOFTWARE_SHUTDOWN::SHUTDOWN, !f );
+  (void)_write_bit_cfg( SSD_FIELD, SOFTWARE_SHUTDOWN::SHUTDOWN, !f );
   
   return display_on();
 }
@@ -492,14 +420,14 @@ const is31fl3730::DISPLAY
 is31fl3730::display_mode( void ) const noexcept {
   
   return static_cast< DISPLAY >
-    ( _read_map_cfg< DISPLAY_MODE >( DISPLAY_MAP ));
+    ( _read_map_cfg( DISPLAY_FIELD ));
 }
 
 const is31fl3730::DISPLAY
 is31fl3730::display_mode( const DISPLAY m ) noexcept {
   
-  (void)_write_map_cfg< DISPLAY_MODE >
-    ( static_cast< DISPLAY_MODE >( m ), DISPLAY_MAP );
+  (void)_write_map_cfg
+    ( static_cast< DISPLAY_MODE >( m ), DISPLAY_FIELD );
   
   return display_mode();
 }
@@ -509,15 +437,15 @@ const is31fl3730::MATRIX
   is31fl3730::matrix_mode( void ) const noexcept {
   
   return static_cast< MATRIX >
-    ( _read_map_cfg< MATRIX_MODE >( MATRIX_MAP ));
+    ( _read_map_cfg( MATRIX_FIELD ));
 }
 
 
 const is31fl3730::MATRIX
 is31fl3730::matrix_mode( const MATRIX m ) noexcept {
   
-  (void)_write_map_cfg< MATRIX_MODE >
-    ( static_cast< MATRIX_MODE >( m ), MATRIX_MAP );
+  (void)_write_map_cfg
+    ( static_cast< MATRIX_MODE >( m ), MATRIX_FIELD );
   
   return matrix_mode();
 }
@@ -526,15 +454,14 @@ is31fl3730::matrix_mode( const MATRIX m ) noexcept {
 const bool
 is31fl3730::audio_enable( void ) const noexcept {
   
-  return _read_bit_cfg< AUDIO_MODE >( AUDIO_MODE_MAP, AUDIO_MODE::ENABLE );
+  return _read_bit_cfg( AUDIO_MODE_FIELD, AUDIO_MODE::ENABLE );
 }
 
 
 const bool
 is31fl3730::audio_enable( const bool f ) noexcept {
   
-  (void)_write_bit_cfg< AUDIO_MODE >
-    ( AUDIO_MODE_MAP, AUDIO_MODE::ENABLE, f );
+  (void)_write_bit_cfg( AUDIO_MODE_FIELD, AUDIO_MODE::ENABLE, f );
   
   return audio_enable();
 }
@@ -543,16 +470,12 @@ is31fl3730::audio_enable( const bool f ) noexcept {
 const uint8_t
 is31fl3730::pwm128( const bool f ) noexcept {
   
-  if( myPwmReg & 0b10000000 ) {
-    if( f )
-      myPwmReg = 0b10000000;
-    else
-      myPwmReg &= ~0b10000000;
-  } else
-    if( f )
-      myPwmReg = 0b10000000;
-  
-  (void)_write_pwm();
+  // Setting 128 clears the 0..127 setting.
+
+  if( f )
+    (void)_shadow_set( SH_PWM, 0b11111111, 0b10000000 );
+  else
+    (void)_shadow_set( SH_PWM, 0b10000000, 0b00000000 );
   
   return pwm();
 }
@@ -561,9 +484,7 @@ is31fl3730::pwm128( const bool f ) noexcept {
 const uint8_t
 is31fl3730::pwm( const uint8_t p ) noexcept {
   
-  myPwmReg = ( p & ~0b10000000 );
-  
-  (void)_write_pwm();
+  (void)_shadow_set( SH_PWM, 0b11111111, p & ~0b10000000 );
   
   return pwm();
 }
@@ -573,15 +494,15 @@ const is31fl3730::AUDIO_GAIN
 is31fl3730::audio_gain( void ) const noexcept {
   
   return static_cast< AUDIO_GAIN >
-    ( _read_map_le( AUDIO_GAIN_MAP ));
+    ( _read_map_le( AUDIO_GAIN_FIELD ));
 }
 
 
 const is31fl3730::AUDIO_GAIN
 is31fl3730::audio_gain( const AUDIO_GAIN g ) noexcept {
   
-  (void)_write_map_le< AUDIO_GAIN_MODE >
-    ( static_cast< AUDIO_GAIN_MODE >( g ), AUDIO_GAIN_MAP );
+  (void)_write_map_le
+    ( static_cast< AUDIO_GAIN_MODE >( g ), AUDIO_GAIN_FIELD );
   
   return audio_gain();
 }
@@ -591,15 +512,15 @@ const is31fl3730::ROW_CURRENT
 is31fl3730::row_current( void ) const noexcept {
   
   return static_cast< ROW_CURRENT >
-    ( _read_map_le( ROW_CURRENT_MAP ));
+    ( _read_map_le( ROW_CURRENT_FIELD ));
 }
 
 
 const is31fl3730::ROW_CURRENT
 is31fl3730::row_current( const ROW_CURRENT c ) noexcept {
   
-  (void)_write_map_le< ROW_CURRENT_MODE >
-    ( static_cast< ROW_CURRENT_MODE >( c ), ROW_CURRENT_MAP );
+  (void)_write_map_le
+    ( static_cast< ROW_CURRENT_MODE >( c ), ROW_CURRENT_FIELD );
   
   return row_current();
 }
@@ -641,27 +562,126 @@ is31fl3730::matrix( const MATRIX_REG r ) noexcept {
 const int32_t
 is31fl3730::update( void ) const noexcept {
   
-  int rVal = std::numeric_limits< int32_t >::min();
-  
-  if(( rVal = update( MATRIX_REG::MATRIX1 )) >= 0 )
-    rVal = update( MATRIX_REG::MATRIX2 );
+  int32_t rVal = 0;
+  bool    any  = false;
+
+  // Each changed matrix then one latch for both.
+
+  for( const auto& [ad,regs,sent] :
+	 { std::tie( matrix_addr1, myMatrix1ColumnRegisters, mySent1 ),
+	   std::tie( matrix_addr2, myMatrix2ColumnRegisters, mySent2 ) })
+    if(( rVal >= 0 ) && _dirty( regs, sent )) {
+
+      any = true;
+
+      if(( rVal = _write_matrix( ad, regs )) >= 0 )
+	sent = regs;
+      else
+	sent.clear();
+
+    }
+
+  if( any ) {
+
+    if( rVal >= 0 )
+      rVal = _latch();
+
+    // Not latched, so what was written isn't showing.
+
+    if( rVal < 0 )
+      matrix_invalidate();
+
+  } else
+    myBytesSaved += 2;
   
   return rVal;
 }
 
 
+const int32_t
+is31fl3730::update( i2c_batch& b ) const noexcept {
+
+  assert( myMatrix1ColumnRegisters.size() <= IS31FL3720_MAX_COLS );
+  assert( myMatrix2ColumnRegisters.size() <= IS31FL3720_MAX_COLS );
+
+  // Writing any value to the update register latches both matrices.
+
+  static constexpr uint8_t w_buf[] = { 0x0c, 0x00 };
+
+  int32_t rVal = 0;
+
+  for( const auto& [ad,regs,sent] :
+	 { std::tie( matrix_addr1, myMatrix1ColumnRegisters, mySent1 ),
+	   std::tie( matrix_addr2, myMatrix2ColumnRegisters, mySent2 ) })
+    if(( rVal >= 0 ) && _dirty( regs, sent )) {
+
+      if( b.write_reg( *this, ad, regs.data(), regs.size()) >= 0 ) {
+	sent = regs;
+	myBytesWritten += regs.size() + 1;
+	++rVal;
+      } else
+	rVal = -1;
+
+    }
+
+  if( rVal > 0 ) {
+
+    if( b.write( *this, w_buf, sizeof( w_buf )) >= 0 ) {
+      myBytesWritten += sizeof( w_buf );
+      ++rVal;
+    } else
+      rVal = -1;
+
+  } else
+    if( rVal == 0 )
+      myBytesSaved += sizeof( w_buf );
+
+  if( rVal < 0 ) {
+    _LOG_WARN(( _id( "Unable to queue matrix update" )));
+    matrix_invalidate();
+  }
+
+  return rVal;
+}
+
+
 const int32_t
 is31fl3730::update( const MATRIX_REG r ) const noexcept {
   
   int rVal = std::numeric_limits< int32_t >::min();
   
-  if( r == MATRIX_REG::MATRIX1 )
-    rVal = _write_matrix( 0x01, myMatrix1ColumnRegisters );
-  else
-    if( r == MATRIX_REG::MATRIX2 )
-      rVal = _write_matrix( 0x0e, myMatrix2ColumnRegisters );
-    else
+  const std::vector< uint8_t >* regs = nullptr;
+  std::vector< uint8_t >*       sent = nullptr;
+  uint8_t                       ad   = 0;
+
+  if( r == MATRIX_REG::MATRIX1 ) {
+    regs = &myMatrix1ColumnRegisters; sent = &mySent1; ad = matrix_addr1;
+  } else
+    if( r == MATRIX_REG::MATRIX2 ) {
+      regs = &myMatrix2ColumnRegisters; sent = &mySent2; ad = matrix_addr2;
+    } else
       _LOG_ERR(( _id( "How did I get here?" )));
+
+  if( regs ) {
+
+    if( _dirty( *regs, *sent )) {
+
+      if(( rVal = _write_matrix( ad, *regs )) >= 0 ) {
+	*sent = *regs;
+	if(( rVal = _latch()) >= 0 )
+	  rVal = int32_t( regs->size() + 1 );
+	else
+	  matrix_invalidate();
+      } else
+	sent->clear();
+
+    } else {
+
+      myBytesSaved += 2;
+      rVal = 0;
+
+    }
+  }
   
   return rVal;
 }
@@ -83,6 +83,7 @@ extern "C" {
 
 #include "i2c.h"
 #include "log.h"
+#include "templates.h"
 #include "util.h"
 
 
@@ -113,13 +114,16 @@ private:
   inline static constexpr uint8_t default_pwm             = 0x80;
   inline static constexpr uint8_t default_lighting_effect = 0x00;
   
-  // The device is a write-only device. Here is where I cache various
-  // registers.
-        
-  uint8_t myConfigReg;
-  uint8_t myPwmReg;
-  uint8_t myLightingEffectReg;
+  // The device is a write-only device. The configuration, PWM, and
+  // lighting effect registers are kept in the i2c shadow registers,
+  // at these indexes.
   
+  inline static constexpr int SH_CFG = 0, SH_PWM = 1, SH_LE = 2;
+
+  // Where each matrix's column registers start.
+
+  inline static constexpr uint8_t matrix_addr1 = 0x01, matrix_addr2 = 0x0e;
+
   // The data registers of each matrix display. They are fixed length
   // of 11.
   //
@@ -132,6 +136,16 @@ private:
     
   std::vector< uint8_t > myMatrix1ColumnRegisters,
                          myMatrix2ColumnRegisters;
+
+  // What the device's matrix registers hold: the bytes last written
+  // to each, or empty when unknown (e.g., after construction, reset,
+  // or a failed write or latch). A matrix equal to its shadow isn't written
+  // again, and when neither is written neither is the update
+  // register. Along with the bytes written and the bytes not written
+  // because nothing changed.
+
+  mutable std::vector< uint8_t > mySent1, mySent2;
+  mutable uint64_t               myBytesWritten = 0, myBytesSaved = 0;
     
   // Check certain data structures for consistency and assert() if
   // something doesn't make sense. The body of this function is
@@ -147,16 +161,18 @@ private:
     
   bool _doInit( void ) noexcept;
 
-  // Write to the configuration, PWM, and lighting effect registers.
-  
-  int32_t _write_cfg( void ) const noexcept;
-  int32_t _write_pwm( void ) const noexcept;
-  int32_t _write_le( void ) const noexcept;
-  
-  // Write out the matrix data starting at addr.
+  // Write out the matrix data starting at addr, and the update
+  // register that latches both matrices.
   
   int32_t _write_matrix( const uint8_t ad,
 			 const std::vector< uint8_t >& regs ) const noexcept;
+  int32_t _latch( void ) const noexcept;
+
+  // Whether a matrix differs from what the device holds, counting the
+  // bytes saved when it doesn't.
+
+  bool _dirty( const std::vector< uint8_t >& regs,
+	       const std::vector< uint8_t >& sent ) const noexcept;
     
 public:
 
@@ -270,11 +286,31 @@ public:
   const std::vector< uint8_t >& matrix( const MATRIX_REG ) const noexcept;
         std::vector< uint8_t >& matrix( const MATRIX_REG )       noexcept;
 
-  // Update a particular matrix or update both.
+  // Update a particular matrix or update both. Only a matrix that
+  // changed since it was last written is written, followed by one
+  // write of the update register when anything was.
     
   const int32_t update( const MATRIX_REG ) const noexcept;
   const int32_t update( void             ) const noexcept;
 
+  // Queue the changed matrices and one update register write onto a
+  // batch, rather than writing them, so several chips can be updated
+  // in one transaction. Nothing is queued when nothing changed.
+  // Returns the number of messages queued or -1.
+  //
+  // The matrices are taken as written once queued. If the batch then
+  // fails, call matrix_invalidate() so the next update writes them.
+
+  const int32_t update( i2c_batch& b ) const noexcept;
+
+  void matrix_invalidate( void ) const noexcept;
+
+  // The matrix and update register bytes update() wrote (or queued),
+  // and the bytes it didn't need to because nothing had changed.
+
+  uint64_t bytes_written( void ) const noexcept;
+  uint64_t bytes_saved(   void ) const noexcept;
+
   /* Conversion utilities for enumerations */
 
   const int         rc2i( const ROW_CURRENT ) const noexcept;
@@ -296,11 +332,13 @@ private:
   // web and you'll see for yourself). A bit disappointing of the data
   // type, IMO.
 
+  // The fields of the configuration register.
+
   enum class SOFTWARE_SHUTDOWN { _NONE, SHUTDOWN, _MASK };
-  inline static const std::map< SOFTWARE_SHUTDOWN, uint8_t > SSD_MAP {
-    { SOFTWARE_SHUTDOWN::SHUTDOWN, 0b10000000 },
-    { SOFTWARE_SHUTDOWN::_MASK,    0b10000000 }
-  };
+  inline static constexpr
+  field< SOFTWARE_SHUTDOWN, uint8_t, 7, 1 > SSD_FIELD {{
+    { SOFTWARE_SHUTDOWN::SHUTDOWN, 0b1 }
+  }};
 
   enum class DISPLAY_MODE : int {
     _NONE = -1, _MASK = -2,
@@ -308,12 +346,11 @@ private:
     MATRIX2 = int( DISPLAY::MATRIX2 ),
     BOTH    = int( DISPLAY::BOTH )
   };
-  inline static const std::map< DISPLAY_MODE, uint8_t > DISPLAY_MAP {
-    { DISPLAY_MODE::MATRIX1,       0b00000000 },
-    { DISPLAY_MODE::MATRIX2,       0b00001000 },
-    { DISPLAY_MODE::BOTH,          0b00011000 },
-    { DISPLAY_MODE::_MASK,         0b00011000 }
-  };
+  inline static constexpr field< DISPLAY_MODE, uint8_t, 3, 2 > DISPLAY_FIELD {{
+    { DISPLAY_MODE::MATRIX1,       0b00 },
+    { DISPLAY_MODE::MATRIX2,       0b01 },
+    { DISPLAY_MODE::BOTH,          0b11 }
+  }};
 
   enum class MATRIX_MODE : int {
     _NONE = -1, _MASK = -2,
@@ -322,19 +359,19 @@ private:
     ADM_6x10 = int( MATRIX::ADM_6x10 ),
     ADM_5x11 = int( MATRIX::ADM_5x11 ),
   };
-  inline static const std::map< MATRIX_MODE, uint8_t > MATRIX_MAP {
-    { MATRIX_MODE::ADM_8x8,        0b00000000 },
-    { MATRIX_MODE::ADM_7x9,        0b00000001 },
-    { MATRIX_MODE::ADM_6x10,       0b00000010 },
-    { MATRIX_MODE::ADM_5x11,       0b00000011 },
-    { MATRIX_MODE::_MASK,          0b00000011 }
-  };
+  inline static constexpr field< MATRIX_MODE, uint8_t, 0, 2 > MATRIX_FIELD {{
+    { MATRIX_MODE::ADM_8x8,        0b00 },
+    { MATRIX_MODE::ADM_7x9,        0b01 },
+    { MATRIX_MODE::ADM_6x10,       0b10 },
+    { MATRIX_MODE::ADM_5x11,       0b11 }
+  }};
 
   enum class AUDIO_MODE { _NONE, ENABLE, _MASK };
-  inline static const std::map< AUDIO_MODE, uint8_t > AUDIO_MODE_MAP {
-    { AUDIO_MODE::ENABLE,          0b00000100 },
-    { AUDIO_MODE::_MASK,           0b00000100 }
-  };
+  inline static constexpr field< AUDIO_MODE, uint8_t, 2, 1 > AUDIO_MODE_FIELD {{
+    { AUDIO_MODE::ENABLE,          0b1 }
+  }};
+
+  // The fields of the lighting effect register.
 
   enum class AUDIO_GAIN_MODE : int {
     _NONE = -1, _MASK = -2,
@@ -347,17 +384,17 @@ private:
     dB_18 = int( AUDIO_GAIN::dB_18 ),
     dB_minus_6 = int( AUDIO_GAIN::dB_minus_6 )
   };
-  inline static const std::map< AUDIO_GAIN_MODE, uint8_t > AUDIO_GAIN_MAP {
-    { AUDIO_GAIN_MODE::dB_0,       0b00000000 },
-    { AUDIO_GAIN_MODE::dB_3,       0b00010000 },
-    { AUDIO_GAIN_MODE::dB_6,       0b00100000 },
-    { AUDIO_GAIN_MODE::dB_9,       0b00110000 },
-    { AUDIO_GAIN_MODE::dB_12,      0b01000000 },
-    { AUDIO_GAIN_MODE::dB_15,      0b01010000 },
-    { AUDIO_GAIN_MODE::dB_18,      0b01100000 },
-    { AUDIO_GAIN_MODE::dB_minus_6, 0b01110000 },
-    { AUDIO_GAIN_MODE::_MASK,      0b01110000 }
-  };
+  inline static constexpr
+  field< AUDIO_GAIN_MODE, uint8_t, 4, 3 > AUDIO_GAIN_FIELD {{
+    { AUDIO_GAIN_MODE::dB_0,       0b000 },
+    { AUDIO_GAIN_MODE::dB_3,       0b001 },
+    { AUDIO_GAIN_MODE::dB_6,       0b010 },
+    { AUDIO_GAIN_MODE::dB_9,       0b011 },
+    { AUDIO_GAIN_MODE::dB_12,      0b100 },
+    { AUDIO_GAIN_MODE::dB_15,      0b101 },
+    { AUDIO_GAIN_MODE::dB_18,      0b110 },
+    { AUDIO_GAIN_MODE::dB_minus_6, 0b111 }
+  }};
 
   enum class ROW_CURRENT_MODE : int {
     _NONE = -1, _MASK = -2,
@@ -368,15 +405,15 @@ private:
     mA_10 = int( ROW_CURRENT::mA_10 ),
     mA_35 = int( ROW_CURRENT::mA_35 )
   };
-  inline static const std::map< ROW_CURRENT_MODE, uint8_t > ROW_CURRENT_MAP {
-    { ROW_CURRENT_MODE::mA_40,     0b00000000 },
-    { ROW_CURRENT_MODE::mA_45,     0b00000001 },
-    { ROW_CURRENT_MODE::mA_75,     0b00000111 },
-    { ROW_CURRENT_MODE::mA_5,      0b00001000 },
-    { ROW_CURRENT_MODE::mA_10,     0b00001001 },
-    { ROW_CURRENT_MODE::mA_35,     0b00001110 },
-    { ROW_CURRENT_MODE::_MASK,     0b00001111 }
-  };
+  inline static constexpr
+  field< ROW_CURRENT_MODE, uint8_t, 0, 4 > ROW_CURRENT_FIELD {{
+    { ROW_CURRENT_MODE::mA_40,     0b0000 },
+    { ROW_CURRENT_MODE::mA_45,     0b0001 },
+    { ROW_CURRENT_MODE::mA_75,     0b0111 },
+    { ROW_CURRENT_MODE::mA_5,      0b1000 },
+    { ROW_CURRENT_MODE::mA_10,     0b1001 },
+    { ROW_CURRENT_MODE::mA_35,     0b1110 }
+  }};
 
 
   inline static const std::map< AUDIO_GAIN, int > audio_xlate_f {
@@ -424,25 +461,21 @@ private:
   // code and let the compiler's optimizer clean things up as specific
   // to the template's usage.
 
-  template< typename E >
+  template< typename F >
   inline
   bool
-  _read_bit_cfg( const std::map< E, uint8_t >& m, const E& b ) const noexcept {
+  _read_bit_cfg( const F& f,
+		 const typename F::key_type& b ) const noexcept {
     
-    return ( myConfigReg & m.at( b )) ? true : false;
+    return ( _shadow_get( SH_CFG ) & f.encode( b )) ? true : false;
   }
   
-  template< typename E >
+  template< typename F >
   inline
   int32_t 
-  _write_bit_cfg( const std::map< E, uint8_t >& m, const E& b, bool e ) {
-    
-    myConfigReg &= ~m.at( E::_MASK );
+  _write_bit_cfg( const F& f, const typename F::key_type& b, bool e ) {
     
-    if( e )
-      myConfigReg |= m.at( b );
-    
-    int32_t rVal = _write_cfg();
+    int32_t rVal = _shadow_set( SH_CFG, f.mask, e ? f.encode( b ) : 0 );
     
     if( rVal < 0 )
       _LOG_WARN(( _id( "Unable to write to configuration register" ),
@@ -455,62 +488,37 @@ private:
   // device's register, the cached register (remember that the device
   // is write-only), and private data structures.
     
-  template< typename E >
+  template< typename F >
   inline
-  E _read_map( const std::map< E, uint8_t >& m,
-	       const uint8_t& reg ) const noexcept {
-    
-    // The default (failure) return type.
-    
-    E e_type = E::_NONE;
-    
-    // Cache the mask.
-    
-    const uint8_t mask = m.at( E::_MASK );
-    
-    // Find something (other than NONE and MASK) that matches the
-    // bits.
+  typename F::key_type _read_map( const F& f,
+				  const uint8_t& reg ) const noexcept {
     
-    for( const auto& i : m )
-      if(( i.first != E::_NONE ) && ( i.first != E::_MASK ))
-	if(( reg & mask ) == i.second ) {
-	  e_type = i.first;
-	  break;
-	}
+    const typename F::key_type e_type = f.decode( reg );
     
-    // "NONE" indicates whatever was sought isn't in the map and is,
+    // "NONE" indicates whatever was sought isn't in the table and is,
     // therefore, a failure condition, since functions are strongly
     // typed, it's a private enumeration, and shouldn't be a possible
     // passed value.
     
-    assert( e_type != E::_NONE );
+    assert( e_type != F::key_type::_NONE );
     
     return e_type;
   }
   
-  template< typename E >
+  template< typename F >
   inline
-  E _read_map_cfg( const std::map< E, uint8_t >& m ) const noexcept {
+  typename F::key_type _read_map_cfg( const F& f ) const noexcept {
     
-    return _read_map< E >( m, myConfigReg );
+    return _read_map( f, uint8_t( _shadow_get( SH_CFG )));
   }
   
-  template< typename E >
+  template< typename F >
   inline
-  int32_t _write_map_cfg( const E& e, const std::map< E, uint8_t >& m ) {
+  int32_t _write_map_cfg( const typename F::key_type& e, const F& f ) {
     
-    // Turn the bits off.
+    // Turn the bits off then, based on the enumeration, set bits on.
     
-    myConfigReg &= ~m.at( E::_MASK );
-    
-    // Based on the enumeration, set bits on.
-    
-    typename std::map< E, uint8_t >::const_iterator it = m.find( e );
-    
-    if( it != m.end()) 
-      myConfigReg |= it->second;
-    
-    int32_t rVal = _write_cfg();
+    int32_t rVal = _shadow_set( SH_CFG, f.mask, f.encode( e ));
     
     if( rVal < 0 )
       _LOG_WARN(( _id( "Unable to write to configuration register" ),
@@ -519,29 +527,20 @@ private:
     return rVal;
   }
   
-  template< typename E >
+  template< typename F >
   inline
-  E _read_map_le( const std::map< E, uint8_t >& m ) const noexcept {
+  typename F::key_type _read_map_le( const F& f ) const noexcept {
     
-    return _read_map< E >( m, myLightingEffectReg );
+    return _read_map( f, uint8_t( _shadow_get( SH_LE )));
   }
   
-  template< typename E >
+  template< typename F >
   inline
-  int32_t _write_map_le( const E& e, const std::map< E, uint8_t >& m ) {
-    
-    // Turn the bits off.
-    
-    myLightingEffectReg &= ~m.at( E::_MASK );
+  int32_t _write_map_le( const typename F::key_type& e, const F& f ) {
     
-    // Based on the enumeration, set bits on.
+    // Turn the bits off then, based on the enumeration, set bits on.
     
-    typename std::map< E, uint8_t >::const_iterator it = m.find( e );
-    
-    if( it != m.end())
-      myLightingEffectReg |= it->second;
-    
-    int32_t rVal = _write_le();
+    int32_t rVal = _shadow_set( SH_LE, f.mask, f.encode( e ));
     
     if( rVal < 0 )
       _LOG_WARN(( _id( "Unable to write to lighting effect register" ),
@@ -565,7 +564,23 @@ inline
 const uint8_t
 is31fl3730::pwm( void ) const noexcept {
   
-  return myPwmReg;
+  return uint8_t( _shadow_get( SH_PWM ));
+}
+
+
+inline
+uint64_t
+is31fl3730::bytes_written( void ) const noexcept {
+
+  return myBytesWritten;
+}
+
+
+inline
+uint64_t
+is31fl3730::bytes_saved( void ) const noexcept {
+
+  return myBytesSaved;
 }
 
 
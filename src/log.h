@@ -134,6 +134,10 @@ std::string _log_interface( const T& firstArg, Types... args ) {
   return stre.str();
 }
 
+// The current logging level (see opts.h).
+
+extern int logging_level;
+
 // This is the function responsible for the actual logging. It is
 // meant to be a hidden interface.
 
@@ -150,17 +154,26 @@ _log( const char* file, const char* func, int line, int lvl,
 // These are logging messages conceptually built like syslog() except
 // that I shortened WARNING label and ABORT/ALERT exits the
 // application. 
+//
+// The debug and verbose messages are tested against the logging level
+// *before* the message is built. Those messages are sprinkled through
+// the i2c paths and building them costs several heap allocations per
+// bus transaction even when nothing is output.
 
 #ifdef _DPG_DEBUG
-#define _LOG_DEBUG(x)  _log(__FILE__, __FUNCTION__, __LINE__, \
-			    LOG_DEBUG, _log_interface x )
+#define _LOG_DEBUG(x)  do { if( _IS_LOG_DEBUG )			\
+			      _log(__FILE__, __FUNCTION__, __LINE__,	\
+				   LOG_DEBUG, _log_interface x );	\
+			  } while( 0 )
 #else
 #define _LOG_DEBUG(x)
 #endif
 
 #ifdef _DPG_DEBUG_VERBOSE
-#define _LOG_VERB(x)  _log(__FILE__, __FUNCTION__, __LINE__,  \
-			   LOG_VERB, _log_interface x )
+#define _LOG_VERB(x)  do { if( _IS_LOG_VERB )			\
+			     _log(__FILE__, __FUNCTION__, __LINE__,	\
+				  LOG_VERB, _log_interface x );		\
+			 } while( 0 )
 #else
 #define _LOG_VERB(x)
 #endif
@@ -192,6 +192,7 @@ extern "C" {
 }
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <fstream>
@@ -208,21 +209,35 @@ extern "C" {
 #include <vector>
 
 #include "ads1015.h"
+#include "arbiter.h"
+#include "gpio.h"
 #include "si7021.h"
 #include "microdotphat.h"
 #include "log.h"
 #include "opts.h"
 #include "i2c.h"
+#include "sim.h"
 #include "templates.h"
 
 
 static const std::string main_ident = "$Id: main.cc,v 1.35 2019/10/23 03:54:00 root Exp root $";
 
 
-// Since this code is multi-threaded the i2c bus must locked for each
-// transaction.
+// Since this code is multi-threaded the i2c bus is owned by an
+// arbiter and bus I/O is submitted to it as jobs. See arbiter.h.
 
-std::mutex i2c_bus;
+
+// On the simulated bus time runs simSpeed times faster than real
+// time, so the loops sleep that much less. On the hardware simSpeed
+// is one.
+
+template< typename D >
+static std::chrono::microseconds
+scaled( const D d ) {
+
+  return std::chrono::duration_cast< std::chrono::microseconds >
+    ( d / simSpeed );
+}
 
 
 // Where the PID file is cached.
@@ -252,6 +267,12 @@ std::atomic< float >  MQ2ppm(0), MQ3mgl(0), MQ4ppm(0),
                       Vdd( 0 );
 std::condition_variable MQcv;
 
+// The gas sensors in alarm (see the -a option), a bit per sensor in
+// the sampler's sensor map order. MQcv is signaled as soon as one
+// changes.
+
+std::atomic< uint32_t > MQalarms( 0 );
+
 
 // These are the two ADS1015 A/D converters. They are connected as
 // follows:
@@ -265,12 +286,28 @@ std::condition_variable MQcv;
 // ad2, input 2 - GND
 // ad2, input 3 - Vdd
 
-ads1015 ad1, ad2( 0x48 );
+//
+// The devices are constructed in main() once the options are parsed
+// and the buses discovered rather than during static
+// initialization.
+
+std::unique_ptr< ads1015 > ad1, ad2;
+
 
+// This is the temperature/humidity sensor and the cache of its
+// measurements. The sampler refreshes the cache every thPeriod
+// seconds and readers accept measurements up to two periods old, so
+// only the sampler uses the bus for it unless the sampler falls
+// behind.
 
-// This is the temperature/humidity sensor.
+std::unique_ptr< si7021 >       th;
+std::unique_ptr< si7021_cache > th_cache;
 
-si7021 th;
+static std::chrono::microseconds
+th_max_age( void ) {
+
+  return scaled( std::chrono::duration< double >( 2 * thPeriod ));
+}
 
 
 // Do this when the program exists. It's just a little house
@@ -332,14 +369,20 @@ exit_signal_handler( int sig ) {
 // in this one place.
 
 const std::string
-sensor_line( void ) {
+sensor_line( const arbiter::PRIORITY p ) {
+
+  std::stringstream ss;
 
-  std::stringstream              ss;
-  std::unique_lock< std::mutex > lck( i2c_bus );
+  // Only the temperature and humidity might be bus I/O, when the
+  // cached measurement is stale.
+
+  const si7021::measurement m = th_cache->get( th_max_age(), p );
+  const float               t = m.t;
+  const float               h = m.h;
 
   ss << std::fixed << std::setprecision(2)
-     << "t=" << roundz( th.t(), 2 ) << " "
-     << "h=" << roundz( th.h(), 2 ) << "  "
+     << "t=" << roundz( t, 2 ) << " "
+     << "h=" << roundz( h, 2 ) << "  "
      << std::fixed << std::setprecision(3)
      << "MQ2=" << MQ2ppm.load() << " "
      << "MQ3=" << MQ3mgl.load() << " "
@@ -353,6 +396,50 @@ sensor_line( void ) {
 }
 
 
+// Like the sensor line, the bus health is logged every minute and at
+// exit: reads that failed the device's checksum, per priority how
+// many jobs waited for the bus, for how long on average, and the
+// longest, and per A/D the same for conversions from ready (see -g)
+// to read.
+
+const std::string
+stats_line( void ) {
+
+  static const std::map< arbiter::PRIORITY, const char* > prio_names {
+    { arbiter::PRIORITY::SAMPLER, "sampler" },
+    { arbiter::PRIORITY::MUNIN,   "munin"   },
+    { arbiter::PRIORITY::DISPLAY, "display" }
+  };
+
+  std::stringstream ss;
+
+  ss << "crc_errors=" << i2c::crc_errors();
+
+  for( const auto& [p,n] : prio_names ) {
+
+    const arbiter::stats w = arbiter::get( ad1->bus()).wait( p );
+
+    ss << " " << n << "_wait="
+       << w.count << "/" << ( w.count ? ( w.total.count() / w.count ) : 0 )
+       << "/" << w.max.count() << "us";
+
+  }
+
+  for( const auto& [ad,n] : { std::make_pair( ad1.get(), "ad1" ),
+			      std::make_pair( ad2.get(), "ad2" ) } ) {
+
+    const ads1015::latency l = ad->ready_latency();
+
+    ss << " " << n << "_ready="
+       << l.count << "/" << ( l.count ? ( l.total.count() / l.count ) : 0 )
+       << "/" << l.max.count() << "us";
+
+  }
+
+  return ss.str();
+}
+
+
 // This template is used in a thread responsible for updating the MQ
 // sensor atomics. That thread smooths the A/D values through a
 // running average to minimize power supply spikes. Specifically, some
@@ -372,6 +459,22 @@ sensor( const F X0, const F F0,
 }
 
 
+// The reverse of sensor(): the voltage at which a sensor reads a
+// value. Whether the sensor's voltage rises or falls with its value
+// is the slope's sign.
+
+template< typename F >
+F
+sensor_volts( const F X0, const F F0,
+	      const F X1, const F F1,
+	      const F value ) {
+
+  const F slope = std::log10( F1 / F0 ) / std::log10( X1 / X0 );
+
+  return X0 * std::pow(( value / F0 ), 1 / slope );
+}
+
+
 void
 MQx_update_sensor_thread( void ) {
 
@@ -384,47 +487,189 @@ MQx_update_sensor_thread( void ) {
   // The index into the map is a sensor identifier - an enumerated
   // type. The values are the sensor's name, running accumulator, N
   // prior samples, and A/D information.
+  //
+  // The samples are the A/D's raw codes and the accumulator their
+  // integer sum, so the running sum stays exact however long the
+  // daemon runs. Codes become volts only when a value is published.
   
   enum class QUE { MQ2, MQ3, MQ4, MQ6, MQ7, MQ9, Vdd };
+
+#define SMOOTH_LEN 32
   
   std::map
     < QUE, std::tuple
-      < std::string,         // Printable name
-	float,               // Accumulator
-	std::queue< float >, // Samples queue
-	ads1015::CREG,       // Which register to find the sample
-	int                  // Which A/D (1 or 2)
+      < std::string,                         // Printable name
+	int32_t,                             // Accumulator
+	std::array< int16_t, SMOOTH_LEN >,   // Samples, circular
+	size_t,                              // Samples taken
+	ads1015::CREG,                       // Which register to find the sample
+	int                                  // Which A/D (1 or 2)
 	>
       > sensor_map;
 #define SENSOR_NAME(x) std::get<0>(x)
 #define SENSOR_ACC(x)  std::get<1>(x)
 #define SENSOR_QUE(x)  std::get<2>(x)
-#define SENSOR_REG(x)  std::get<3>(x)
-#define SENSOR_AD(x)   std::get<4>(x)
-  
-#define SMOOTH_LEN 32
+#define SENSOR_CNT(x)  std::get<3>(x)
+#define SENSOR_REG(x)  std::get<4>(x)
+#define SENSOR_AD(x)   std::get<5>(x)
+
+  // The supply the sensors' voltages are compensated against.
+
+  constexpr float expected_full_scale = 5.0;
+
+  // Each gas sensor's calibration, two points on its log-log plot
+  // (see sensor()), and where its value goes.
+
+  struct calibration {
+    float                 X0, F0, X1, F1;
+    std::atomic< float >* value;
+  };
+
+  const std::map< QUE, calibration > calib {
+    { QUE::MQ2, { 1000.0, 0.8,   200.0, 1.7, &MQ2ppm }},
+    { QUE::MQ3, {    0.1, 2.25,    1.0, 0.53, &MQ3mgl }},
+    { QUE::MQ4, { 1000.0, 1.0,   200.0, 1.8, &MQ4ppm }},
+    { QUE::MQ6, { 1000.0, 1.0,   200.0, 2.1, &MQ6ppm }},
+    { QUE::MQ7, { 1000.0, 0.225,  36.0, 1.8, &MQ7ppm }},
+    { QUE::MQ9, { 1000.0, 1.0,   200.0, 2.1, &MQ9ppm }}
+  };
 
   // Initialize the sensor map.
   
-  sensor_map[ QUE::MQ2 ] = { "MQ2", 0.0, std::queue< float >(),
+  sensor_map[ QUE::MQ2 ] = { "MQ2", 0, {}, 0,
                              ads1015::CREG::CHAN0, 1 };
-  sensor_map[ QUE::MQ3 ] = { "MQ3", 0.0, std::queue< float >(),
+  sensor_map[ QUE::MQ3 ] = { "MQ3", 0, {}, 0,
 			     ads1015::CREG::CHAN1, 1 };
-  sensor_map[ QUE::MQ4 ] = { "MQ4", 0.0, std::queue< float >(),
+  sensor_map[ QUE::MQ4 ] = { "MQ4", 0, {}, 0,
 			     ads1015::CREG::CHAN2, 1 };
-  sensor_map[ QUE::MQ6 ] = { "MQ6", 0.0, std::queue< float >(),
+  sensor_map[ QUE::MQ6 ] = { "MQ6", 0, {}, 0,
 			     ads1015::CREG::CHAN3, 1 };
-  sensor_map[ QUE::MQ7 ] = { "MQ7", 0.0, std::queue< float >(),
+  sensor_map[ QUE::MQ7 ] = { "MQ7", 0, {}, 0,
 			     ads1015::CREG::CHAN0, 2 };
-  sensor_map[ QUE::MQ9 ] = { "MQ9", 0.0, std::queue< float >(),
+  sensor_map[ QUE::MQ9 ] = { "MQ9", 0, {}, 0,
 			     ads1015::CREG::CHAN1, 2 };
-  sensor_map[ QUE::Vdd ] = { "Vdd", 0.0, std::queue< float >(),
+  sensor_map[ QUE::Vdd ] = { "Vdd", 0, {}, 0,
                              ads1015::CREG::CHAN3, 2 };
 
+  // Which sensors are on which A/D, in sensor map order, and where
+  // their samples go. The A/Ds are sampled as a group.
+
+  std::vector< QUE > ad1_ids, ad2_ids;
+
+  for( const auto& [id,m] : sensor_map )
+    if( SENSOR_AD( m ) == 1 )
+      ad1_ids.push_back( id );
+    else
+      if( SENSOR_AD( m ) == 2 )
+	ad2_ids.push_back( id );
+      else
+	_LOG_ABORT(( "Impossible state" ));
+
+  std::array< int16_t, int( QUE::Vdd ) + 1 > samps;
+  ads1015_group                            adcs;
+  std::vector< std::vector< QUE >* >       adc_ids;
+  std::vector< ads1015* >                  adc_devs;
+
+  // Volts per code of each A/D, by SENSOR_AD() - 1. The gains are
+  // set before this thread starts.
+
+  const std::array< float, 2 > ad_scale { ad1->scale(), ad2->scale() };
+
+  for( auto& [ad,ids] : { std::make_pair( ad1.get(), &ad1_ids ),
+			  std::make_pair( ad2.get(), &ad2_ids ) } ) {
+
+    std::vector< ads1015::CREG > chans;
+
+    for( const auto id : *ids )
+      chans.push_back( SENSOR_REG( sensor_map[ id ] ));
+
+    adcs.add( *ad, chans );
+    adc_ids.push_back( ids );
+    adc_devs.push_back( ad );
+
+  }
+
+  // Gas alarms. Each alarm level is turned into a window of raw A/D
+  // codes through the sensor's calibration, so the A/D's window
+  // comparator and the group's check of each reading see it long
+  // before the running average does. The A/D sees uncompensated
+  // volts so the windows follow Vdd.
+
+  for( const auto& [name,level] : alarmLevels )
+    if( std::none_of( calib.cbegin(), calib.cend(), [&]( const auto& c ) {
+	  return SENSOR_NAME( sensor_map[ c.first ]) == name; }))
+      _LOG_WARN(( "No sensor for alarm ", quote( name )));
+
+  auto arm = [&]( void ) {
+
+    for( size_t d = 0; d < adcs.size(); ++d )
+      for( size_t k = 0; k < adc_ids[d]->size(); ++k ) {
+
+	const QUE  id = ( *adc_ids[d] )[k];
+	const auto a  = alarmLevels.find( SENSOR_NAME( sensor_map[ id ] ));
+	const auto c  = calib.find( id );
+
+	if(( a == alarmLevels.end()) || ( c == calib.end()))
+	  continue;
+
+	const calibration& cal = c->second;
+
+	float v = sensor_volts< float >( cal.X0, cal.F0, cal.X1, cal.F1,
+					  a->second );
+
+	if( Vdd.load() > 0.0 )
+	  v *= ( Vdd.load() / expected_full_scale );
+
+	// Whether the sensor's value rises or falls with its voltage.
+
+	const bool    rising = ( std::log10( cal.F1 / cal.F0 )
+				 / std::log10( cal.X1 / cal.X0 )) > 0;
+	const int16_t code   = adc_devs[d]->code( v );
+
+	if( rising )
+	  adcs.alarm( d, k, INT16_MIN, code );
+	else
+	  adcs.alarm( d, k, code, INT16_MAX );
+
+      }
+  };
+
+  adcs.on_alarm([&]( const size_t d, const size_t k,
+		     const ads1015::reading& r, const bool in ) {
+
+      const QUE      id  = ( *adc_ids[d] )[k];
+      const uint32_t bit = uint32_t( 1 ) << int( id );
+
+      if( in ) {
+	MQalarms |= bit;
+	_LOG_WARN(( SENSOR_NAME( sensor_map[ id ] ), " alarm, level=",
+		    alarmLevels[ SENSOR_NAME( sensor_map[ id ] )],
+		    " volts=", r.volts ));
+      } else {
+	MQalarms &= ~bit;
+	_LOG_NOTICE(( SENSOR_NAME( sensor_map[ id ] ), " alarm cleared" ));
+      }
+
+      MQcv.notify_all();
+
+    });
+
   // Run the loop every second.
   
   constexpr std::chrono::duration loop_duration = std::chrono::seconds( 1 );
 
+  // How often the A/Ds' conversion times are measured again, which
+  // tracks their oscillators' drift with temperature.
+
+  constexpr std::chrono::duration recalibrate = std::chrono::minutes( 10 );
+
+  auto next_cal = std::chrono::steady_clock::now() + recalibrate;
+
+  // When the temperature and humidity are next measured, at once to
+  // start.
+
+  auto next_th = std::chrono::steady_clock::now();
+
   while( doExit.load() == false ) {
 
     _LOG_VERB(( "Awake" ));
@@ -434,151 +679,125 @@ MQx_update_sensor_thread( void ) {
     const std::chrono::time_point<std::chrono::system_clock>
       start_tick = std::chrono::system_clock::now();
 
+    // Heap allocations made by bus I/O while sampling, counted on
+    // the arbiter's thread where the I/O runs. In steady state this
+    // MUST be zero.
+
+    size_t samp_allocs = 0;
+
+    // Time to measure the conversion times again? The sampler is the
+    // A/Ds' only user so it's safe between scans. It's bus I/O so
+    // it's a job on the bus's arbiter, a few conversions long.
+
+    if( std::chrono::steady_clock::now() >= next_cal ) {
+
+      for( auto* ad : adc_devs )
+	if( arbiter::get( ad->bus()).submit
+	    ( arbiter::PRIORITY::SAMPLER,
+	      [ad]( void ) { return ad->calibrate(); }).get() == 0 )
+	  _LOG_VERB(( "addr=", t2hex( ad->addr()),
+		      " ratio=", ad->timing().ratio,
+		      " drift=", ad->timing().drift, "ppm/h" ));
+
+      next_cal += recalibrate;
+
+    }
+
+    // Refresh the temperature and humidity cache. The bus is free
+    // during the conversion. Should the loop fall behind, the next
+    // one is a period from now rather than a burst to catch up.
+
+    if( std::chrono::steady_clock::now() >= next_th ) {
+
+      if( th_cache->sample( arbiter::PRIORITY::SAMPLER ).status != 0 )
+	_LOG_WARN(( "Temperature and humidity not sampled" ));
+
+      next_th = std::chrono::steady_clock::now()
+	+ scaled( std::chrono::duration< double >( thPeriod ));
+
+    }
+
+    // The alarm windows move with Vdd.
+
+    if( alarmLevels.size())
+      arm();
+
+    // Get the samples. The k-th channel of every A/D is converted
+    // at the same time, sharing the conversion wait, and the bus is
+    // free while this thread waits.
+
+    adcs.scan();
+
+    for( size_t d = 0; d < adcs.size(); ++d )
+      for( size_t k = 0; k < adc_ids[d]->size(); ++k ) {
+
+	const ads1015::reading& r = adcs.readings( d )[k];
+
+	samps[ int(( *adc_ids[d] )[k] )] = ( r.status == 0 ) ? r.code : 0;
+
+      }
+
+    samp_allocs = adcs.allocs();
+
     for( auto& [id,m] : sensor_map ) {
       
-      std::unique_lock< std::mutex > lck( i2c_bus );
+      const int16_t samp = samps[ int( id )];
+      int16_t&      slot = SENSOR_QUE( m )[ SENSOR_CNT( m ) % SMOOTH_LEN ];
 
-      float samp = 0.0;
+      // Replace the oldest sample, once there are enough, in the
+      // samples and accumulator.
 
-      // Get the sample.                                                      
+      if( SENSOR_CNT( m ) >= SMOOTH_LEN )
+	SENSOR_ACC( m ) -= slot;
 
-      if( SENSOR_AD( m ) == 1 ) 
-	samp = ad1[ SENSOR_REG( m )];
-      else
-	if( SENSOR_AD( m ) == 2 )
-	  samp = ad2[ SENSOR_REG( m )];
-	else
-	  _LOG_ABORT(( "Impossible state" ));
-	  
-      // Be nice to other threads wanting the i2c bus.
-      
-      lck.unlock();
-      
-      // Add the sample to the queue and accumulator.
-      
-      SENSOR_QUE( m ).push( samp );
+      slot             = samp;
       SENSOR_ACC( m ) += samp;
+      ++SENSOR_CNT( m );
       
       // Time to process samples?
       
-      if( SENSOR_QUE( m ).size() > SMOOTH_LEN ) {
-	
-	// Remove the oldest sample from the running average.
-	
-	SENSOR_ACC( m ) -= SENSOR_QUE( m ).front();
-	
-	// Delete the oldest sample from the queue.
-	  
-	SENSOR_QUE( m ).pop();
+      if( SENSOR_CNT( m ) >= SMOOTH_LEN ) {
 
-	// Calculate the voltage on the A/D input.
+	// Calculate the voltage on the A/D input, the one conversion
+	// from codes.
 
-	float volts = ( SENSOR_ACC( m ) / float( SMOOTH_LEN ));
+	const float raw_volts = float( SENSOR_ACC( m ))
+	  * ad_scale[ SENSOR_AD( m ) - 1 ] / float( SMOOTH_LEN );
+	float       volts     = raw_volts;
 
 	// If Vdd is greater than zero then compensate for full scale
 	// voltage against power supply drop.
 	
-	if( Vdd.load() > 0.0 ) {
-
-	  constexpr float expected_full_scale = 5.0;
-
+	if( Vdd.load() > 0.0 )
 	  volts *= ( expected_full_scale / Vdd.load());
 
-	}	  
 	  
 	// Now, update the global values.
-	
-	if( id == QUE::MQ2 ) {
-
-	  constexpr float
-              F0 =    0.8, F1 =   1.7,
-	      X0 = 1000.0, X1 = 200.0;
-
-	  MQ2ppm.store( sensor<float>( X0, F0, X1, F1, volts ));
-
-	  _LOG_VERB(( "X0=", X0, ",X1=", X1,
-		      ",F0=", F0 , ",F1=", F1,
-		      ",MQ2 ppm=", MQ2ppm.load()));
-	    
-	} else
-	  if( id == QUE::MQ3 ) {
-
-	    constexpr float
-	      F0 = 2.25, F1 = 0.53,
-	      X0 = 0.10, X1 = 1.0;
-	    
-	    MQ3mgl.store( sensor<float>( X0, F0, X1, F1, volts ));
-
-	    _LOG_VERB(( "X0=", X0, ",X1=", X1,
-			",F0=", F0 , ",F1=", F1,
-			",MQ3 mg/L=", MQ3mgl.load()));
-
-	  } else
-	    if( id == QUE::MQ4 ) {
-
-	      constexpr float
-		F0 =    1.0, F1 =   1.8,
-		X0 = 1000.0, X1 = 200.0;
-
-	      MQ4ppm.store( sensor<float>( X0, F0, X1, F1, volts ));
-
-	      _LOG_VERB(( "X0=", X0, ",X1=", X1,
-			  ",F0=", F0 , ",F1=", F1,
-			  ",MQ4 ppm=", MQ4ppm.load()));
-
-	    } else
-	      if( id == QUE::MQ6 ) {
-
-		constexpr float
-		  F0 =    1.0, F1 =   2.1,
-		  X0 = 1000.0,  X1 = 200.0;
-		
-		MQ6ppm.store( sensor<float>( X0, F0, X1, F1, volts ));
-
-		_LOG_VERB(( "X0=", X0, ",X1=", X1,
-			    ",F0=", F0 , ",F1=", F1,
-			    ",MQ9 ppm=", MQ6ppm.load()));
-		
-	      } else
-		if( id == QUE::MQ7 ) {
-
-		  constexpr float
-		    F0 =    0.225, F1 =   1.8,
-		    X0 = 1000.0,   X1 = 36.0;
-
-		  MQ7ppm.store( sensor<float>( X0, F0, X1, F1, volts ));
-
-		  _LOG_VERB(( "X0=", X0, ",X1=", X1,
-			      ",F0=", F0 , ",F1=", F1,
-			      ",MQ7 ppm=", MQ9ppm.load()));
-
-		} else
-		  if( id == QUE::MQ9 ) {
-
-		    constexpr float
-		      F0 =    1.00, F1 =   2.1,
-		      X0 = 1000.0,  X1 = 200.0;
-
-		    MQ9ppm.store( sensor<float>( X0, F0, X1, F1, volts ));
-
-		    _LOG_VERB(( "X0=", X0, ",X1=", X1,
-				",F0=", F0 , ",F1=", F1,
-				",MQ9 ppm=", MQ9ppm.load()));
-		    
-		  } else
-		    if( id == QUE::Vdd ) {
-
-		      // For Vdd, I don't want to record the adjusted
-		      // voltage rather the *unadjusted* voltage.
-		      
-		      Vdd.store( SENSOR_ACC( m ) / float( SMOOTH_LEN ));
-		      
-		    } else
-		      _LOG_ABORT(( "Impossible state" ));
+
+	if( id == QUE::Vdd ) {
+
+	  // For Vdd, I don't want to record the adjusted voltage rather
+	  // the *unadjusted* voltage.
+
+	  Vdd.store( raw_volts );
+
+	} else {
+
+	  const calibration& c = calib.at( id );
+
+	  c.value->store( sensor<float>( c.X0, c.F0, c.X1, c.F1, volts ));
+
+	  _LOG_VERB(( "X0=", c.X0, ",X1=", c.X1,
+		      ",F0=", c.F0 , ",F1=", c.F1,
+		      ",", SENSOR_NAME( m ), "=", c.value->load()));
+
+	}
 	
       }
     }
     
+    _LOG_VERB(( "samples=", sensor_map.size(), " allocs=", samp_allocs ));
+
     // The sensors have been update. Let anyone who wants to know,
     // know.
     
@@ -602,7 +821,7 @@ MQx_update_sensor_thread( void ) {
 		std::chrono::duration_cast
 		<std::chrono::milliseconds>( slp ).count(), "ms" ));
     
-    std::this_thread::sleep_for( slp );
+    std::this_thread::sleep_for( scaled( slp ));
 
   }
 
@@ -614,9 +833,32 @@ void
 display_update_thread( void ) {
 
   MicroDotpHAT disp;
+  arbiter&     bus = arbiter::get( disp.bus());
+
+  // Bus jobs of the display. A frame is uploaded one chip per job so
+  // the sampler can get in between chips.
+
+  auto show = [&]( void ) {
+
+    std::vector< std::future< int32_t >> f;
+
+    for( int i = 0; i < disp.num_chips(); ++i )
+      f.push_back( bus.submit( arbiter::PRIORITY::DISPLAY,
+			       [&disp,i]( void ) { return disp.show( i ); }));
+    for( auto& i : f )
+      i.get();
+
+  };
+
+  auto brightness = [&]( const int b ) {
+
+    bus.submit( arbiter::PRIORITY::DISPLAY,
+		[&disp,b]( void ) { return disp.set_brightness( b ); }).get();
+
+  };
 
   disp.clear();
-  disp.show();
+  show();
 
   // These declerations are for the display saver.
   
@@ -640,14 +882,12 @@ display_update_thread( void ) {
       start_tick = std::chrono::system_clock::now();
 
     disp.clear();
-    disp.set_brightness( 64 );
+    brightness( 64 );
     
     // Time to do the screen saver?
 
     if( saver_on ) {
 
-      std::unique_lock< std::mutex > lck( i2c_bus );
-
       if( decimal_or_col == false ) {
 
 	// Columns.
@@ -702,7 +942,6 @@ display_update_thread( void ) {
       
       static int func = 0;
 
-      std::unique_lock< std::mutex > lck( i2c_bus );
       std::stringstream ss;
       
       switch( func ) {
@@ -710,14 +949,16 @@ display_update_thread( void ) {
       case 0:
 
 	ss << "t " << std::fixed << std::setprecision(1) << std::setw( 5 )
-	   << roundz( th.t(), 1 );
+	   << roundz( th_cache->get( th_max_age(),
+				     arbiter::PRIORITY::DISPLAY ).t, 1 );
 
 	break;
 
       case 1:
 
 	ss << "h " << std::fixed << std::setprecision(1) << std::setw( 5 )
-	   << roundz( th.h(), 1 );
+	   << roundz( th_cache->get( th_max_age(),
+				     arbiter::PRIORITY::DISPLAY ).h, 1 );
 
         break;
 
@@ -778,7 +1019,7 @@ display_update_thread( void ) {
       
       disp.write_string( s.erase( dp, 1 ));
       disp.set_decimal( dp, true );
-      disp.set_brightness( 128 );
+      brightness( 128 );
       
       // Step to the next function(al) to display.
       
@@ -788,7 +1029,7 @@ display_update_thread( void ) {
 
     // Whatever happened in the display buffer, show() it.
     
-    disp.show();
+    show();
     
     // End of loop time point.
     
@@ -818,10 +1059,18 @@ display_update_thread( void ) {
                 std::chrono::duration_cast
                 <std::chrono::milliseconds>( slp ).count(), "ms" ));
     
-    std::this_thread::sleep_for( slp );
+    std::this_thread::sleep_for( scaled( slp ));
 
   }
 
+  // How much bus traffic skipping unchanged matrices saved.
+
+  const MicroDotpHAT::upload_stats u = disp.uploads();
+
+  _LOG_INFO(( "display: frames=", u.frames, " written=", u.written,
+	      " saved=", u.saved,
+	      " saved/frame=", u.frames ? ( u.saved / u.frames ) : 0 ));
+
   _LOG_VERB(( "exiting" ));
 }
 
@@ -913,7 +1162,7 @@ munin_service_thread( void ) {
 	  
 	  // Got a connection. Spit back the data and close.
 	  
-	  std::string s { sensor_line() };
+	  std::string s { sensor_line( arbiter::PRIORITY::MUNIN ) };
 
 	  s += "\n";
 	  
@@ -942,16 +1191,18 @@ main( int argc, char** argv ) {
   // Say hello.
   
   extern const std::vector< std::string >
-    ads1015_ident, is31fl3730_ident, si7021_ident, i2c_ident,
-    log_ident, microdotphat_ident, opts_ident, util_ident;
+    ads1015_ident, arbiter_ident, is31fl3730_ident, si7021_ident,
+    i2c_ident, log_ident, microdotphat_ident, opts_ident, util_ident,
+    transport_ident, sim_ident, gpio_ident;
   const std::vector< std::string > headers_ident {
     _TEMPLATES_H_ID
   };
 
   std::cout << main_ident << std::endl;
-  for( const auto& i : { ads1015_ident, is31fl3730_ident, si7021_ident,
-			  i2c_ident, microdotphat_ident, log_ident,
-			  opts_ident, util_ident })
+  for( const auto& i : { ads1015_ident, arbiter_ident, is31fl3730_ident,
+			  si7021_ident, i2c_ident, microdotphat_ident,
+			  log_ident, opts_ident, util_ident,
+			  transport_ident, sim_ident, gpio_ident })
     for( const std::string& j : i )
       std::cout <<  j << std::endl;
   for( const auto& i : headers_ident )
@@ -961,24 +1212,94 @@ main( int argc, char** argv ) {
   
   if( parse_opts( argc, argv ) == false )
     exit( -1 );
+
+  // Put the daemon on the simulated bus, if asked to, before
+  // anything opens an adapter.
+
+  std::shared_ptr< i2c_sim > sim;
+
+  if( doSimulate ) {
+
+    sim = i2c_sim::attic( simSpeed );
+
+    sim->latency( std::chrono::microseconds( simLatency ));
+    sim->fault_rate( simFaults );
+    i2c::transport( sim );
+
+    _LOG_INFO(( "Simulated i2c bus, speed=", simSpeed ));
+
+  }
+
+  // Find out which devices are on which bus once, rather than each
+  // device scanning the adapters, then make the devices. The
+  // simulated bus isn't cached because it isn't the hardware.
+
+  i2c::discover( doSimulate ? std::string() : i2c::discovery_cache );
+
+  ad1 = std::make_unique< ads1015 >();
+  ad2 = std::make_unique< ads1015 >( 0x48 );
+  th  = std::make_unique< si7021 >();
+
+  th_cache = std::make_unique< si7021_cache >( *th );
   
   // Initialize and start the A/D converters connected to the MQ
-  // sensors.
+  // sensors. Single shot since the sampler starts each conversion on
+  // a new channel, which in continuous mode would wait for the last
+  // channel's conversion to finish.
   
-  ad1.gain( ads1015::PGA_GAIN::FS_6144 );
-  ad1.mode( ads1015::MODE::CONTINUOUS );
-  ad1.rate( ads1015::SAMPLE_RATE::SR_3300 );
-  ad1.os( ads1015::OS::BEGIN );
+  ad1->gain( ads1015::PGA_GAIN::FS_6144 );
+  ad1->mode( ads1015::MODE::SINGLE_SHOT );
+  ad1->rate( ads1015::SAMPLE_RATE::SR_3300 );
+  ad1->os( ads1015::OS::BEGIN );
     
-  ad2.gain( ads1015::PGA_GAIN::FS_6144 );
-  ad2.mode( ads1015::MODE::CONTINUOUS );
-  ad2.rate( ads1015::SAMPLE_RATE::SR_3300 );
-  ad2.os( ads1015::OS::BEGIN );
+  ad2->gain( ads1015::PGA_GAIN::FS_6144 );
+  ad2->mode( ads1015::MODE::SINGLE_SHOT );
+  ad2->rate( ads1015::SAMPLE_RATE::SR_3300 );
+  ad2->os( ads1015::OS::BEGIN );
+
+  // Measure the converters' conversion times so the sampler waits as
+  // long as these converters take rather than the datasheet's worst
+  // case. The sampler recalibrates now and then.
+
+  for( auto* ad : { ad1.get(), ad2.get() })
+    if( ad->calibrate() < 0 )
+      _LOG_WARN(( "Conversion time not calibrated, addr=",
+		  t2hex( ad->addr())));
+
+  // Conversion-ready wakeup for the A/Ds with a line (-g) so the
+  // sampler wakes at their edges. An A/D with an alarm gives it up
+  // to the window comparator.
+
+  for( size_t i = 0; ( i < adcAlerts.size()) && ( i < 2 ); ++i ) {
+
+    ads1015* const                ad = ( i == 0 ) ? ad1.get() : ad2.get();
+    const auto&                   [chip,offset] = adcAlerts[i];
+    std::shared_ptr< alert_line > line;
+
+    if( chip.empty())
+      continue;
+
+    if( chip == "sim" ) {
+      if( sim )
+	line = sim->alert( ad->bus(), ad->addr());
+    } else {
+      auto g = std::make_shared< gpio_alert >( chip, offset );
+      if( g->ok())
+	line = g;
+    }
+
+    if( !line || ( ad->conv_ready( true, line ) < 0 ))
+      _LOG_WARN(( "No conversion-ready line, addr=", t2hex( ad->addr())));
+    else
+      _LOG_INFO(( "Conversion-ready line, addr=", t2hex( ad->addr()),
+		  " chip=", quote( chip ), " offset=", offset ));
+
+  }
 
   // Start the temperature and humidity sensor. The heater adds about
   // three degress to the sense, so turn it off.
   
-  th.heater( false );
+  th->heater( false );
 
   // Whether to become a daemon. Default is TRUE.
 
@@ -1112,7 +1433,8 @@ main( int argc, char** argv ) {
       // Get and output the temperature, relative humidity, and MQ
       // sensors.
       
-      _LOG_INFO(( sensor_line()));
+      _LOG_INFO(( sensor_line( arbiter::PRIORITY::MUNIN )));
+      _LOG_INFO(( stats_line()));
       
       // End of loop time point.
     
@@ -1134,7 +1456,7 @@ main( int argc, char** argv ) {
     if( loop_timer <= std::chrono::seconds( 0 ))
       loop_timer += loop_print;
       
-    std::this_thread::sleep_for( sleep_duration );
+    std::this_thread::sleep_for( scaled( sleep_duration ));
       
   }
 
@@ -1144,6 +1466,14 @@ main( int argc, char** argv ) {
   display_thread.join();
   munin_thread.join();
 
+  // Nobody is left to submit bus jobs. The final counts.
+
+  _LOG_INFO(( "t/h cache: hits=", th_cache->hits(),
+	      " misses=", th_cache->misses()));
+  _LOG_INFO(( stats_line()));
+
+  arbiter::stop_all();
+
   // A pause for the cause.
   
   std::this_thread::sleep_for( std::chrono::seconds( 1 ));
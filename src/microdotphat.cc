@@ -69,9 +69,11 @@
 extern "C" {
 
 #include <assert.h>
+#include <string.h>
 
 }
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <limits>
@@ -81,7 +83,6 @@ extern "C" {
 #include <sstream>
 #include <string>
 #include <thread>
-#include <tuple>
 #include <vector>
 
 #include "microdotphat.h"
@@ -104,6 +105,10 @@ static constexpr is31fl3730::MATRIX_REG
   m1 = is31fl3730::MATRIX_REG::MATRIX1,
   m2 = is31fl3730::MATRIX_REG::MATRIX2;
 
+// The bits of a frame buffer column that are rows.
+
+static constexpr uint8_t rows_mask = ( 1 << NUM_MICRO_DOT_PHAT_ROWS ) - 1;
+
 // Lifted from Pimoroni. The following is a copy of their license on
 // github.
 //
@@ -133,108 +138,141 @@ static constexpr is31fl3730::MATRIX_REG
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 //
-// The index into this map is an ASCII character, such as an 'e'. The
-// character maps to a vector of columns with the leftmost column the
-// zero index into the vector.
+// The font is indexed by character less font_first, ' ', through
+// font_last, '~'. Each glyph is its columns left to right, bit y
+// being row y, which is the frame buffer's layout so drawing one is
+// copying five bytes.
+
+static constexpr char font_first = ' ', font_last = '~';
+
+static constexpr
+std::array< std::array< uint8_t, NUM_VISIBLE_MICRO_DOT_PHAT_COLS >,
+	    font_last - font_first + 1 > _font {{
+  {{ 0x00, 0x00, 0x00, 0x00, 0x00 }}, // ' '
+  {{ 0x00, 0x00, 0x5f, 0x00, 0x00 }}, // '!'
+  {{ 0x00, 0x07, 0x00, 0x07, 0x00 }}, // '"'
+  {{ 0x14, 0x7f, 0x14, 0x7f, 0x14 }}, // '#'
+  {{ 0x24, 0x2a, 0x7f, 0x2a, 0x12 }}, // '$'
+  {{ 0x23, 0x13, 0x08, 0x64, 0x62 }}, // '%'
+  {{ 0x36, 0x49, 0x55, 0x22, 0x50 }}, // '&'
+  {{ 0x00, 0x05, 0x03, 0x00, 0x00 }}, // '\''
+  {{ 0x00, 0x1c, 0x22, 0x41, 0x00 }}, // '('
+  {{ 0x00, 0x41, 0x22, 0x1c, 0x00 }}, // ')'
+  {{ 0x08, 0x2a, 0x1c, 0x2a, 0x08 }}, // '*'
+  {{ 0x08, 0x08, 0x3e, 0x08, 0x08 }}, // '+'
+  {{ 0x00, 0x50, 0x30, 0x00, 0x00 }}, // ','
+  {{ 0x08, 0x08, 0x08, 0x08, 0x08 }}, // '-'
+  {{ 0x00, 0x60, 0x60, 0x00, 0x00 }}, // '.'
+  {{ 0x20, 0x10, 0x08, 0x04, 0x02 }}, // '/'
+  {{ 0x3e, 0x51, 0x49, 0x45, 0x3e }}, // '0'
+  {{ 0x00, 0x42, 0x7f, 0x40, 0x00 }}, // '1'
+  {{ 0x42, 0x61, 0x51, 0x49, 0x46 }}, // '2'
+  {{ 0x21, 0x41, 0x45, 0x4b, 0x31 }}, // '3'
+  {{ 0x18, 0x14, 0x12, 0x7f, 0x10 }}, // '4'
+  {{ 0x27, 0x45, 0x45, 0x45, 0x39 }}, // '5'
+  {{ 0x3c, 0x4a, 0x49, 0x49, 0x30 }}, // '6'
+  {{ 0x01, 0x71, 0x09, 0x05, 0x03 }}, // '7'
+  {{ 0x36, 0x49, 0x49, 0x49, 0x36 }}, // '8'
+  {{ 0x06, 0x49, 0x49, 0x29, 0x1e }}, // '9'
+  {{ 0x00, 0x36, 0x36, 0x00, 0x00 }}, // ':'
+  {{ 0x00, 0x56, 0x36, 0x00, 0x00 }}, // ';'
+  {{ 0x00, 0x08, 0x14, 0x22, 0x41 }}, // '<'
+  {{ 0x14, 0x14, 0x14, 0x14, 0x14 }}, // '='
+  {{ 0x41, 0x22, 0x14, 0x08, 0x00 }}, // '>'
+  {{ 0x02, 0x01, 0x51, 0x09, 0x06 }}, // '?'
+  {{ 0x32, 0x49, 0x79, 0x41, 0x3e }}, // '@'
+  {{ 0x7e, 0x11, 0x11, 0x11, 0x7e }}, // 'A'
+  {{ 0x7f, 0x49, 0x49, 0x49, 0x36 }}, // 'B'
+  {{ 0x3e, 0x41, 0x41, 0x41, 0x22 }}, // 'C'
+  {{ 0x7f, 0x41, 0x41, 0x22, 0x1c }}, // 'D'
+  {{ 0x7f, 0x49, 0x49, 0x49, 0x41 }}, // 'E'
+  {{ 0x7f, 0x09, 0x09, 0x01, 0x01 }}, // 'F'
+  {{ 0x3e, 0x41, 0x41, 0x51, 0x32 }}, // 'G'
+  {{ 0x7f, 0x08, 0x08, 0x08, 0x7f }}, // 'H'
+  {{ 0x00, 0x41, 0x7f, 0x41, 0x00 }}, // 'I'
+  {{ 0x20, 0x40, 0x41, 0x3f, 0x01 }}, // 'J'
+  {{ 0x7f, 0x08, 0x14, 0x22, 0x41 }}, // 'K'
+  {{ 0x7f, 0x40, 0x40, 0x40, 0x40 }}, // 'L'
+  {{ 0x7f, 0x02, 0x04, 0x02, 0x7f }}, // 'M'
+  {{ 0x7f, 0x04, 0x08, 0x10, 0x7f }}, // 'N'
+  {{ 0x3e, 0x41, 0x41, 0x41, 0x3e }}, // 'O'
+  {{ 0x7f, 0x09, 0x09, 0x09, 0x06 }}, // 'P'
+  {{ 0x3e, 0x41, 0x51, 0x21, 0x5e }}, // 'Q'
+  {{ 0x7f, 0x09, 0x19, 0x29, 0x46 }}, // 'R'
+  {{ 0x46, 0x49, 0x49, 0x49, 0x31 }}, // 'S'
+  {{ 0x01, 0x01, 0x7f, 0x01, 0x01 }}, // 'T'
+  {{ 0x3f, 0x40, 0x40, 0x40, 0x3f }}, // 'U'
+  {{ 0x1f, 0x20, 0x40, 0x20, 0x1f }}, // 'V'
+  {{ 0x7f, 0x20, 0x18, 0x20, 0x7f }}, // 'W'
+  {{ 0x63, 0x14, 0x08, 0x14, 0x63 }}, // 'X'
+  {{ 0x03, 0x04, 0x78, 0x04, 0x03 }}, // 'Y'
+  {{ 0x61, 0x51, 0x49, 0x45, 0x43 }}, // 'Z'
+  {{ 0x00, 0x00, 0x7f, 0x41, 0x41 }}, // '['
+  {{ 0x02, 0x04, 0x08, 0x10, 0x20 }}, // '\\'
+  {{ 0x41, 0x41, 0x7f, 0x00, 0x00 }}, // ']'
+  {{ 0x04, 0x02, 0x01, 0x02, 0x04 }}, // '^'
+  {{ 0x40, 0x40, 0x40, 0x40, 0x40 }}, // '_'
+  {{ 0x00, 0x01, 0x02, 0x04, 0x00 }}, // '`'
+  {{ 0x20, 0x54, 0x54, 0x54, 0x78 }}, // 'a'
+  {{ 0x7f, 0x48, 0x44, 0x44, 0x38 }}, // 'b'
+  {{ 0x38, 0x44, 0x44, 0x44, 0x20 }}, // 'c'
+  {{ 0x38, 0x44, 0x44, 0x48, 0x7f }}, // 'd'
+  {{ 0x38, 0x54, 0x54, 0x54, 0x18 }}, // 'e'
+  {{ 0x08, 0x7e, 0x09, 0x01, 0x02 }}, // 'f'
+  {{ 0x08, 0x14, 0x54, 0x54, 0x3c }}, // 'g'
+  {{ 0x7f, 0x08, 0x04, 0x04, 0x78 }}, // 'h'
+  {{ 0x00, 0x44, 0x7d, 0x40, 0x00 }}, // 'i'
+  {{ 0x20, 0x40, 0x44, 0x3d, 0x00 }}, // 'j'
+  {{ 0x00, 0x7f, 0x10, 0x28, 0x44 }}, // 'k'
+  {{ 0x00, 0x41, 0x7f, 0x40, 0x00 }}, // 'l'
+  {{ 0x7c, 0x04, 0x18, 0x04, 0x78 }}, // 'm'
+  {{ 0x7c, 0x08, 0x04, 0x04, 0x78 }}, // 'n'
+  {{ 0x38, 0x44, 0x44, 0x44, 0x38 }}, // 'o'
+  {{ 0x7c, 0x14, 0x14, 0x14, 0x08 }}, // 'p'
+  {{ 0x08, 0x14, 0x14, 0x18, 0x7c }}, // 'q'
+  {{ 0x7c, 0x08, 0x04, 0x04, 0x08 }}, // 'r'
+  {{ 0x48, 0x54, 0x54, 0x54, 0x20 }}, // 's'
+  {{ 0x04, 0x3f, 0x44, 0x40, 0x20 }}, // 't'
+  {{ 0x3c, 0x40, 0x40, 0x20, 0x7c }}, // 'u'
+  {{ 0x1c, 0x20, 0x40, 0x20, 0x1c }}, // 'v'
+  {{ 0x3c, 0x40, 0x30, 0x40, 0x3c }}, // 'w'
+  {{ 0x44, 0x28, 0x10, 0x28, 0x44 }}, // 'x'
+  {{ 0x0c, 0x50, 0x50, 0x50, 0x3c }}, // 'y'
+  {{ 0x44, 0x64, 0x54, 0x4c, 0x44 }}, // 'z'
+  {{ 0x00, 0x08, 0x36, 0x41, 0x00 }}, // '{'
+  {{ 0x00, 0x00, 0x7f, 0x00, 0x00 }}, // '|'
+  {{ 0x00, 0x41, 0x36, 0x08, 0x00 }}, // '}'
+  {{ 0x08, 0x08, 0x2a, 0x1c, 0x08 }}, // '~'
+}};
+
+// The font transposed at compile time into matrix 1's layout: a
+// byte per row, bit x being column x.
+
+static constexpr
+std::array< std::array< uint8_t, NUM_MICRO_DOT_PHAT_ROWS >, _font.size()>
+_font_rows_of( void ) {
+
+  std::array< std::array< uint8_t, NUM_MICRO_DOT_PHAT_ROWS >,
+	      _font.size()> rVal {};
+
+  for( size_t c = 0; c < _font.size(); ++c ) {
+
+    uint64_t t = 0;
+
+    for( size_t x = 0; x < _font[ c ].size(); ++x )
+      t |= uint64_t( _font[ c ][ x ] ) << ( 8 * x );
+
+    t = _transpose8x8( t );
+
+    for( size_t y = 0; y < rVal[ c ].size(); ++y )
+      rVal[ c ][ y ] = uint8_t( t >> ( 8 * y ));
 
-static const std::map< const u_int,
-		       const std::vector< uint8_t >> _font {
-  { ' ',  { 0x00, 0x00, 0x00, 0x00, 0x00 }},
-  { '!',  { 0x00, 0x00, 0x5f, 0x00, 0x00 }},
-  { '"',  { 0x00, 0x07, 0x00, 0x07, 0x00 }},
-  { '#',  { 0x14, 0x7f, 0x14, 0x7f, 0x14 }},
-  { '$',  { 0x24, 0x2a, 0x7f, 0x2a, 0x12 }},
-  { '%',  { 0x23, 0x13, 0x08, 0x64, 0x62 }},
-  { '&',  { 0x36, 0x49, 0x55, 0x22, 0x50 }},
-  { '\'', { 0x00, 0x05, 0x03, 0x00, 0x00 }},
-  { '(',  { 0x00, 0x1c, 0x22, 0x41, 0x00 }},
-  { ')',  { 0x00, 0x41, 0x22, 0x1c, 0x00 }},
-  { '*',  { 0x08, 0x2a, 0x1c, 0x2a, 0x08 }},
-  { '+',  { 0x08, 0x08, 0x3e, 0x08, 0x08 }},
-  { ',',  { 0x00, 0x50, 0x30, 0x00, 0x00 }},
-  { '-',  { 0x08, 0x08, 0x08, 0x08, 0x08 }},
-  { '.',  { 0x00, 0x60, 0x60, 0x00, 0x00 }},
-  { '/',  { 0x20, 0x10, 0x08, 0x04, 0x02 }},
-  { '0',  { 0x3e, 0x51, 0x49, 0x45, 0x3e }},
-  { '1',  { 0x00, 0x42, 0x7f, 0x40, 0x00 }},
-  { '2',  { 0x42, 0x61, 0x51, 0x49, 0x46 }},
-  { '3',  { 0x21, 0x41, 0x45, 0x4b, 0x31 }},
-  { '4',  { 0x18, 0x14, 0x12, 0x7f, 0x10 }},
-  { '5',  { 0x27, 0x45, 0x45, 0x45, 0x39 }},
-  { '6',  { 0x3c, 0x4a, 0x49, 0x49, 0x30 }},
-  { '7',  { 0x01, 0x71, 0x09, 0x05, 0x03 }},
-  { '8',  { 0x36, 0x49, 0x49, 0x49, 0x36 }},
-  { '9',  { 0x06, 0x49, 0x49, 0x29, 0x1e }},
-  { ':',  { 0x00, 0x36, 0x36, 0x00, 0x00 }},
-  { ';',  { 0x00, 0x56, 0x36, 0x00, 0x00 }},
-  { '<',  { 0x00, 0x08, 0x14, 0x22, 0x41 }},
-  { '=',  { 0x14, 0x14, 0x14, 0x14, 0x14 }},
-  { '>',  { 0x41, 0x22, 0x14, 0x08, 0x00 }},
-  { '?',  { 0x02, 0x01, 0x51, 0x09, 0x06 }},
-  { '@',  { 0x32, 0x49, 0x79, 0x41, 0x3e }},
-  { 'A',  { 0x7e, 0x11, 0x11, 0x11, 0x7e }},
-  { 'B',  { 0x7f, 0x49, 0x49, 0x49, 0x36 }},
-  { 'C',  { 0x3e, 0x41, 0x41, 0x41, 0x22 }},
-  { 'D',  { 0x7f, 0x41, 0x41, 0x22, 0x1c }},
-  { 'E',  { 0x7f, 0x49, 0x49, 0x49, 0x41 }},
-  { 'F',  { 0x7f, 0x09, 0x09, 0x01, 0x01 }},
-  { 'G',  { 0x3e, 0x41, 0x41, 0x51, 0x32 }},
-  { 'H',  { 0x7f, 0x08, 0x08, 0x08, 0x7f }},
-  { 'I',  { 0x00, 0x41, 0x7f, 0x41, 0x00 }},
-  { 'J',  { 0x20, 0x40, 0x41, 0x3f, 0x01 }},
-  { 'K',  { 0x7f, 0x08, 0x14, 0x22, 0x41 }},
-  { 'L',  { 0x7f, 0x40, 0x40, 0x40, 0x40 }},
-  { 'M',  { 0x7f, 0x02, 0x04, 0x02, 0x7f }},
-  { 'N',  { 0x7f, 0x04, 0x08, 0x10, 0x7f }},
-  { 'O',  { 0x3e, 0x41, 0x41, 0x41, 0x3e }},
-  { 'P',  { 0x7f, 0x09, 0x09, 0x09, 0x06 }},
-  { 'Q',  { 0x3e, 0x41, 0x51, 0x21, 0x5e }},
-  { 'R',  { 0x7f, 0x09, 0x19, 0x29, 0x46 }},
-  { 'S',  { 0x46, 0x49, 0x49, 0x49, 0x31 }},
-  { 'T',  { 0x01, 0x01, 0x7f, 0x01, 0x01 }},
-  { 'U',  { 0x3f, 0x40, 0x40, 0x40, 0x3f }},
-  { 'V',  { 0x1f, 0x20, 0x40, 0x20, 0x1f }},
-  { 'W',  { 0x7f, 0x20, 0x18, 0x20, 0x7f }},
-  { 'X',  { 0x63, 0x14, 0x08, 0x14, 0x63 }},
-  { 'Y',  { 0x03, 0x04, 0x78, 0x04, 0x03 }},
-  { 'Z',  { 0x61, 0x51, 0x49, 0x45, 0x43 }},
-  { '[',  { 0x00, 0x00, 0x7f, 0x41, 0x41 }},
-  { '\\', { 0x02, 0x04, 0x08, 0x10, 0x20 }},
-  { ']',  { 0x41, 0x41, 0x7f, 0x00, 0x00 }},
-  { '^',  { 0x04, 0x02, 0x01, 0x02, 0x04 }},
-  { '_',  { 0x40, 0x40, 0x40, 0x40, 0x40 }},
-  { '`',  { 0x00, 0x01, 0x02, 0x04, 0x00 }},
-  { 'a',  { 0x20, 0x54, 0x54, 0x54, 0x78 }},
-  { 'b',  { 0x7f, 0x48, 0x44, 0x44, 0x38 }},
-  { 'c',  { 0x38, 0x44, 0x44, 0x44, 0x20 }},
-  { 'd',  { 0x38, 0x44, 0x44, 0x48, 0x7f }},
-  { 'e',  { 0x38, 0x54, 0x54, 0x54, 0x18 }},
-  { 'f',  { 0x08, 0x7e, 0x09, 0x01, 0x02 }},
-  { 'g',  { 0x08, 0x14, 0x54, 0x54, 0x3c }},
-  { 'h',  { 0x7f, 0x08, 0x04, 0x04, 0x78 }},
-  { 'i',  { 0x00, 0x44, 0x7d, 0x40, 0x00 }},
-  { 'j',  { 0x20, 0x40, 0x44, 0x3d, 0x00 }},
-  { 'k',  { 0x00, 0x7f, 0x10, 0x28, 0x44 }},
-  { 'l',  { 0x00, 0x41, 0x7f, 0x40, 0x00 }},
-  { 'm',  { 0x7c, 0x04, 0x18, 0x04, 0x78 }},
-  { 'n',  { 0x7c, 0x08, 0x04, 0x04, 0x78 }},
-  { 'o',  { 0x38, 0x44, 0x44, 0x44, 0x38 }},
-  { 'p',  { 0x7c, 0x14, 0x14, 0x14, 0x08 }},
-  { 'q',  { 0x08, 0x14, 0x14, 0x18, 0x7c }},
-  { 'r',  { 0x7c, 0x08, 0x04, 0x04, 0x08 }},
-  { 's',  { 0x48, 0x54, 0x54, 0x54, 0x20 }},
-  { 't',  { 0x04, 0x3f, 0x44, 0x40, 0x20 }},
-  { 'u',  { 0x3c, 0x40, 0x40, 0x20, 0x7c }},
-  { 'v',  { 0x1c, 0x20, 0x40, 0x20, 0x1c }},
-  { 'w',  { 0x3c, 0x40, 0x30, 0x40, 0x3c }},
-  { 'x',  { 0x44, 0x28, 0x10, 0x28, 0x44 }},
-  { 'y',  { 0x0c, 0x50, 0x50, 0x50, 0x3c }},
-  { 'z',  { 0x44, 0x64, 0x54, 0x4c, 0x44 }},
-  { '{',  { 0x00, 0x08, 0x36, 0x41, 0x00 }},
-  { '|',  { 0x00, 0x00, 0x7f, 0x00, 0x00 }},
-  { '}',  { 0x00, 0x41, 0x36, 0x08, 0x00 }},
-  { '~',  { 0x08, 0x08, 0x2a, 0x1c, 0x08 }} 
-};
+  }
+
+  return rVal;
+}
+
+static constexpr auto _font_rows = _font_rows_of();
 
 // Tiny numbers are horizontal.
 
@@ -257,20 +295,12 @@ static const std::map< const u_int,
 #define DISPLAY_RIGHT_ADDR 0x61
 
 
-// Access the elements within the POS data structure.
-
-#define POS_DIGIT(x)  std::get<0>(x)
-#define POS_ARRAY(x)  std::get<1>(x)
-#define POS_MATRIX(x) std::get<2>(x)
-#define POS_X(x)      std::get<3>(x)
-#define POS_Y(x)      std::get<4>(x)
-
-
 MicroDotpHAT::MicroDotpHAT( void )
   : myLeft(   new is31fl3730( DISPLAY_LEFT_ADDR   )),
     myMiddle( new is31fl3730( DISPLAY_MIDDLE_ADDR )),
     myRight(  new is31fl3730( DISPLAY_RIGHT_ADDR  )),
-    myMirror( false ), myRotate( false ) {
+    myMirror( false ), myRotate( false ), myCols{}, myDecimals( 0 ),
+    myFrames( 0 ) {
 
   _doInit();
   _check();
@@ -282,7 +312,8 @@ MicroDotpHAT::~MicroDotpHAT( void ) {}
 
 MicroDotpHAT::MicroDotpHAT( MicroDotpHAT& mdp )
   : myLeft( mdp.myLeft ), myMiddle( mdp.myMiddle ), myRight( mdp.myRight ),
-    myMirror( mdp.myMirror ), myRotate( mdp.myRotate ) {
+    myMirror( mdp.myMirror ), myRotate( mdp.myRotate ), myCols{},
+    myDecimals( 0 ), myFrames( 0 ) {
 
   _doInit();
 }
@@ -298,6 +329,9 @@ MicroDotpHAT::operator=( MicroDotpHAT& mdp ) {
   myMirror = mdp.myMirror;
   myRotate = mdp.myRotate;
 
+  myCols     = mdp.myCols;
+  myDecimals = mdp.myDecimals;
+
   return *this;
 }
 
@@ -319,6 +353,10 @@ MicroDotpHAT::_doInit( void ) noexcept {
   assert( myLeft.get() && myMiddle.get() && myRight.get());
 
   for( auto& i : { myLeft.get(), myMiddle.get(), myRight.get() }) {
+
+    // Configure in the shadow then write each register once.
+
+    i->shadow( i2c::SHADOW::DEFERRED );
     
     i->pwm(          127                                 );
     i->row_current(  is31fl3730::ROW_CURRENT::mA_35 );
@@ -332,6 +370,8 @@ MicroDotpHAT::_doInit( void ) noexcept {
     
     i->display_on( true );
 
+    i->shadow( i2c::SHADOW::WRITE_THROUGH );
+
     i->update();
     
   }
@@ -393,6 +433,29 @@ MicroDotpHAT::_check( void ) noexcept {
     }
   clear();
 
+  // Every glyph drawn in digit 0 (matrix 2) and digit 1 (matrix 1)
+  // renders as the font and as the transposed font.
+
+  static_assert( _font[ '1' - font_first ][ 2 ] == 0x7f );
+  static_assert( _font_rows[ '1' - font_first ][ 0 ] == 0x04 );
+  static_assert( _font_rows[ '1' - font_first ][ 1 ] == 0x06 );
+  static_assert( _font_rows[ '1' - font_first ][ 6 ] == 0x0e );
+
+  for( char c = font_first; c <= font_last; ++c ) {
+
+    write_char( c, 0, 0 );
+    write_char( c, num_cols_per_digit(), 0 );
+    _render( 0 );
+
+    for( size_t x = 0; x < _font[ c - font_first ].size(); ++x )
+      assert( myLeft->matrix( m2 )[ x ] == _font[ c - font_first ][ x ] );
+    for( size_t y = 0; y < _font_rows[ c - font_first ].size(); ++y )
+      assert( myLeft->matrix( m1 )[ y ] == _font_rows[ c - font_first ][ y ] );
+
+  }
+  clear();
+  _render( 0 );
+
   _LOG_VERB(( "Data structures tests passed" ));
 #endif
   
@@ -402,17 +465,8 @@ MicroDotpHAT::_check( void ) noexcept {
 void
 MicroDotpHAT::clear( void ) noexcept {
 
-  assert( myLeft.get() && myMiddle.get() && myRight.get());
-
-  for( auto& i : { myLeft.get(), myMiddle.get(), myRight.get() }) {
-
-    i->matrix( m1 ) = zero;
-    i->matrix( m2 ) = zero;
-
-  }
-
-  for( int i = 0; i < num_digits(); ++i )
-    set_decimal( i, false );
+  myCols.fill( 0 );
+  myDecimals = 0;
 
 }
 
@@ -420,11 +474,7 @@ MicroDotpHAT::clear( void ) noexcept {
 void
 MicroDotpHAT::fill( bool on_off ) noexcept {
 
-  assert( myLeft.get() && myMiddle.get() && myRight.get());
-
-  for( int x = 0; x < num_cols(); ++x )
-    for( int y = 0; y < num_rows(); ++y )
-      set_pixel( x, y, on_off );
+  myCols.fill( on_off ? rows_mask : 0 );
 
 }
 
@@ -443,59 +493,27 @@ MicroDotpHAT::scroll( int x, int y ) noexcept {
 void
 MicroDotpHAT::scroll_horizontal( int x ) noexcept {
 
-  std::vector< uint8_t > cols;
+  // Scrolling right x is rotating the columns right x, and left x is
+  // rotating them right the rest of the way around.
 
-  // Copy out the columns.
-  
-  for( int c = 0; c < num_cols(); ++c )
-    cols.push_back( get_col( c ));
+  const int n = modulo( x, num_cols());
 
-  // Manipulate the columns.
-  
-  for( int i = 0; i < ::abs( x ); ++i )
-    if( x > 0 ) {
-      cols.insert( cols.begin(), cols.back());
-      cols.pop_back();
-    } else {
-      cols.push_back( cols.front());
-      cols.erase( cols.begin());
-    }
-  
-  // Write the columns back.
-  
-  for( int c = 0; c < num_cols(); ++c )
-    set_col( c, cols[c]);
+  std::rotate( myCols.begin(), myCols.end() - n, myCols.end());
 }
 
 
 void
 MicroDotpHAT::scroll_vertical( int y ) noexcept {
 
-  for( int i = 0; i < ::abs( y ); ++i ) 
-    for( int d = 0; d < num_digits(); ++d ) {
+  // Rows are bits so scrolling is rotating each column's seven bits
+  // right, row 1 to row 0 and row 0 to row 6, the same as above.
 
-      // Make a copy of the rows for the digit.
-      
-      std::vector< uint8_t > rows;
-      for( int r = 0; r < num_rows(); ++r )
-	rows.push_back( _get_row( d, r ));
+  const int n = modulo( y, num_rows());
+
+  if( n )
+    for( auto& c : myCols )
+      c = uint8_t(( c >> n ) | ( c << ( num_rows() - n ))) & rows_mask;
 
-      // Manipulate the row.
-      
-      if( y > 0 ) {
-	rows.push_back( rows.front());
-	rows.erase( rows.begin());
-      } else {
-	rows.insert( rows.begin(), rows.back());
-	rows.pop_back();
-      }
-
-      // Copy the scrolled row back into the digit.
-      
-      for( int r = 0; r < num_rows(); ++r )
-	_set_row( d, r, rows[r]);
-          
-    }
 }
 
 
@@ -521,237 +539,251 @@ MicroDotpHAT::set_brightness( int brightness ) noexcept {
 bool
 MicroDotpHAT::set_pixel( int x, int y, bool on_off ) noexcept {
 
-  const POS p = _calc_positions( x, y );
+  assert(( x >= 0 ) && ( x < num_cols()));
+  assert(( y >= 0 ) && ( y < num_rows()));
+
+  if( on_off )
+    myCols[ x ] |= _bit_mask( y );
+  else
+    myCols[ x ] &= ~_bit_mask( y );
 
-  if( _choose_matrix( p ) == m2 ) 
-    _set_pixel_m2( x, y, on_off );
-  else 
-    _set_pixel_m1( x, y, on_off );
-  
   return get_pixel( x, y );
 }
 
 
+bool
+MicroDotpHAT::get_pixel( int x, int y ) const noexcept {
+
+  assert(( x >= 0 ) && ( x < num_cols()));
+  assert(( y >= 0 ) && ( y < num_rows()));
+
+  return myCols[ x ] & _bit_mask( y );
+}
+
+
 const uint8_t
 MicroDotpHAT::set_col( int x, uint8_t v ) noexcept {
 
-  for( int y = 0; y < num_rows(); ++y ) 
-    set_pixel( x, y, ( _bit_mask( y ) & v ));
+  assert(( x >= 0 ) && ( x < num_cols()));
+
+  myCols[ x ] = v & rows_mask;
 
   return get_col( x );
 }
 
 
-inline
-bool
-MicroDotpHAT::_get_pixel_m2( int x, int y ) const noexcept {
+const uint8_t
+MicroDotpHAT::get_col( int x ) const noexcept {
 
-  const POS         p = _calc_positions( x, y );
-        is31fl3730* d = _choose_display( p );
+  assert(( x >= 0 ) && ( x < num_cols()));
 
-  return ( d->matrix( m2 )[ POS_X(p)] & _bit_col( POS_Y(p)));
+  return myCols[ x ];
 }
 
 
-inline
 bool
-MicroDotpHAT::_set_pixel_m2( int x, int y, bool on_off ) noexcept {
-
-  const POS         p = _calc_positions( x, y );
-        is31fl3730* d = _choose_display( p );
+MicroDotpHAT::set_decimal( int digit, bool on_off ) noexcept {
 
-  const uint8_t bit = _bit_col( POS_Y(p));
+  assert(( digit >= 0 ) && ( digit < num_digits()));
 
-  d->matrix( m2 )[ POS_X(p)] &= ~bit;
   if( on_off )
-    d->matrix( m2 )[ POS_X(p)] |= bit;
-
-  return _get_pixel_m2( x, y );
+    myDecimals |= _bit_mask( digit );
+  else
+    myDecimals &= ~_bit_mask( digit );
+	  
+  return get_decimal( digit );
 }
 
 
-inline
 bool
-MicroDotpHAT::_get_pixel_m1( int x, int y ) const noexcept {
+MicroDotpHAT::get_decimal( int digit ) const noexcept {
 
-  const POS         p = _calc_positions( x, y );
-        is31fl3730* d = _choose_display( p );
+  assert(( digit >= 0 ) && ( digit < num_digits()));
 
-  return ( d->matrix( m1 )[ POS_Y(p)] & _bit_col( POS_X(p)));
+  return myDecimals & _bit_mask( digit );
 }
 
 
-inline
-bool
-MicroDotpHAT::_set_pixel_m1( int x, int y, bool on_off ) noexcept {
+void
+MicroDotpHAT::_render( const int chip ) noexcept {
 
-  const POS         p = _calc_positions( x, y );
-        is31fl3730* d = _choose_display( p );
+  assert(( chip >= 0 ) && ( chip < num_chips()));
 
-  const uint8_t bit = _bit_col( POS_X(p));
+  is31fl3730* const chips[] { myLeft.get(), myMiddle.get(), myRight.get() };
 
-  d->matrix( m1 )[ POS_Y(p)] &= ~bit;
-  if( on_off )
-    d->matrix( m1 )[ POS_Y(p)] |= bit;
+  assert( chips[ chip ] );
 
-  return _get_pixel_m1( x, y );
-}
+  // The left digit is matrix 2, which is the frame buffer's layout:
+  // byte x is column x, bit y row y.
 
+  const int      d2 = chip * 2, d1 = d2 + 1;
+  const uint8_t* c2 = myCols.data() + d2 * num_cols_per_digit();
+  const uint8_t* c1 = myCols.data() + d1 * num_cols_per_digit();
 
-const uint8_t
-MicroDotpHAT::get_col( int x ) const noexcept {
+  std::vector< uint8_t >& a2 = chips[ chip ]->matrix( m2 );
+  std::vector< uint8_t >& a1 = chips[ chip ]->matrix( m1 );
 
-  uint8_t rVal = 0x00;
+  assert(( a2.size() >= 8 ) && ( a1.size() >= 8 ));
 
-  for( int y = 0; y < num_rows(); ++y ) 
-    if( get_pixel( x, y ))
-      rVal |= _bit_mask( y );
+  for( int x = 0; x < num_cols_per_digit(); ++x )
+    a2[ x ] = c2[ x ];
+  a2[ 7 ] = get_decimal( d2 ) ? 0x40 : 0x00;
 
-  return rVal;
-}
+  // The right digit is matrix 1, which is transposed: byte y is row
+  // y, bit x column x.
 
+  uint64_t t = 0;
 
-bool
-MicroDotpHAT::set_decimal( int digit, bool on_off ) noexcept {
+  for( int x = 0; x < num_cols_per_digit(); ++x )
+    t |= uint64_t( c1[ x ] ) << ( 8 * x );
 
-  assert( digit < num_digits());
+  t = _transpose8x8( t );
 
-  const int x = digit * num_cols_per_digit();
-  const POS p = _calc_positions( x, 0 );
+  for( int y = 0; y < 8; ++y )
+    a1[ y ] = uint8_t( t >> ( 8 * y ));
+  if( get_decimal( d1 ))
+    a1[ 6 ] |= 0x80;
 
-  if( _choose_matrix( p ) == m2 ) 
-    _set_decimal_m2( digit, on_off );
-  else 
-    _set_decimal_m1( digit, on_off );
-	  
-  return get_decimal( digit );
 }
 
 
-inline
-bool
-MicroDotpHAT::_set_decimal_m2( int digit, bool on_off ) noexcept {
+void
+MicroDotpHAT::render( void ) noexcept {
 
-  assert( digit < num_digits());
+  for( int i = 0; i < num_chips(); ++i )
+    _render( i );
 
-  const int         x = digit * num_cols_per_digit();
-  const POS         p = _calc_positions( x, 0 );
-        is31fl3730* d = _choose_display( p );
+}
 
-  d->matrix( m2 )[ 7 ] &= ~0x40;
-  if( on_off )
-    d->matrix( m2 )[ 7 ] |= 0x40;
 
-  return _get_decimal_m2( digit );
-}
+int32_t
+MicroDotpHAT::show( void ) noexcept {
+
+  assert( myLeft.get() && myMiddle.get() && myRight.get());
 
+  int32_t rVal = 0;
 
-inline
-bool
-MicroDotpHAT::_get_decimal_m2( int digit ) const noexcept {
+  // All three chips' changed matrices and update registers go out
+  // in one transaction, or none when nothing changed. The batch is
+  // kept between frames so it doesn't allocate once warm.
 
-  assert( digit < num_digits());
+  static thread_local i2c_batch b( 9 );
 
-  const int         x = digit * num_cols_per_digit();
-  const POS         p = _calc_positions( x, 0 );
-        is31fl3730* d = _choose_display( p );
+  render();
 
-  return ( d->matrix( m2 )[ 7 ] & 0x40 );
-}
+  b.clear();
+  ++myFrames;
+  
+  for( auto& i : { myLeft.get(), myMiddle.get(), myRight.get() }) 
+    if( i->update( b ) < 0 )
+      rVal = -1;
 
+  // What failed isn't on the chips, so upload everything next time.
 
-inline
-bool
-MicroDotpHAT::_set_decimal_m1( int digit, bool on_off ) noexcept {
+  if( b.size() && ( b.submit() != ssize_t( b.size()))) {
 
-  assert( digit < num_digits());
+    for( auto& i : { myLeft.get(), myMiddle.get(), myRight.get() })
+      i->matrix_invalidate();
 
-  const int         x = digit * num_cols_per_digit();
-  const POS         p = _calc_positions( x, 0 );
-        is31fl3730* d = _choose_display( p );
+    rVal = -1;
 
-  d->matrix( m1 )[ 6 ] &= ~0x80;
-  if( on_off )
-    d->matrix( m1 )[ 6 ] |= 0x80;
+  }
 
-  return _get_decimal_m1( digit );
+  return rVal;
 }
 
 
-inline
-bool
-MicroDotpHAT::_get_decimal_m1( int digit ) const noexcept {
+int32_t
+MicroDotpHAT::show( int chip ) noexcept {
 
-  assert( digit < num_digits());
+  assert(( chip >= 0 ) && ( chip < num_chips()));
 
-  const int         x = digit * num_cols_per_digit();
-  const POS         p = _calc_positions( x, 0 );
-        is31fl3730* d = _choose_display( p );
+  is31fl3730* const chips[] { myLeft.get(), myMiddle.get(), myRight.get() };
 
-  return ( d->matrix( m1 )[ 6 ] & 0x80 );
-}
+  assert( chips[ chip ] );
 
+  static thread_local i2c_batch b( 3 );
 
-bool
-MicroDotpHAT::get_decimal( int digit ) const noexcept {
+  _render( chip );
 
-  assert( digit < num_digits());
+  b.clear();
 
-  const int x = digit * num_cols_per_digit();
-  const POS p = _calc_positions( x, 0 );
+  if( chip == 0 )
+    ++myFrames;
 
-  bool rVal = false;
-  
-  if( _choose_matrix( p ) == m2 ) 
-    rVal = _get_decimal_m2( digit );
+  int32_t rVal = 0;
+
+  if( chips[ chip ]->update( b ) < 0 )
+    rVal = -1;
   else
-    rVal = _get_decimal_m1( digit );
-  
+    if( b.size() && ( b.submit() != ssize_t( b.size()))) {
+      chips[ chip ]->matrix_invalidate();
+      rVal = -1;
+    }
+
   return rVal;
 }
 
 
-bool
-MicroDotpHAT::get_pixel( int x, int y ) const noexcept {
+const MicroDotpHAT::upload_stats
+MicroDotpHAT::uploads( void ) const noexcept {
 
-  const POS     p = _calc_positions( x, y );
-        bool rVal = false;
+  upload_stats rVal { myFrames, 0, 0 };
+
+  for( auto& i : { myLeft.get(), myMiddle.get(), myRight.get() }) {
+    rVal.written += i->bytes_written();
+    rVal.saved   += i->bytes_saved();
+  }
 
-  if( _choose_matrix( p ) == m2 ) 
-    rVal = _get_pixel_m2( x, y );
-  else
-    rVal = _get_pixel_m1( x, y );
-  
   return rVal;
 }
 
 
-int32_t
-MicroDotpHAT::show( void ) noexcept {
+const int
+MicroDotpHAT::num_chips( void ) const noexcept {
 
-  assert( myLeft.get() && myMiddle.get() && myRight.get());
+  return 3;
+}
 
-  int32_t rVal = 0;
-  
-  for( auto& i : { myLeft.get(), myMiddle.get(), myRight.get() }) 
-    if( int32_t tVal; ( tVal = i->update()) < 0 )
-      rVal = tVal;
 
-  return rVal;
+const std::string&
+MicroDotpHAT::bus( void ) const noexcept {
+
+  assert( myLeft.get());
+
+  return myLeft->bus();
 }
 
 
 void
 MicroDotpHAT::write_char( char c, int x, int y ) noexcept {
 
-  assert( _font.find( c ) != _font.end());
+  assert(( c >= font_first ) && ( c <= font_last ));
+  assert(( y >= 0 ) && ( y < num_rows()));
+
+  const auto& g = _font[ c - font_first ];
+
+  // A glyph's columns are frame buffer columns so, unshifted and
+  // entirely on the display, it is copied. Otherwise it is shifted
+  // down y rows and clipped.
+
+  if(( y == 0 ) && ( x >= 0 ) && ( x + int( g.size()) <= num_cols())) {
+
+    std::copy( g.begin(), g.end(), myCols.begin() + x );
+    return;
+
+  }
+
+  const uint8_t mask = uint8_t( rows_mask << y ) & rows_mask;
+
+  for( size_t i = 0; i < g.size(); ++i ) 
+    if(( x + int( i ) >= 0 ) && (( x + int( i )) < num_cols())) {
+
+      uint8_t& col = myCols[ x + i ];
 
-  decltype( _font )::const_iterator it = _font.find( c );
+      col = ( col & ~mask ) | ( uint8_t( g[i] << y ) & mask );
 
-  for( size_t i = 0; i < it->second.size(); ++i ) 
-    for( int j = 0; j < num_cols_per_digit(); ++j )
-      if(( x + int( i )) < num_cols())
-	set_pixel( x + i, y + j, ( it->second[i] & _bit_mask( j )));
+    }
   
 }
 
@@ -761,11 +793,7 @@ MicroDotpHAT::write_string( const std::string& text,
 			    int offset_x, int offset_y,
 			    bool kerning ) noexcept {
 
-  std::vector< uint8_t > v;
-
-  for( size_t i = 0; i < text.size(); ++i )
-    v.push_back( text[i]);  
-  write_string( v, offset_x, offset_y, kerning );
+  _write_string( text.data(), text.size(), offset_x, offset_y, kerning );
 
 }
 
@@ -775,12 +803,9 @@ MicroDotpHAT::write_string( const char* text,
 			    int offset_x, int offset_y,
 			    bool kerning ) noexcept {
 
-  std::vector< uint8_t > v;
-
-  for( const char* t = text; *t; t++ )
-    v.push_back( *t );
+  assert( text );
 
-  write_string( v, offset_x, offset_y, kerning );
+  _write_string( text, ::strlen( text ), offset_x, offset_y, kerning );
   
 }
 
@@ -790,79 +815,25 @@ MicroDotpHAT::write_string( const std::vector< uint8_t >& text,
 			    int offset_x, int offset_y,
 			    bool kerning ) noexcept {
 
-  for( size_t i = 0; i < text.size(); ++i ) {
-
-    write_char( text[i], offset_x, offset_y );
-
-    offset_x += ( kerning ? num_vis_cols_per_digit() : num_cols_per_digit());
-
-  }
-
-}
-
+  _write_string( reinterpret_cast< const char* >( text.data()), text.size(),
+		 offset_x, offset_y, kerning );
 
-inline
-const MicroDotpHAT::POS
-MicroDotpHAT::_calc_positions( const int x, const int y ) const noexcept {
-
-  assert(( x >= 0 ) && ( y >= 0 ));
-  assert( y < num_rows());
-  assert( x < num_cols());
-          
-  POS rVal { x / num_cols_per_digit(), // Digit
- 	     0,                        // Array
-	     0,                        // Matrix
-	     x % num_cols_per_digit(), // X within digit
-	     y % num_rows_per_digit()  // Y within digit
-  };
-
-  POS_ARRAY( rVal )  = POS_DIGIT( rVal ) / 2;
-  POS_MATRIX( rVal ) = POS_DIGIT( rVal ) % 2;
-  
-  _LOG_VERB(( "x=", x, ",y=", y, "  digit=", POS_DIGIT( rVal ),
-	      ", array=", POS_ARRAY( rVal ), ", matrix=", POS_MATRIX( rVal ),
-	      ", x=", POS_X( rVal ), ", y=", POS_Y( rVal )));
-  
-  return rVal;
 }
 
 
-inline
-is31fl3730*
-MicroDotpHAT::_choose_display( const POS& p ) const noexcept {
-
-  if( POS_ARRAY( p ) == 0 )
-    return myLeft.get();
-  else
-    if( POS_ARRAY( p ) == 1 )
-      return myMiddle.get();
-    else
-      if( POS_ARRAY( p ) == 2 )
-        return myRight.get();
-
-  _LOG_ABORT(( "I can't get here. display=", POS_ARRAY( p )));
-
-  return nullptr;
-}
-
-
-inline
-is31fl3730::MATRIX_REG
-MicroDotpHAT::_choose_matrix( const POS& p ) const noexcept {
+void
+MicroDotpHAT::_write_string( const char* text, const size_t len,
+			     int offset_x, int offset_y,
+			     bool kerning ) noexcept {
 
-  if( POS_MATRIX( p )) 
-    return m1;
-  else
-    return m2;
+  for( size_t i = 0; i < len; ++i ) {
 
-}
+    write_char( text[i], offset_x, offset_y );
 
+    offset_x += ( kerning ? num_vis_cols_per_digit() : num_cols_per_digit());
 
-inline
-uint8_t
-MicroDotpHAT::_bit_col( int s ) const noexcept {
+  }
 
-  return _bit_shift_left( s );
 }
 
 
@@ -877,16 +848,17 @@ MicroDotpHAT::_bit_mask( int s ) const noexcept {
 uint8_t
 MicroDotpHAT::_get_row( const int digit, const int row ) const noexcept {
 
-  assert( digit < num_digits());
-  assert( row   < num_rows());
+  assert(( digit >= 0 ) && ( digit < num_digits()));
+  assert(( row   >= 0 ) && ( row   < num_rows()));
   
-  const int x = digit * num_cols_per_digit();
+  const uint8_t* c   = myCols.data() + digit * num_cols_per_digit();
+  const uint8_t  bit = _bit_mask( row );
 
   uint8_t rVal = 0;
 
-  for( int i = num_cols_per_digit(); i > 0; --i )
-    if( get_pixel( x + i - 1, row ))
-      rVal |= _bit_mask( i - 1 );
+  for( int i = 0; i < num_cols_per_digit(); ++i )
+    if( c[ i ] & bit )
+      rVal |= _bit_mask( i );
   
   return rVal;
 }
@@ -896,27 +868,22 @@ uint8_t
 MicroDotpHAT::_set_row( const int digit,
 			const int row, const uint8_t v ) noexcept {
 
-  const int x = digit * num_cols_per_digit();
+  assert(( digit >= 0 ) && ( digit < num_digits()));
+  assert(( row   >= 0 ) && ( row   < num_rows()));
+
+  uint8_t* const c   = myCols.data() + digit * num_cols_per_digit();
+  const uint8_t  bit = _bit_mask( row );
 
-  for( int i = num_cols_per_digit(); i > 0; --i ) 
-    set_pixel( x + i - 1, row, v & _bit_mask( i - 1 ));
+  for( int i = 0; i < num_cols_per_digit(); ++i )
+    if( v & _bit_mask( i ))
+      c[ i ] |= bit;
+    else
+      c[ i ] &= ~bit;
   
   return _get_row( digit, row );
 }
 
 
-std::ostream&
-operator<<( std::ostream& os, const MicroDotpHAT::POS& p ) {
-
-  os << "digit="  << POS_DIGIT(p)  << ", "
-     << "array="  << POS_ARRAY(p)  << ", "
-     << "matrix=" << POS_MATRIX(p) << ", "
-     << "(x,y)=(" << POS_X(p) << ',' << POS_Y(p) << ')';
-
-  return os;
-}
-
-
 std::ostream&
 operator<<( std::ostream& os, const MicroDotpHAT& pHAT ) {
 
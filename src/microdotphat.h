@@ -90,10 +90,10 @@ extern "C" {
   
 }
 
+#include <array>
 #include <memory>
 #include <ostream>
 #include <string>
-#include <tuple>
 #include <vector>
 
 #include "is31fl3730.h"
@@ -143,6 +143,11 @@ std::ostream& operator<<( std::ostream& os, const MicroDotpHAT& pHAT );
 // There are five columns and seven rows of lighted LEDs per
 // digit. *However*, to simplify code, *seven* columns are allocated
 // per digit.
+//
+// Drawing doesn't touch the chips' matrices. It goes to a frame
+// buffer of one byte per column, bit y being row y (matrix 2's
+// layout), and show() converts it to the chips' layouts, a copy for
+// matrix 2 and an 8x8 bit transpose for matrix 1.
 
 class MicroDotpHAT {
 
@@ -162,6 +167,18 @@ private:
   
   bool myMirror, myRotate;
 
+  // The frame buffer: a byte per column, left to right, bit y lit
+  // when row y is, and a bit per digit of the decimal points.
+
+  std::array< uint8_t,
+	      NUM_MICRO_DOT_PHAT_DIGITS * NUM_MICRO_DOT_PHAT_COLS > myCols;
+  uint8_t myDecimals;
+
+  // The number of frames shown, a frame being a show() or the
+  // show( chip ) of the first chip.
+
+  uint64_t myFrames;
+
   // Initialize the display objects.
   
   void _doInit( void ) noexcept;
@@ -290,7 +307,41 @@ public:
   bool set_pixel( int x, int y, bool on_off ) noexcept;
   bool get_pixel( int x, int y              ) const noexcept;
   
-  int32_t show( void ) noexcept;
+  // Upload the display buffer. show() uploads all three chips in
+  // one transaction whereas show( chip ) uploads one chip, 0..2
+  // (left->right), so a caller can interleave other bus work
+  // between chips. Both render() first.
+
+  //
+  // Only the matrices that changed since they were last uploaded are
+  // written, with one update register write per chip that had any,
+  // so a frame that changed nothing is no bus traffic at all.
+
+  int32_t show( void      ) noexcept;
+  int32_t show( int chip ) noexcept;
+
+  const int num_chips( void ) const noexcept;
+
+  // Convert the frame buffer into the chips' matrices without
+  // uploading them.
+
+  void render( void ) noexcept;
+
+  // The frames shown and the bytes of matrix and update register
+  // writes they made and didn't need to make, over every chip. Bytes
+  // saved per frame is saved / frames.
+
+  struct upload_stats {
+    uint64_t frames;
+    uint64_t written;
+    uint64_t saved;
+  };
+
+  const upload_stats uploads( void ) const noexcept;
+
+  // The bus the display is on.
+
+  const std::string& bus( void ) const noexcept;
 
   // Note that Japanese IS NOT supported (yet?).
   
@@ -317,44 +368,20 @@ private:
 
   // The following is internal stuff.
 
-  // Given an absolute (x,y), what does it mean?
-  
-  typedef
-  std::tuple< int,  // digit  0..5 (left->right)
-	      int,  // array  0..2 (left->right)
-	      int,  // matrix 0..1 (left->right)
-	      // The following are the (x,y) within a
-	      // matrix. Specifically, y (the row) indexes into the
-	      // matrix data and x indicates the bit within that row.
-	      int,  // x of pixel 0..7 (left->right)
-	      int   // y of pixel 0..7 (top->bottom)
-   >  POS;
-
-  const POS _calc_positions( const int x, const int y ) const noexcept;
-
-  is31fl3730* _choose_display( const POS& ) const noexcept; 
-  is31fl3730::MATRIX_REG _choose_matrix( const POS& ) const noexcept;
-
   // The bit mask is the traditional shifting of 0x01 from the right
-  // to the left however col/row may be more specific to a matrix.
+  // to the left.
   
-  uint8_t _bit_col(  int ) const noexcept;
   uint8_t _bit_mask( int ) const noexcept;
 
-  // Because setting pixels in each matrix may be different, there are
-  // two separate private sets of functions to manage bits.
-  
-  bool _set_pixel_m2( int x, int y, bool on_off )       noexcept,
-       _get_pixel_m2( int x, int y )              const noexcept,
+  // Convert the frame buffer's two digits on a chip, 0..2
+  // (left->right), into its matrices.
 
-       _set_pixel_m1( int x, int y, bool on_off )       noexcept,
-       _get_pixel_m1( int x, int y )              const noexcept,
+  void _render( const int chip ) noexcept;
 
-       _set_decimal_m2( int digit, bool on_off )       noexcept,
-       _get_decimal_m2( int digit )              const noexcept,
+  // What the write_string() functions do.
 
-       _set_decimal_m1( int digit, bool on_off )       noexcept,
-       _get_decimal_m1( int digit )              const noexcept;
+  void _write_string( const char* text, const size_t len,
+		      int offset_x, int offset_y, bool kerning ) noexcept;
 
   // Set/get a row in the indicated digit. Only the last five bits
   // (NUM_VISIBLE_MICRO_DOT_PHAT_COLS) are used. The remaining bits
@@ -370,7 +397,6 @@ private:
   // Utility friends.
 
   friend std::ostream& ::operator<<( std::ostream&, const MicroDotpHAT& );
-  friend std::ostream&   operator<<( std::ostream&, const MicroDotpHAT::POS& );
 
 };
 
@@ -457,11 +483,6 @@ MicroDotpHAT::get_brightness( void ) const noexcept {
 }
 
 
-// Helpful output operators.
-
-std::ostream& operator<<( std::ostream& os, const MicroDotpHAT::POS& p );
-
-
 #endif
 
 
@@ -189,6 +189,25 @@ std::string logDev = "stdout";
 
 bool doDaemon = true;
 
+// The simulated bus.
+
+bool   doSimulate = false;
+double simSpeed   = 1.0;
+int    simLatency = 0;
+double simFaults  = 0.0;
+
+// The gas alarm levels.
+
+std::map< std::string, float > alarmLevels;
+
+// The temperature and humidity sample period.
+
+double thPeriod = 10.0;
+
+// The A/Ds' conversion-ready lines.
+
+std::vector< std::pair< std::string, unsigned >> adcAlerts;
+
 
 static const std::vector< std::string >
 toks( const std::string& s ) {
@@ -246,9 +265,33 @@ parse_opts( int argc, char** argv ) {
 
   std::string clLogDev { "default" };
   
-  while(( ch = ::getopt( argc, argv, "dhvfl:" )) != -1 ) {
+  while(( ch = ::getopt( argc, argv, "a:dg:hvfl:s:t:" )) != -1 ) {
 
     switch( ch ) {
+
+    case 'a':
+      {
+	// name=level[,name=level...]
+
+	for( const std::string& a : toks( optarg )) {
+
+	  const size_t eq    = a.find( '=' );
+	  char*        end   = nullptr;
+	  const float  level = ( eq == std::string::npos ) ? 0.0
+	    : ::strtof( a.c_str() + eq + 1, &end );
+
+	  if(( eq == std::string::npos ) || ( eq == 0 ) ||
+	     ( end == nullptr ) || ( *end != '\0' ) || ( level <= 0.0 )) {
+	    std::cerr << "Bad alarm " << quote( a ) << std::endl;
+	    usage();
+	    exit( -1 );
+	  }
+
+	  alarmLevels[ a.substr( 0, eq )] = level;
+
+	}
+      }
+      break;
       
     case 'd':
       doDebug = true;
@@ -257,6 +300,34 @@ parse_opts( int argc, char** argv ) {
     case 'f':
       doDaemon = false;
       break;
+
+    case 'g':
+      {
+	// [chip:offset][,[chip:offset]]
+
+	adcAlerts.clear();
+
+	for( const std::string& g : toks( optarg )) {
+
+	  const size_t colon  = g.rfind( ':' );
+	  char*        end    = nullptr;
+	  const long   offset = ( colon == std::string::npos ) ? -1
+	    : ::strtol( g.c_str() + colon + 1, &end, 0 );
+
+	  if( g.empty() || ( g == "sim" ))
+	    adcAlerts.push_back({ g, 0 });
+	  else
+	    if(( colon == std::string::npos ) || ( colon == 0 ) ||
+	       ( end == nullptr ) || ( *end != '\0' ) || ( offset < 0 )) {
+	      std::cerr << "Bad GPIO line " << quote( g ) << std::endl;
+	      usage();
+	      exit( -1 );
+	    } else
+	      adcAlerts.push_back({ g.substr( 0, colon ), unsigned( offset ) });
+
+	}
+      }
+      break;
       
     case 'h':
       doHelp = true;
@@ -280,6 +351,36 @@ parse_opts( int argc, char** argv ) {
     case 'v':
       doVerb = true;
       break;
+
+    case 's':
+      {
+	// speed[,latency[,fault rate]]
+
+	const std::vector< std::string > r = toks( optarg );
+
+	doSimulate = true;
+	simSpeed   = r.size() > 0 ? ::strtod( r[0].c_str(), nullptr ) : 1.0;
+	simLatency = r.size() > 1 ? ::atoi(   r[1].c_str())          : 0;
+	simFaults  = r.size() > 2 ? ::strtod( r[2].c_str(), nullptr ) : 0.0;
+
+	if(( simSpeed <= 0.0 ) || ( simLatency < 0 ) ||
+	   ( simFaults < 0.0 ) || ( simFaults > 1.0 )) {
+	  std::cerr << "Bad simulation " << quote( optarg ) << std::endl;
+	  usage();
+	  exit( -1 );
+	}
+      }
+      break;
+
+    case 't':
+      thPeriod = ::strtod( optarg, nullptr );
+
+      if( thPeriod <= 0.0 ) {
+	std::cerr << "Bad sample period " << quote( optarg ) << std::endl;
+	usage();
+	exit( -1 );
+      }
+      break;
       
     default:
       _LOG_ERR(( "Unknown option ", quote( char( ch ))));
@@ -340,7 +441,8 @@ parse_opts( int argc, char** argv ) {
 	      << ( doVerb ? " (verbose)" : "" )               << std::endl
 	      << "Help:      " << ( doHelp ? "Yes" : "No" )   << std::endl
 	      << "Daemon:    " << ( doDaemon ? "Yes" : "No" ) << std::endl
-	      << "Log:       " << logDev                      << std::endl;
+	      << "Log:       " << logDev                      << std::endl
+	      << "Simulate:  " << ( doSimulate ? "Yes" : "No" ) << std::endl;
       
   }
   
@@ -351,12 +453,21 @@ parse_opts( int argc, char** argv ) {
 void
 usage( void ) {
   std::cerr << "usage: "                                       << std::endl
+	    << " -a   Gas alarms, name=level[,name=level...]"  << std::endl
+	    << "      e.g., MQ7=200 alarms over 200 ppm CO"    << std::endl
 	    << " -d   Debug mode."                             << std::endl
 	    << " -f   Run in foreground (i.e., no daemon)"     << std::endl
+	    << " -g   A/D ALERT/RDY lines, chip:offset[,chip:offset]" << std::endl
+	    << "      0x49's then 0x48's, e.g., /dev/gpiochip0:17,"  << std::endl
+	    << "      or \"sim\". A/Ds with alarms don't use them"  << std::endl
 	    << " -h   This message"                            << std::endl
 	    << " -v   Verbose mode (Warning: VERY verbose)"    << std::endl
 	    << " -l   Log to \"syslog\" or \"stdout\""         << std::endl
 	    << "      stdout default for -f, otherwise syslog" << std::endl
+	    << " -s   Simulated i2c bus, speed[,latency[,faults]]" << std::endl
+	    << "      speed times real time, latency in usecs,"  << std::endl
+	    << "      faults the fraction of transactions failing" << std::endl
+	    << " -t   Temperature/humidity sample period, seconds" << std::endl
 	    << std::endl;  
 }
 
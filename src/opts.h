@@ -103,7 +103,9 @@ extern "C" {
   
 }
 
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 
@@ -122,6 +124,33 @@ extern std::string logDev;
 
 extern bool doDaemon;
 
+// Whether to run on the simulated i2c bus rather than the hardware,
+// how many times faster than real time, the simulated latency of a
+// transaction (microseconds), and the fraction of transactions that
+// fail.
+
+extern bool   doSimulate;
+extern double simSpeed;
+extern int    simLatency;
+extern double simFaults;
+
+// Gas alarm levels by sensor name (e.g., "MQ7"), in the sensor's
+// units (ppm or mg/L).
+
+extern std::map< std::string, float > alarmLevels;
+
+// How often the sampler measures the temperature and humidity, in
+// seconds.
+
+extern double thPeriod;
+
+// The GPIO lines the A/Ds' ALERT/RDY pins are wired to, for
+// conversion-ready wakeup, in A/D order (0x49 then 0x48): the GPIO
+// chip (e.g., "/dev/gpiochip0") and the line's offset. An empty chip
+// is no line and "sim" is the simulated bus's line.
+
+extern std::vector< std::pair< std::string, unsigned >> adcAlerts;
+
 // The routine that parses the argc/argv options.
 
 bool parse_opts( int , char**  );
@@ -74,6 +74,7 @@ extern "C" {
 }
 
 #include <chrono>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -81,6 +82,7 @@ extern "C" {
 #include <vector>
 
 #include "si7021.h"
+#include "arbiter.h"
 #include "log.h"
 #include "util.h"
 
@@ -99,22 +101,22 @@ static const std::map< float, int > heater_xlate {
 
   
 si7021::si7021( void )
-  : i2c( default_addr ) {
+  : i2c( default_addr ), myPending( 0 ) {
   
-  _check();
   _doInit();
+  _check();
 }
 
 
 si7021::si7021( const u_char addr )
-  : i2c( addr ) {
+  : i2c( addr ), myPending( 0 ) {
   
   _doInit();
 }
 
 
 si7021::si7021( const std::string& bus, const u_char addr )
-  : i2c( bus, addr ) {
+  : i2c( bus, addr ), myPending( 0 ) {
   
   _doInit();
 }
@@ -129,8 +131,18 @@ si7021::_doInit( void ) noexcept {
   bool retVal = false;
   
   if( i2c::_doInit()) {
-    
-    
+
+    // The user register is written with 0xe6 and read with 0xe7, the
+    // heater control register written with 0x51 and read with 0x11.
+
+    _shadow_reg( 0xe6, 0xe7, 0x3a );
+    _shadow_reg( 0x51, 0x11, 0x00 );
+
+    assert( _shadow_find( 0xe6 ) == SH_USER   );
+    assert( _shadow_find( 0x51 ) == SH_HEATER );
+
+    retVal = true;
+
   }
   
   return retVal;
@@ -139,6 +151,12 @@ si7021::_doInit( void ) noexcept {
   
 void
 si7021::_check( void ) noexcept {
+
+  // The checksum table is the bitwise CRC.
+
+  static_assert( crc_table[0x00] == 0x00 );
+  static_assert( crc_table[0x01] == 0x31 );
+  static_assert( crc_table[0x80] == 0x7a );
   
 #ifdef _DPG_DEBUG
   uint8_t ctrl_reg = 0x00, heater_reg = 0x00;
@@ -199,6 +217,10 @@ si7021::_check( void ) noexcept {
   
   _write_control_reg( ctrl_reg );
   _write_heater_control_reg( heater_reg );
+
+  // Those went around the shadow.
+
+  shadow_invalidate();
   
   _LOG_VERB(( "Data structures bit map tests passed" ));
 #endif
@@ -218,8 +240,12 @@ si7021::reset ( void ) {
       
       _LOG_WARN(( _id( "Unable to RESET device" ), errno2str()));
       
-    } else
+    } else {
+
+      _shadow_reset();
       rVal = 0;
+
+    }
     
     std::this_thread::sleep_for( std::chrono::milliseconds( 15 ));
     
@@ -234,74 +260,68 @@ si7021::sn( void ) const noexcept {
 
   constexpr uint8_t w_buf1[] = { 0xfa, 0x0f },
                     w_buf2[] = { 0xfc, 0xc9 };
-            uint8_t  r_buf[] = { 0x00, 0x00, 0x00, 0x00 };
+
+  // The first part is four bytes, each followed by the checksum of
+  // the serial number so far. The second part is four bytes with the
+  // checksum after every second byte.
+
+  uint8_t r_buf1[8], r_buf2[6], sn_buf[8];
 
   std::vector< uint8_t > rVal;
 
-  ssize_t w_num, r_num;
+  auto part1 = [&]( void ) {
 
-  // Lets get the first part.
-  
-  w_num = _write( w_buf1, sizeof( w_buf1 ));
-  r_num = _read(  r_buf,  sizeof( r_buf ));
-  
-  _LOG_VERB(( _id( "" ), "w=", w_num, " ", _vtoa( w_buf1, sizeof( w_buf1 ))));
-  
-  if( w_num != sizeof( w_buf1 )) {
-    
-    _LOG_WARN(( _id( "Failure to write request for part 1 of SN" ),
-		", w_num=", w_num, ", vals: ",
-		_vtoa( w_buf1, sizeof( w_buf1 )), errno2str()));
+    if( _write_read( w_buf1, sizeof( w_buf1 ), r_buf1, sizeof( r_buf1 ))
+	!= sizeof( r_buf1 ))
+      return -1;
 
-  } else 
-    if( r_num != sizeof( r_buf )) {
-      
-      _LOG_WARN(( _id( "Failure to read part 1 of SN" ),
-		  ", r_num=", r_num, errno2str()));
-      
-    } else {
-      
-      // Got the first four bytes.
-      
-      for( size_t i = 0; i < sizeof( r_buf ); ++i )
-	rVal.push_back( r_buf[i]);
-      
-      // Lets get the second part.
-      
-      w_num = _write( w_buf2, sizeof( w_buf2 ));
-      r_num = _read(  r_buf,  sizeof( r_buf ));
-      
-      if( w_num != sizeof( w_buf2 )) {
-	
-	_LOG_WARN(( _id( "Failure to write request for part 2 of SN" ),
-		    ", w_num=", w_num, ", vals: ",
-		    _vtoa( w_buf2, sizeof( w_buf2 )), errno2str()));
-	
-      } else
-	if( r_num != sizeof( r_buf )) {
-	  
-	  _LOG_WARN(( _id( "Failure to read part 2 of SN" ),
-		      ", r_num=", r_num, errno2str()));
-	  
-	} else {
-	  
-	  // Got the second four bytes.
-	  
-	  for( size_t i = 0; i < sizeof( r_buf ); ++i )
-	    rVal.push_back( r_buf[i]);
-	  
-	}
+    for( size_t i = 0; i < 4; ++i ) {
+      sn_buf[i] = r_buf1[ i * 2 ];
+      if( _crc( sn_buf, i + 1 ) != r_buf1[ i * 2 + 1 ] ) {
+	_crc_failed();
+	return -2;
+      }
     }
-  
-  // If there was an error then empty the return buffer.
-  
-  if( rVal.size() != 8 )
-    rVal.clear();
-  else
-    assert( rVal.size() == 8 );
-  
+
+    return 0;
+  };
+
+  auto part2 = [&]( void ) {
+
+    if( _write_read( w_buf2, sizeof( w_buf2 ), r_buf2, sizeof( r_buf2 ))
+	!= sizeof( r_buf2 ))
+      return -1;
+
+    sn_buf[4] = r_buf2[0];
+    sn_buf[5] = r_buf2[1];
+    sn_buf[6] = r_buf2[3];
+    sn_buf[7] = r_buf2[4];
+
+    if(( _crc( sn_buf + 4, 2 ) != r_buf2[2] ) ||
+       ( _crc( sn_buf + 4, 4 ) != r_buf2[5] )) {
+      _crc_failed();
+      return -2;
+    }
+
+    return 0;
+  };
+
+  int r;
+
+  if(( r = _retry( part1 )) != 0 ) {
+
+    _LOG_WARN(( _id( "Failure to read part 1 of SN" ), ", r=", r ));
+
+  } else
+    if(( r = _retry( part2 )) != 0 ) {
+
+      _LOG_WARN(( _id( "Failure to read part 2 of SN" ), ", r=", r ));
+
+    } else
+      rVal.assign( sn_buf, sn_buf + sizeof( sn_buf ));
+
   _LOG_VERB(( _id( "" ), "len=", rVal.size(), ", vals: ", _vtoa( rVal )));
-  
+
   return rVal;
 }
 
@@ -312,21 +332,24 @@ si7021::s_sn( void ) const noexcept {
   const std::vector< uint8_t > serial = sn();
         std::stringstream   s;
 
+  // The part is identified by SNB_3, the first byte of the second
+  // part.
+
   if( serial.size()) {
 
-    if(( serial[0] == 0x00 ) || ( serial[0] == 0xff ))
+    if(( serial[4] == 0x00 ) || ( serial[4] == 0xff ))
       s << "Engineering sample";
     else
-      if( serial[0] == 0x0d )
+      if( serial[4] == 0x0d )
 	s << "Si7013";
       else
-	if( serial[0] == 0x14 )
+	if( serial[4] == 0x14 )
 	  s << "Si7020";
 	else
-	  if( serial[0] == 0x15 )
+	  if( serial[4] == 0x15 )
 	    s << "Si7021";
 	  else
-	    s<< "Unknown=0x" << t2hex( serial[0]);
+	    s<< "Unknown=0x" << t2hex( serial[4]);
     
   }
   
@@ -338,25 +361,21 @@ si7021::firmware( void ) const noexcept {
   
   constexpr uint8_t w_buf[] = { 0x84, 0xb8 };
             uint8_t r_buf[] = { 0x00 };
+
+  // The revision is one byte and, unlike the measurements and serial
+  // number, has no checksum to check.
     
-  ssize_t w_num = _write( w_buf, sizeof( w_buf ));
-  ssize_t r_num = _read(  r_buf, sizeof( r_buf ));
+  ssize_t r_num = _write_read( w_buf, sizeof( w_buf ), r_buf, sizeof( r_buf ));
   
   uint8_t rVal = 0; /* INVALID */
   
-  if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Failure to ask for firmware revision" ),
-		", w_num=", w_num, errno2str()));
-    
-  } else 
-    if( r_num != sizeof( r_buf )) {
+  if( r_num != sizeof( r_buf )) {
       
-      _LOG_WARN(( _id( "Failure to fetch firmware revision" ),
-		  ", r_num=", r_num,  errno2str()));
+    _LOG_WARN(( _id( "Failure to fetch firmware revision" ),
+		", r_num=", r_num,  errno2str()));
       
-    } else
-      rVal = r_buf[0];
+  } else
+    rVal = r_buf[0];
   
   return rVal;
 }
@@ -405,29 +424,21 @@ si7021::_read_heater_control_reg( uint8_t& reg ) const noexcept {
 
   int32_t rVal = -1;
 
-  ssize_t w_num = _write( w_buf, sizeof( w_buf ));
-  ssize_t r_num = _read(  r_buf, sizeof( r_buf ));
+  ssize_t r_num = _write_read( w_buf, sizeof( w_buf ), r_buf, sizeof( r_buf ));
   
-  if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Failure to write ask for heater control register" ),
-		", w_num=", w_num, ", vals: ",
-		_vtoa( w_buf, sizeof( w_buf )), errno2str()));
-    
-  } else
-    if( r_num != sizeof( r_buf )) {
+  if( r_num != sizeof( r_buf )) {
       
-      _LOG_WARN(( _id( "Failure to read heater control register" ),
-		  ", r_num=", r_num, errno2str()));
+    _LOG_WARN(( _id( "Failure to read heater control register" ),
+		", r_num=", r_num, errno2str()));
       
-    } else {
+  } else {
       
-      // Return the heater control register value.
+    // Return the heater control register value.
       
-      reg = r_buf[0];
-      rVal = sizeof( r_buf );
+    reg = r_buf[0];
+    rVal = sizeof( r_buf );
       
-    }
+  }
   
   return rVal;
 }
@@ -480,30 +491,18 @@ si7021::_write_heater_control_reg( uint8_t& reg ) const noexcept {
 const bool
 si7021::heater( void ) const noexcept {
   
-  uint8_t reg = 0x00;
-  
-  (void)_read_control_reg( reg );
+  const int reg = _shadow_get( SH_USER );
   
-  return ( reg & 0b00000100 ) ? true : false;
+  return (( reg >= 0 ) && ( reg & 0b00000100 )) ? true : false;
 }
 
 
 const bool
 si7021::heater( const bool state ) const noexcept {
   
-  uint8_t reg = 0x00;
-  
-  if( _read_control_reg( reg ) > 0 ) {
-    
-    // Set or clear the heater bit.
-    
-    reg &= 0b11111011;
-    if( state )
-      reg |= 0b00000100;
-    
-    (void)_write_control_reg( reg );
-    
-  }
+  // Set or clear the heater bit.
+
+  (void)_shadow_set( SH_USER, 0b00000100, state ? 0b00000100 : 0 );
   
   return heater();
 }
@@ -512,11 +511,10 @@ si7021::heater( const bool state ) const noexcept {
 const int
 si7021::heater_level( void ) const noexcept {
   
-  int     rVal = -1;
-  uint8_t reg  = 0x00;
+  int rVal = _shadow_get( SH_HEATER );
   
-  if( _read_heater_control_reg( reg ) > 0 )
-    rVal = reg & 0b0001111;
+  if( rVal >= 0 )
+    rVal &= 0b0001111;
   
   return rVal;
 }
@@ -527,16 +525,7 @@ si7021::heater_level( const int level ) const noexcept {
   
   assert(( level >= 0 ) && ( level <= 15 ));
   
-  uint8_t reg  = 0x00;
-  
-  if( _read_heater_control_reg( reg ) > 0 ) {
-    
-    reg &= 0b11110000;
-    reg |= uint8_t( level );
-    
-    (void)_write_heater_control_reg( reg );
-    
-  }
+  (void)_shadow_set( SH_HEATER, 0b00001111, uint8_t( level ));
   
   return heater_level();
 }
@@ -581,9 +570,9 @@ const std::tuple< int, int >
 si7021::resolution( void ) const noexcept {
   
   std::tuple< int, int > rVal = { -1, -1 };
-  uint8_t                reg  = 0x00;
+  const int              reg  = _shadow_get( SH_USER );
   
-  if( _read_control_reg( reg ) > 0 ) {
+  if( reg >= 0 ) {
     
     std::get<0>( rVal ) = 0;
     std::get<1>( rVal ) = 0;
@@ -606,23 +595,12 @@ const std::tuple< int, int >
 si7021::resolution( const int rh, const int temp ) const noexcept {
   
   std::tuple< int, int > rVal = { -1, -1 };
-  uint8_t                reg  = 0x00;
+  const uint8_t          bits = ( rh ? 0b10000000 : 0 ) | ( temp ? 0b00000001 : 0 );
   
-  if( _read_control_reg( reg ) > 0 ) {
-    
-    reg &= 0b01111110;
-    
-    if( rh )
-      reg |= 0b10000000;
-    if( temp )
-      reg |= 0b00000001;
-    
-    if( _write_control_reg( reg ) > 0 )
-      rVal = resolution();
-    else
-      _LOG_WARN(( _id( "Unable to set resolution" ), rh, temp ));
-    
-  }    
+  if( _shadow_set( SH_USER, 0b10000001, bits ) >= 0 )
+    rVal = resolution();
+  else
+    _LOG_WARN(( _id( "Unable to set resolution" ), rh, temp ));
   
   return rVal;
 }
@@ -677,28 +655,15 @@ si7021::t( void ) const noexcept {
             uint8_t  r_buf[] = { 0x00, 0x00, 0x00 };
             float       rVal = -1;
 
-  ssize_t w_num = _write( w_buf, sizeof( w_buf ));
-  ssize_t r_num = _read(  r_buf, sizeof( r_buf ));
+  // The command and the read are one transaction. The device
+  // stretches the clock until the conversion is complete.
 
-  if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Unable to write temperature command" ),
-		", w_num=", w_num, ", vals: ",
-		_vtoa( w_buf, sizeof( w_buf )), errno2str()));
-    
-  } else
-    if( r_num != sizeof( r_buf )) {
-      
-      _LOG_WARN(( _id( "Failure to read temperature" ),
-		  ", r_num=", r_num, errno2str()));
-      
-    } else {
-      
-      rVal = float( u_int( r_buf[0] << 8 ) + u_int( r_buf[1]));
-      rVal *= ( 175.72 / 65536.0 );
-      rVal -= 46.85;
-      
-    }
+  const int r = _hold_read( w_buf, r_buf );
+
+  if( r == 0 )
+    rVal = _temp_c( uint16_t(( r_buf[0] << 8 ) | r_buf[1] ));
+  else
+    _LOG_WARN(( _id( "Failure to read temperature" ), ", r=", r ));
   
   _LOG_VERB(( _id( "" ), 
 	      ", w_len=", sizeof( w_buf ),
@@ -718,28 +683,15 @@ si7021::h( void ) const noexcept {
             uint8_t  r_buf[] = { 0x00, 0x00, 0x00 };
             float    rVal = -1;
 
-  ssize_t w_num = _write( w_buf, sizeof( w_buf ));
-  ssize_t r_num = _read(  r_buf, sizeof( r_buf ));
+  // The command and the read are one transaction. The device
+  // stretches the clock until the conversion is complete.
   
-  if( w_num != sizeof( w_buf )) {
-    
-    _LOG_WARN(( _id( "Unable to write humidity command" ),
-		", w_num=", w_num, ", vals: ",
-		_vtoa( w_buf, sizeof( w_buf )), errno2str()));
-    
-  } else
-    if( r_num != sizeof( r_buf )) {
-      
-      _LOG_WARN(( _id( "Failure to read humidity" ),
-		  ", r_num=", r_num, errno2str()));
-      
-    } else {
-      
-      rVal = float(( int( r_buf[0]) << 8 ) | int( r_buf[1]));
-      rVal *= ( 125.0 / 65536.0 );
-      rVal -= 6.0;
-      
-    }
+  const int r = _hold_read( w_buf, r_buf );
+
+  if( r == 0 )
+    rVal = _rh_pct( uint16_t(( r_buf[0] << 8 ) | r_buf[1] ));
+  else
+    _LOG_WARN(( _id( "Failure to read humidity" ), ", r=", r ));
   
   _LOG_VERB(( _id( "" ),
 	      ", w_len=", sizeof( w_buf ),
@@ -751,3 +703,320 @@ si7021::h( void ) const noexcept {
   return rVal;
 }
 
+
+int
+si7021::_hold_read( const uint8_t* w_buf, uint8_t* r_buf ) const noexcept {
+
+  return _retry( [&]( void ) {
+
+      if( _write_read( w_buf, 1, r_buf, 3 ) != 3 ) {
+	_LOG_VERB(( _id( "" ), errno2str()));
+	return -1;
+      }
+
+      if( _crc( r_buf, 2 ) != r_buf[2] ) {
+	_crc_failed();
+	_LOG_WARN(( _id( "Measurement checksum mismatch" ), _vtoa( r_buf, 3 )));
+	return -2;
+      }
+
+      return 0;
+    });
+}
+
+
+const std::chrono::microseconds
+si7021::conv_time( const MEASURE m ) const noexcept {
+
+  // The datasheet's maximums indexed by the user register's RES1
+  // (bit 7) and RES0 (bit 0).
+
+  static constexpr int32_t rh_us[] = { 12000, 3100, 4500, 7000 };
+  static constexpr int32_t t_us[]  = { 10800, 3800, 6200, 2400 };
+
+  std::chrono::microseconds rVal( -1 );
+  const int                 reg = _shadow_get( SH_USER );
+
+  if( reg >= 0 ) {
+
+    const int res = (( reg >> 6 ) & 0b10 ) | ( reg & 0b01 );
+
+    rVal = std::chrono::microseconds( t_us[ res ]);
+    if( m == MEASURE::RH )
+      rVal += std::chrono::microseconds( rh_us[ res ]);
+
+  } else
+    _LOG_WARN(( _id( "Unable to determine resolution" )));
+
+  return rVal;
+}
+
+
+const std::chrono::microseconds
+si7021::start( const MEASURE m ) const noexcept {
+
+  const uint8_t w_buf[] = { uint8_t(( m == MEASURE::RH ) ? 0xf5 : 0xf3 ) };
+
+  // The conversion time first since it may read the user register,
+  // which mustn't come between the command and the result.
+
+  std::chrono::microseconds rVal = conv_time( m );
+
+  myPending = 0;
+
+  if( rVal.count() >= 0 ) {
+
+    if( _write( w_buf, sizeof( w_buf )) == sizeof( w_buf ))
+      myPending = int( m );
+    else {
+      _LOG_WARN(( _id( "Failure to start measurement" ), errno2str()));
+      rVal = std::chrono::microseconds( -1 );
+    }
+  }
+
+  _LOG_VERB(( _id( "" ), "m=", int( m ), ", conv=", rVal.count()));
+
+  return rVal;
+}
+
+
+int
+si7021::collect( float& v ) const noexcept {
+
+  uint8_t r_buf[] = { 0x00, 0x00, 0x00 };
+  int     rVal    = -1;
+
+  if( myPending ) {
+
+    const ssize_t r_num = _poll_read( r_buf, sizeof( r_buf ));
+
+    if( r_num == 0 )
+      rVal = 0;
+    else {
+
+      if( r_num == sizeof( r_buf )) {
+
+	const uint16_t code = uint16_t(( r_buf[0] << 8 ) | r_buf[1] );
+
+	if( _crc( r_buf, 2 ) == r_buf[2] ) {
+
+	  v = ( myPending == int( MEASURE::RH )) ? _rh_pct( code ) : _temp_c( code );
+	  rVal = 1;
+
+	} else {
+
+	  _crc_failed();
+	  _LOG_WARN(( _id( "Measurement checksum mismatch" ),
+		      _vtoa( r_buf, sizeof( r_buf ))));
+	  rVal = -2;
+
+	}
+
+      } else
+	_LOG_WARN(( _id( "Failure to collect measurement" ),
+		    ", r_num=", r_num ));
+
+      myPending = 0;
+
+    }
+  } else
+    _LOG_WARN(( _id( "No measurement started" )));
+
+  _LOG_VERB(( _id( "" ), "ret=", rVal, ", r: ", _vtoa( r_buf, sizeof( r_buf ))));
+
+  return rVal;
+}
+
+
+const float
+si7021::convert( const MEASURE m, const arbiter::PRIORITY p ) const {
+
+  std::lock_guard< std::mutex > lck( myConvert );
+
+  float rVal = -1;
+
+  if( _retry( [&]( void ) { return _convert( m, p, rVal, nullptr ); }) != 1 )
+    rVal = -1;
+
+  return rVal;
+}
+
+
+const si7021::measurement
+si7021::measure( const arbiter::PRIORITY p ) const {
+
+  std::lock_guard< std::mutex > lck( myConvert );
+
+  measurement rVal { -1, -1, -1, std::chrono::steady_clock::time_point() };
+
+  if( _retry( [&]( void ) { return _convert( MEASURE::RH, p, rVal.h, &rVal.t ); })
+      == 1 ) {
+
+    rVal.status = 0;
+    rVal.when   = std::chrono::steady_clock::now();
+
+  } else {
+
+    rVal.t = -1;
+    rVal.h = -1;
+
+  }
+
+  _LOG_VERB(( _id( "" ), "t=", rVal.t, ", h=", rVal.h ));
+
+  return rVal;
+}
+
+
+int
+si7021::_convert( const MEASURE m, const arbiter::PRIORITY p,
+		  float& v, float* t ) const {
+
+  arbiter&   bus = arbiter::get( myBus );
+  const auto t0  = std::chrono::steady_clock::now();
+
+  const std::chrono::microseconds conv =
+    bus.submit( p, [&]( void ) { return start( m ); }).get();
+
+  if( conv.count() < 0 )
+    return -1;
+
+  // Sleep through most of the conversion then poll. Other jobs have
+  // the bus in between.
+
+  const auto deadline = t0 + 2 * conv;
+
+  std::this_thread::sleep_until( t0 + conv * poll_sleep_pct / 100 );
+
+  // The temperature of a humidity measurement is read in the same
+  // job so nothing can start another measurement in between.
+
+  auto job = [&]( void ) {
+
+    int rVal = collect( v );
+
+    if(( rVal == 1 ) && t && ( m == MEASURE::RH ))
+      rVal = ( _prev_t( *t ) == 0 ) ? 1 : -1;
+
+    return rVal;
+  };
+
+  int rVal = 0;
+
+  while(( rVal = bus.submit( p, job ).get()) == 0 ) {
+
+    if( std::chrono::steady_clock::now() >= deadline ) {
+      _LOG_WARN(( _id( "Measurement not ready in time" ), int( m )));
+      myPending = 0;
+      break;
+    }
+
+    std::this_thread::sleep_for( poll_every );
+
+  }
+
+  return rVal;
+}
+
+
+int
+si7021::_prev_t( float& t ) const noexcept {
+
+  constexpr uint8_t w_buf[] = { 0xe0 };
+	    uint8_t r_buf[] = { 0x00, 0x00 };
+	    int     rVal    = -1;
+
+  if( _write_read( w_buf, sizeof( w_buf ), r_buf, sizeof( r_buf ))
+      == sizeof( r_buf )) {
+
+    t    = _temp_c( uint16_t(( r_buf[0] << 8 ) | r_buf[1] ));
+    rVal = 0;
+
+  } else
+    _LOG_WARN(( _id( "Failure to read previous temperature" ), errno2str()));
+
+  _LOG_VERB(( _id( "" ), "ret=", rVal, ", r: ", _vtoa( r_buf, sizeof( r_buf ))));
+
+  return rVal;
+}
+
+
+//
+// si7021_cache
+//
+
+si7021_cache::si7021_cache( const si7021& d )
+  : myDev( d ), myLast { -1, -1, -1, std::chrono::steady_clock::time_point() },
+    myHits( 0 ), myMisses( 0 ) {}
+
+
+const si7021::measurement
+si7021_cache::sample( const arbiter::PRIORITY p ) {
+
+  std::lock_guard< std::mutex > lck( myRefresh );
+
+  return _refresh( p );
+}
+
+
+const si7021::measurement
+si7021_cache::get( const std::chrono::steady_clock::duration max_age,
+		   const arbiter::PRIORITY p ) {
+
+  si7021::measurement rVal;
+
+  if( _fresh( max_age, rVal ) == false ) {
+
+    std::lock_guard< std::mutex > lck( myRefresh );
+
+    // Another reader may have refreshed it while this one waited.
+
+    if( _fresh( max_age, rVal ) == false ) {
+
+      myMisses.fetch_add( 1, std::memory_order_relaxed );
+
+      return _refresh( p );
+    }
+  }
+
+  myHits.fetch_add( 1, std::memory_order_relaxed );
+
+  return rVal;
+}
+
+
+const si7021::measurement
+si7021_cache::last( void ) const noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  return myLast;
+}
+
+
+bool
+si7021_cache::_fresh( const std::chrono::steady_clock::duration max_age,
+		      si7021::measurement& m ) const noexcept {
+
+  m = last();
+
+  return ( m.status == 0 )
+    && (( std::chrono::steady_clock::now() - m.when ) <= max_age );
+}
+
+
+const si7021::measurement
+si7021_cache::_refresh( const arbiter::PRIORITY p ) {
+
+  const si7021::measurement rVal = myDev.measure( p );
+
+  if( rVal.status == 0 ) {
+
+    std::lock_guard< std::mutex > lck( myLock );
+
+    myLast = rVal;
+
+  }
+
+  return rVal;
+}
@@ -60,12 +60,18 @@ extern "C" {
   
 }
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <vector>
 
+#include "arbiter.h"
 #include "i2c.h"
 #include "log.h"
+#include "templates.h"
 #include "util.h"
 
 
@@ -79,6 +85,62 @@ private:
   // The default address of the device.
   
   inline static constexpr u_char default_addr = 0x40;
+
+  // The user (control) and heater control registers are kept in the
+  // i2c shadow registers, at these indexes.
+
+  inline static constexpr int SH_USER = 0, SH_HEATER = 1;
+
+  // convert() sleeps this much of the worst case conversion time
+  // off the bus, about the typical time, then polls every
+  // poll_every until twice the worst case.
+
+  inline static constexpr int                       poll_sleep_pct = 75;
+  inline static constexpr std::chrono::microseconds poll_every{ 500 };
+
+  // The no hold measurement started (zero if none) and the lock that
+  // keeps a convert() from interleaving with another.
+
+  mutable int        myPending;
+  mutable std::mutex myConvert;
+
+  // Conversions from the measurement codes.
+
+  static constexpr float _temp_c( const uint16_t code ) noexcept;
+  static constexpr float _rh_pct( const uint16_t code ) noexcept;
+
+  // The checksum sent with measurements and the serial number, x^8 +
+  // x^5 + x^4 + 1 initialized to zero, by table.
+
+  inline static constexpr std::array< uint8_t, 256 > crc_table =
+    crc8_table< 0x31 >();
+
+  static constexpr uint8_t _crc( const uint8_t* buf, const size_t len ) noexcept;
+
+  // A read failing its checksum is made again until retry_for has
+  // passed since the first try. A try started before then finishes,
+  // so a read takes no longer than retry_for plus one try.
+  //
+  // _retry() calls f, which returns -2 on a checksum failure, until
+  // it returns anything else or the time is up, and returns what f
+  // last returned.
+
+  inline static constexpr std::chrono::milliseconds retry_for{ 50 };
+
+  template< typename F >
+  int _retry( F&& f ) const;
+
+  // A hold master measurement: write the one byte command and read
+  // the three byte result, checking the checksum. Returns 0, -2 on
+  // a checksum failure, or -1 on any other error.
+
+  int _hold_read( const uint8_t* w_buf, uint8_t* r_buf ) const noexcept;
+
+  // The temperature measured with the last humidity measurement
+  // (0xE0), which is no conversion and no checksum. Returns 0 or -1
+  // on error.
+
+  int _prev_t( float& t ) const noexcept;
   
   // Check certain data structures for consistency and assert() if
   // something doesn't make sense.
@@ -193,17 +255,172 @@ public:
   // use clock stretching to allow the device to indicate when
   // conversion is completed rather than try to be efficient with the
   // bus (and over complicate) by adaptive delay between write/read
-  // against conversion width.
+  // against conversion width. The bus is held for the whole
+  // conversion, up to 23 ms for humidity, so see convert().
     
   const float t( void ) const noexcept,
               h( void ) const noexcept;
 
+  // No hold master measurements: start the conversion, let the bus
+  // go, and collect the result later. The device NAKs its address
+  // until the conversion is done.
+  //
+  // start():     Send the measure command. Returns the worst case
+  //              conversion time at the current resolution or a
+  //              negative duration on error.
+  // collect():   Read the result of the started measurement. Returns
+  //              1 and sets v when done, 0 while still converting, -2
+  //              when the result fails its checksum, and -1 on
+  //              error.
+  // conv_time(): The datasheet worst case conversion time at the
+  //              current resolution. A humidity measurement includes
+  //              a temperature one. Negative on error.
+  // convert():   start() and collect() as jobs on the bus's arbiter at
+  //              priority p with the waits off the bus, measuring
+  //              again on a checksum failure. Returns the value or -1
+  //              on error. Because it waits on the
+  //              arbiter, convert() MUST NOT be called from an arbiter
+  //              job.
+
+  enum class MEASURE : int { TEMP = 1, RH };
+
+  const std::chrono::microseconds start( const MEASURE m ) const noexcept;
+  int                             collect( float& v ) const noexcept;
+
+  const std::chrono::microseconds conv_time( const MEASURE m ) const noexcept;
+
+  const float convert( const MEASURE m, const arbiter::PRIORITY p ) const;
+
+  // Humidity and the temperature measured with it from one no hold
+  // conversion, the way convert() does it, and when the result was
+  // read. The temperature is read with 0xE0 so it costs a short
+  // transaction rather than a second conversion.
+
+  struct measurement {
+    float                                 t;      // C
+    float                                 h;      // %RH
+    int                                   status; // 0 or -1
+    std::chrono::steady_clock::time_point when;
+  };
+
+  const measurement measure( const arbiter::PRIORITY p ) const;
+
   // Convert Celsius to Fahrenheit.
   
   const float c_to_f( const float c ) const noexcept;
-  
+
+private:
+
+  // convert() without the lock. When t isn't null and m is RH, the
+  // job collecting the humidity also reads the temperature measured
+  // with it. Returns 1 on success.
+
+  int _convert( const MEASURE m, const arbiter::PRIORITY p,
+		float& v, float* t ) const;
+
 };
 
+// A cache of a Si7021's measurements. The sampler refreshes it at its
+// own pace and readers take the cached measurement, so readers cost no
+// bus time unless the measurement is older than they will accept.
+//
+// sample():        Measure at priority p and cache the result. A
+//                  failed measurement isn't cached.
+// get():           The cached measurement if it is no older than
+//                  max_age, otherwise a new one measured at priority
+//                  p. Readers finding it stale at the same time share
+//                  one measurement.
+// last():          The cached measurement however old. Its status is
+//                  -1 if there is none.
+// hits()/misses(): The number of get()s answered from the cache and
+//                  from the bus.
+//
+// sample() and get() wait on the arbiter so they MUST NOT be called
+// from an arbiter job.
+
+class si7021_cache {
+
+public:
+
+  explicit si7021_cache( const si7021& d );
+
+  si7021_cache( const si7021_cache&  c ) = delete;
+  si7021_cache( const si7021_cache&& c ) = delete;
+
+  si7021_cache& operator=( const si7021_cache&  c ) = delete;
+  si7021_cache& operator=( const si7021_cache&& c ) = delete;
+
+  const si7021::measurement sample( const arbiter::PRIORITY p );
+  const si7021::measurement get( const std::chrono::steady_clock::duration max_age,
+				 const arbiter::PRIORITY p );
+  const si7021::measurement last( void ) const noexcept;
+
+  uint64_t hits(   void ) const noexcept;
+  uint64_t misses( void ) const noexcept;
+
+private:
+
+  // The device, the cached measurement and its lock, and the lock
+  // that makes refreshing the cache one measurement at a time.
+
+  const si7021&         myDev;
+  mutable std::mutex    myLock;
+  si7021::measurement   myLast;
+  std::mutex            myRefresh;
+  std::atomic< uint64_t > myHits, myMisses;
+
+  bool                      _fresh( const std::chrono::steady_clock::duration max_age,
+				    si7021::measurement& m ) const noexcept;
+  const si7021::measurement _refresh( const arbiter::PRIORITY p );
+
+};
+
+
+inline
+constexpr float
+si7021::_temp_c( const uint16_t code ) noexcept {
+
+  return float(( double( code ) * ( 175.72 / 65536.0 )) - 46.85 );
+}
+
+
+inline
+constexpr float
+si7021::_rh_pct( const uint16_t code ) noexcept {
+
+  return float(( double( code ) * ( 125.0 / 65536.0 )) - 6.0 );
+}
+
+
+inline
+constexpr uint8_t
+si7021::_crc( const uint8_t* buf, const size_t len ) noexcept {
+
+  uint8_t rVal = 0;
+
+  for( size_t i = 0; i < len; ++i )
+    rVal = crc_table[ rVal ^ buf[i]];
+
+  return rVal;
+}
+
+
+template< typename F >
+int
+si7021::_retry( F&& f ) const {
+
+  const auto deadline = std::chrono::steady_clock::now() + retry_for;
+
+  int rVal;
+
+  while((( rVal = f()) == -2 )
+	&& ( std::chrono::steady_clock::now() < deadline ))
+    _LOG_VERB(( _id( "Checksum failure, trying again" )));
+
+  return rVal;
+}
+
+
 inline
 const float
 si7021::c_to_f( const float c ) const noexcept {
@@ -212,6 +429,22 @@ si7021::c_to_f( const float c ) const noexcept {
 }
 
 
+inline
+uint64_t
+si7021_cache::hits( void ) const noexcept {
+
+  return myHits.load( std::memory_order_relaxed );
+}
+
+
+inline
+uint64_t
+si7021_cache::misses( void ) const noexcept {
+
+  return myMisses.load( std::memory_order_relaxed );
+}
+
+
 #endif
 
 
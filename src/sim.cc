@@ -0,0 +1,1246 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019, Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * $Log$
+ *
+ */
+
+
+extern "C" {
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sim.h"
+
+
+extern const std::vector< std::string > sim_ident {
+  _SIM_H_ID, "$Id$"
+};
+
+
+//
+// sim_ads1015
+//
+
+sim_ads1015::sim_ads1015( const int16_t addr, source src )
+  : sim_device( addr ), mySource( src ), myPtr( 0 ), myConv( 0 ),
+    myCfg( cfg_default & ~cfg_os ), myNext( 0 ), myPending( false ),
+    myLo( 0x8000 ), myHi( 0x7fff ),
+    myBusy( false ), myDone( 0 ), myConvs( 0 ), myEdges( 0 ),
+    myEdgeAt( 0 ), myAsserted( false ) {}
+
+
+bool
+sim_ads1015::_rdy( void ) const noexcept {
+
+  return (( myCfg & 0x0003 ) != 0x0003 )
+    && ( myHi & 0x8000 ) && (( myLo & 0x8000 ) == 0 );
+}
+
+
+sim_device::time
+sim_ads1015::_conv_time( void ) const noexcept {
+
+  static constexpr int rates[] { 128, 250, 490, 920, 1600, 2400, 3300, 3300 };
+
+  return time( 1000000000 / rates[( myCfg >> 5 ) & 0x07 ] );
+}
+
+
+uint16_t
+sim_ads1015::_convert( const time t ) const noexcept {
+
+  // The multiplexer's positive and negative inputs, -1 being GND,
+  // and the PGA's full scale.
+
+  static constexpr int    pos[] {  0,  0,  1,  2,  0,  1,  2,  3 };
+  static constexpr int    neg[] {  1,  3,  3,  3, -1, -1, -1, -1 };
+  static constexpr double fs[]  { 6.144, 4.096, 2.048, 1.024,
+				  0.512, 0.256, 0.256, 0.256 };
+
+  const int    mux  = ( myCfg >> 12 ) & 0x07;
+  const double secs = std::chrono::duration< double >( t ).count();
+  const double v    = mySource( pos[ mux ], secs ) -
+		      (( neg[ mux ] < 0 ) ? 0.0 : mySource( neg[ mux ], secs ));
+
+  long code = std::lround( v / fs[( myCfg >> 9 ) & 0x07 ] * 2048.0 );
+
+  code = std::clamp( code, -2048L, 2047L );
+
+  // 12 bits, left justified.
+
+  return uint16_t( uint16_t( int16_t( code )) << 4 );
+}
+
+
+void
+sim_ads1015::_update( const time now ) noexcept {
+
+  if( myBusy && ( now >= myDone )) {
+
+    if( myCfg & cfg_mode ) {
+
+      // Single shot, back to sleep.
+
+      myConv = _convert( myDone );
+      myBusy = false;
+      ++myConvs;
+
+      _compare( myDone, 1 );
+
+    } else
+      if( myPending ) {
+
+	// Continuous with a config written since the conversion
+	// began. It completes as it began, then the new config
+	// starts a conversion (if continuous or OS was written).
+
+	myConv = _convert( myDone );
+	++myConvs;
+
+	_compare( myDone, 1 );
+
+	myCfg     = myNext & ~cfg_os;
+	myPending = false;
+
+	if((( myCfg & cfg_mode ) == 0 ) || ( myNext & cfg_os )) {
+	  myDone += _conv_time();
+	  _update( now );
+	} else
+	  myBusy = false;
+
+      } else {
+
+	// Continuous, the latest conversion completed is in the
+	// conversion register and the next is under way.
+
+	const time conv = _conv_time();
+	const auto n    = ( now - myDone ) / conv;
+
+	myConv   = _convert( myDone + n * conv );
+
+	_compare( myDone + n * conv, n + 1 );
+
+	myDone  += ( n + 1 ) * conv;
+	myConvs += n + 1;
+
+      }
+  }
+}
+
+
+bool
+sim_ads1015::write( const uint8_t* buf, const size_t len,
+		    const time now ) noexcept {
+
+  _update( now );
+
+  if( len == 0 )
+    return true;
+
+  myPtr = buf[0] & 0x03;
+
+  if( len >= 3 ) {
+
+    const uint16_t v = uint16_t(( buf[1] << 8 ) | buf[2] );
+
+    switch( myPtr ) {
+
+    case 0:  // The conversion register is read only.
+      break;
+
+    case 1:
+
+      // Writing OS starts a single shot conversion. Entering
+      // continuous mode starts conversions. A continuous
+      // conversion under way finishes first.
+
+      if( myBusy && (( myCfg & cfg_mode ) == 0 )) {
+	myNext    = v;
+	myPending = true;
+	break;
+      }
+
+      myCfg = v & ~cfg_os;
+
+      if((( myCfg & cfg_mode ) == 0 ) || ( v & cfg_os )) {
+	myBusy = true;
+	myDone = now + _conv_time();
+      }
+      break;
+
+    case 2:
+      myLo = v;
+      break;
+
+    case 3:
+      myHi = v;
+      break;
+
+    }
+  }
+
+  return true;
+}
+
+
+// n conversions just completed, the last at time at and now in the
+// conversion register. Only the last is compared.
+
+void
+sim_ads1015::_compare( const time at, const uint64_t n ) noexcept {
+
+  if( _rdy()) {
+
+    myEdges   += n;
+    myEdgeAt   = at;
+    myAsserted = false;
+
+  } else
+    if(( myCfg & 0x0003 ) != 0x0003 ) {
+
+      const int16_t c  = int16_t( myConv );
+      const int16_t lo = int16_t( myLo );
+      const int16_t hi = int16_t( myHi );
+      bool          a  = myAsserted;
+
+      if( myCfg & 0x0010 )
+	a = ( c > hi ) || ( c < lo );  // Window
+      else
+	if( c > hi )                   // Traditional, with hysteresis
+	  a = true;
+	else
+	  if( c <= lo )
+	    a = false;
+
+      if( a && !myAsserted ) {
+	++myEdges;
+	myEdgeAt = at;
+      }
+
+      myAsserted = a;
+
+    } else
+      myAsserted = false;
+
+}
+
+
+bool
+sim_ads1015::alert( const time now, uint64_t& edges,
+		    time& last, time& next ) noexcept {
+
+  _update( now );
+
+  edges = myEdges;
+  last  = myEdgeAt;
+  next  = (( myCfg & 0x0003 ) != 0x0003 ) && myBusy ? myDone : time( -1 );
+
+  return true;
+}
+
+
+bool
+sim_ads1015::read( uint8_t* buf, const size_t len,
+		   const time now, time& stretch ) noexcept {
+
+  _update( now );
+  stretch = time( 0 );
+
+  uint16_t v = 0;
+
+  switch( myPtr ) {
+
+  case 0:
+    v = myConv;
+    break;
+
+  case 1:
+    v = (( myPending ? myNext : myCfg ) & ~cfg_os ) | ( myBusy ? 0 : cfg_os );
+    break;
+
+  case 2:
+    v = myLo;
+    break;
+
+  case 3:
+    v = myHi;
+    break;
+
+  }
+
+  // MSB first and the register repeats if read further.
+
+  for( size_t i = 0; i < len; ++i )
+    buf[i] = ( i & 0x01 ) ? uint8_t( v & 0xff ) : uint8_t( v >> 8 );
+
+  return true;
+}
+
+
+//
+// sim_si7021
+//
+
+sim_si7021::sim_si7021( const int16_t addr, source temp, source rh )
+  : sim_device( addr ), myTemp( temp ), myRH( rh ),
+    myPending( PENDING::NONE ), myHold( false ), myDone( 0 ),
+    myTempCode( 0 ), myRHCode( 0 ), myUser( 0x3a ), myHeater( 0x00 ) {}
+
+
+uint8_t
+sim_si7021::crc( const uint8_t* buf, const size_t len ) noexcept {
+
+  // x^8 + x^5 + x^4 + 1, initialized to zero.
+
+  uint8_t rVal = 0;
+
+  for( size_t i = 0; i < len; ++i ) {
+
+    rVal ^= buf[i];
+
+    for( int b = 0; b < 8; ++b )
+      rVal = ( rVal & 0x80 ) ? uint8_t(( rVal << 1 ) ^ 0x31 ) : uint8_t( rVal << 1 );
+
+  }
+
+  return rVal;
+}
+
+
+double
+sim_si7021::_temp( const time t ) const noexcept {
+
+  // The heater warms the part, more at higher currents.
+
+  double rVal = myTemp( std::chrono::duration< double >( t ).count());
+
+  if( myUser & 0x04 )
+    rVal += 1.0 + 0.5 * double( myHeater & 0x0f );
+
+  return rVal;
+}
+
+
+bool
+sim_si7021::write( const uint8_t* buf, const size_t len,
+		   const time now ) noexcept {
+
+  if( len == 0 )
+    return true;
+
+  bool rVal = true;
+
+  switch( buf[0] ) {
+
+  case 0xe5:  // Measure RH, which also measures temperature.
+  case 0xf5:
+    myPending = PENDING::RH;
+    myHold    = buf[0] == 0xe5;
+    myDone    = now + rh_time + temp_time;
+    break;
+
+  case 0xe3:  // Measure temperature.
+  case 0xf3:
+    myPending = PENDING::TEMP;
+    myHold    = buf[0] == 0xe3;
+    myDone    = now + temp_time;
+    break;
+
+  case 0xe0:
+    myPending = PENDING::PREV_TEMP;
+    break;
+
+  case 0xe6:
+    if( len >= 2 )
+      myUser = buf[1];
+    myPending = PENDING::NONE;
+    break;
+
+  case 0xe7:
+    myPending = PENDING::USER;
+    break;
+
+  case 0x51:
+    if( len >= 2 )
+      myHeater = buf[1] & 0x0f;
+    myPending = PENDING::NONE;
+    break;
+
+  case 0x11:
+    myPending = PENDING::HEATER;
+    break;
+
+  case 0xfe:
+    myUser    = 0x3a;
+    myHeater  = 0x00;
+    myPending = PENDING::NONE;
+    break;
+
+  case 0xfa:
+    rVal      = ( len >= 2 ) && ( buf[1] == 0x0f );
+    myPending = rVal ? PENDING::SN_A : PENDING::NONE;
+    break;
+
+  case 0xfc:
+    rVal      = ( len >= 2 ) && ( buf[1] == 0xc9 );
+    myPending = rVal ? PENDING::SN_B : PENDING::NONE;
+    break;
+
+  case 0x84:
+    rVal      = ( len >= 2 ) && ( buf[1] == 0xb8 );
+    myPending = rVal ? PENDING::FW : PENDING::NONE;
+    break;
+
+  default:
+    rVal      = false;
+    myPending = PENDING::NONE;
+
+  }
+
+  return rVal;
+}
+
+
+bool
+sim_si7021::read( uint8_t* buf, const size_t len,
+		  const time now, time& stretch ) noexcept {
+
+  // The serial number, Si7021 in SNB_3.
+
+  static constexpr uint8_t sna[] { 0x12, 0x34, 0x56, 0x78 };
+  static constexpr uint8_t snb[] { 0x15, 0xff, 0xff, 0xff };
+
+  uint8_t out[8];
+  size_t  o_len = 0;
+
+  stretch = time( 0 );
+
+  switch( myPending ) {
+
+  case PENDING::TEMP:
+  case PENDING::RH:
+    {
+      // Still converting, hold SCL low or NAK.
+
+      if( now < myDone ) {
+
+	if( myHold == false )
+	  return false;
+
+	stretch = myDone - now;
+
+      }
+
+      const double t = _temp( myDone );
+
+      myTempCode = uint16_t
+	( std::clamp( std::lround(( t + 46.85 ) * 65536.0 / 175.72 ),
+		      0L, 65535L ) & 0xfffc );
+
+      uint16_t code = myTempCode;
+
+      if( myPending == PENDING::RH ) {
+
+	const double rh =
+	  myRH( std::chrono::duration< double >( myDone ).count());
+
+	code = myRHCode = uint16_t
+	  ( std::clamp( std::lround(( rh + 6.0 ) * 65536.0 / 125.0 ),
+			0L, 65535L ) & 0xfffc );
+
+      }
+
+      out[0] = uint8_t( code >> 8 );
+      out[1] = uint8_t( code & 0xff );
+      out[2] = crc( out, 2 );
+      o_len  = 3;
+
+      myPending = PENDING::NONE;
+    }
+    break;
+
+  case PENDING::PREV_TEMP:
+
+    // No checksum.
+
+    out[0] = uint8_t( myTempCode >> 8 );
+    out[1] = uint8_t( myTempCode & 0xff );
+    o_len  = 2;
+    break;
+
+  case PENDING::USER:
+    out[0] = myUser;
+    o_len  = 1;
+    break;
+
+  case PENDING::HEATER:
+    out[0] = myHeater;
+    o_len  = 1;
+    break;
+
+  case PENDING::SN_A:
+
+    // Each byte followed by the CRC of the bytes so far.
+
+    for( int i = 0; i < 4; ++i ) {
+      out[ i * 2 ]     = sna[i];
+      out[ i * 2 + 1 ] = crc( sna, i + 1 );
+    }
+    o_len = 8;
+    break;
+
+  case PENDING::SN_B:
+    out[0] = snb[0];
+    out[1] = snb[1];
+    out[2] = crc( snb, 2 );
+    out[3] = snb[2];
+    out[4] = snb[3];
+    out[5] = crc( snb, 4 );
+    o_len  = 6;
+    break;
+
+  case PENDING::FW:
+    out[0] = 0x20;
+    o_len  = 1;
+    break;
+
+  case PENDING::NONE:
+    return false;
+
+  }
+
+  for( size_t i = 0; i < len; ++i )
+    buf[i] = ( i < o_len ) ? out[i] : 0xff;
+
+  return true;
+}
+
+
+//
+// sim_is31fl3730
+//
+
+sim_is31fl3730::sim_is31fl3730( const int16_t addr )
+  : sim_device( addr ), myUpdates( 0 ), myWritten( 0 ) {
+
+  _reset();
+
+}
+
+
+void
+sim_is31fl3730::_reset( void ) noexcept {
+
+  myRegs.fill( 0 );
+
+  for( auto& m : myShown )
+    m.fill( 0 );
+
+}
+
+
+bool
+sim_is31fl3730::write( const uint8_t* buf, const size_t len,
+		       const time now ) noexcept {
+
+  // The register address auto-increments.
+
+  for( size_t i = 1; i < len; ++i ) {
+
+    const size_t r = size_t( buf[0] ) + i - 1;
+
+    if( r > 0xff )
+      break;
+
+    ++myWritten;
+
+    if( r == 0xff )
+      _reset();
+    else {
+
+      myRegs[r] = buf[i];
+
+      if( r == 0x0c ) {
+
+	std::copy( &myRegs[ 0x01 ], &myRegs[ 0x0c ], myShown[0].begin());
+	std::copy( &myRegs[ 0x0e ], &myRegs[ 0x19 ], myShown[1].begin());
+	++myUpdates;
+
+      }
+    }
+  }
+
+  return true;
+}
+
+
+bool
+sim_is31fl3730::read( uint8_t* buf, const size_t len,
+		      const time now, time& stretch ) noexcept {
+
+  stretch = time( 0 );
+
+  return false;
+}
+
+
+//
+// i2c_sim
+//
+
+i2c_sim::i2c_sim( const double speed )
+  : mySpeed( speed > 0.0 ? speed : 1.0 ),
+    myStart( std::chrono::steady_clock::now()), myNextFD( first_fd ),
+    myLatency( 0 ), myFaultRate( 0.0 ), myRand( std::random_device()()),
+    myXacts( 0 ), myFaults( 0 ) {}
+
+
+std::shared_ptr< i2c_sim >
+i2c_sim::attic( const double speed ) {
+
+  static const std::string bus = "/dev/i2c-1";
+
+  auto rVal = std::make_shared< i2c_sim >( speed );
+
+  // Something slowly wandering about a value, so plots have
+  // something in them.
+
+  auto drift = []( const double base, const double amp,
+		   const double period, const double t ) {
+    return base + amp * std::sin( 2.0 * M_PI * t / period );
+  };
+
+  // ad1: MQ2, MQ3, MQ4, MQ6.
+
+  rVal->add( bus, std::make_shared< sim_ads1015 >
+	     ( 0x49, [drift]( const int ain, const double t ) {
+	       static constexpr double base[] { 0.55, 0.35, 0.60, 0.50 };
+	       return drift( base[ ain ], 0.05, 300.0 + 60.0 * ain, t );
+	     }));
+
+  // ad2: MQ7, MQ9, GND, and Vdd.
+
+  rVal->add( bus, std::make_shared< sim_ads1015 >
+	     ( 0x48, [drift]( const int ain, const double t ) {
+	       switch( ain ) {
+	       case 0:  return drift( 0.90, 0.10, 420.0, t );
+	       case 1:  return drift( 0.70, 0.05, 360.0, t );
+	       case 2:  return 0.0;
+	       default: return drift( 4.95, 0.02, 90.0, t );
+	       }
+	     }));
+
+  // The attic, warmer and drier in the afternoon.
+
+  rVal->add( bus, std::make_shared< sim_si7021 >
+	     ( 0x40,
+	       [drift]( const double t ) { return drift( 28.0, 6.0, 86400.0, t ); },
+	       [drift]( const double t ) { return drift( 45.0, -10.0, 86400.0, t ); }
+	       ));
+
+  // The Micro Dot pHAT.
+
+  for( const int16_t a : { 0x61, 0x62, 0x63 } )
+    rVal->add( bus, std::make_shared< sim_is31fl3730 >( a ));
+
+  return rVal;
+}
+
+
+void
+i2c_sim::add( const std::string& bus, std::shared_ptr< sim_device > d ) {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  myBuses[ bus ][ d->addr()] = d;
+}
+
+
+// A device's alert output. Between edges it sleeps until the next
+// one is due, or a little while when none is, as a write may start
+// one.
+
+class i2c_sim::pin : public alert_line {
+
+public:
+
+  pin( std::shared_ptr< i2c_sim > sim, std::shared_ptr< sim_device > dev )
+    : mySim( sim ), myDev( dev ), mySeen( 0 ) {}
+
+  int flush( void ) noexcept override {
+
+    uint64_t         edges = 0;
+    sim_device::time last, next;
+
+    if( !_poll( edges, last, next ))
+      return -1;
+
+    const int rVal = int( edges - mySeen );
+
+    mySeen = edges;
+
+    return rVal;
+  }
+
+  int wait( const std::chrono::microseconds        timeout,
+	    std::chrono::steady_clock::time_point& when ) noexcept override {
+
+    constexpr std::chrono::microseconds idle( 100 );
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while( true ) {
+
+      uint64_t         edges = 0;
+      sim_device::time last, next;
+
+      if( !_poll( edges, last, next ))
+	return -1;
+
+      if( edges > mySeen ) {
+	mySeen = edges;
+	when   = mySim->_real( last );
+	return 1;
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+
+      if( now >= deadline )
+	return 0;
+
+      auto until = std::min( deadline, now + idle );
+
+      if( next.count() >= 0 )
+	until = std::min( deadline, mySim->_real( next ));
+
+      std::this_thread::sleep_until( until );
+
+    }
+  }
+
+private:
+
+  std::shared_ptr< i2c_sim >    mySim;
+  std::shared_ptr< sim_device > myDev;
+  uint64_t                      mySeen;
+
+  bool _poll( uint64_t& edges, sim_device::time& last,
+	      sim_device::time& next ) noexcept {
+
+    std::lock_guard< std::mutex > lck( mySim->myLock );
+
+    return myDev->alert( mySim->now(), edges, last, next );
+  }
+
+};
+
+
+std::shared_ptr< alert_line >
+i2c_sim::alert( const std::string& bus, const int16_t addr ) {
+
+  std::shared_ptr< sim_device > d;
+
+  {
+    std::lock_guard< std::mutex > lck( myLock );
+
+    const auto b = myBuses.find( bus );
+
+    if( b != myBuses.end())
+      if( const auto it = b->second.find( addr ); it != b->second.end())
+	d = it->second;
+  }
+
+  std::shared_ptr< alert_line > rVal;
+  uint64_t                      edges;
+  sim_device::time              last, next;
+
+  if( d && d->alert( now(), edges, last, next ))
+    rVal = std::make_shared< pin >( shared_from_this(), d );
+
+  return rVal;
+}
+
+
+std::chrono::steady_clock::time_point
+i2c_sim::_real( const sim_device::time t ) const noexcept {
+
+  return myStart + std::chrono::duration_cast
+    < std::chrono::steady_clock::duration >
+    ( std::chrono::duration< double, std::nano >( double( t.count()) / mySpeed ));
+}
+
+
+void
+i2c_sim::latency( const std::chrono::microseconds l ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  myLatency = l;
+}
+
+
+void
+i2c_sim::fault_rate( const double r ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  myFaultRate = std::clamp( r, 0.0, 1.0 );
+}
+
+
+void
+i2c_sim::fail( const int16_t addr, const unsigned n ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  myFail[ addr ] = n;
+}
+
+
+void
+i2c_sim::corrupt( const int16_t addr, const unsigned n ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  myCorrupt[ addr ] = n;
+}
+
+
+double
+i2c_sim::speed( void ) const noexcept {
+
+  return mySpeed;
+}
+
+
+sim_device::time
+i2c_sim::now( void ) const noexcept {
+
+  return std::chrono::duration_cast< sim_device::time >
+    (( std::chrono::steady_clock::now() - myStart ) * mySpeed );
+}
+
+
+uint64_t
+i2c_sim::transactions( void ) const noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  return myXacts;
+}
+
+
+uint64_t
+i2c_sim::faults( void ) const noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  return myFaults;
+}
+
+
+void
+i2c_sim::_sleep( const sim_device::time d ) const noexcept {
+
+  if( d.count() > 0 )
+    std::this_thread::sleep_for
+      ( std::chrono::duration< double, std::nano >( double( d.count()) / mySpeed ));
+
+}
+
+
+i2c_sim::handle*
+i2c_sim::_handle( const int fd ) noexcept {
+
+  auto it = myFDs.find( fd );
+
+  return ( it == myFDs.end()) ? nullptr : &it->second;
+}
+
+
+sim_device*
+i2c_sim::_device( const handle& h, const int16_t addr ) noexcept {
+
+  // Whether the device answers this time.
+
+  if( auto it = myFail.find( addr ); it != myFail.end() && it->second ) {
+    --it->second;
+    ++myFaults;
+    return nullptr;
+  }
+
+  if(( myFaultRate > 0.0 ) &&
+     ( std::uniform_real_distribution< double >( 0.0, 1.0 )( myRand ) < myFaultRate )) {
+    ++myFaults;
+    return nullptr;
+  }
+
+  const devices& devs = myBuses[ h.bus ];
+  const auto     it   = devs.find( addr );
+
+  return ( it == devs.end()) ? nullptr : it->second.get();
+}
+
+
+void
+i2c_sim::_garble( const int16_t addr, uint8_t* buf, const size_t len ) noexcept {
+
+  if( auto it = myCorrupt.find( addr ); it != myCorrupt.end() && it->second
+      && len ) {
+    --it->second;
+    buf[0] ^= 0x01;
+  }
+}
+
+
+bool
+i2c_sim::_begin( const int16_t addr ) noexcept {
+
+  ++myXacts;
+  _sleep( myLatency );
+
+  return ( addr >= 0 ) && ( addr <= 0x7f );
+}
+
+
+bool
+i2c_sim::exists( const std::string& bus ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  return myBuses.count( bus ) != 0;
+}
+
+
+int
+i2c_sim::open( const std::string& bus ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  if( myBuses.count( bus ) == 0 ) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  const int rVal = myNextFD++;
+
+  myFDs[ rVal ] = { bus, -1 };
+
+  return rVal;
+}
+
+
+int
+i2c_sim::close( const int fd ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  if( myFDs.erase( fd ) == 0 ) {
+    errno = EBADF;
+    return -1;
+  }
+
+  return 0;
+}
+
+
+int
+i2c_sim::ioctl( const int fd, const unsigned long req, void* arg ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  handle* h = _handle( fd );
+
+  if( h == nullptr ) {
+    errno = EBADF;
+    return -1;
+  }
+
+  int rVal = -1;
+
+  switch( req ) {
+
+  case I2C_FUNCS:
+    *static_cast< unsigned long* >( arg ) = I2C_FUNC_I2C | I2C_FUNC_SMBUS_EMUL;
+    rVal = 0;
+    break;
+
+  case I2C_SLAVE:
+  case I2C_SLAVE_FORCE:
+    {
+      const intptr_t addr = reinterpret_cast< intptr_t >( arg );
+
+      if(( addr < 0 ) || ( addr > 0x7f ))
+	errno = EINVAL;
+      else {
+	h->bound = int16_t( addr );
+	rVal     = 0;
+      }
+    }
+    break;
+
+  case I2C_RETRIES:
+  case I2C_TIMEOUT:
+    rVal = 0;
+    break;
+
+  case I2C_RDWR:
+    rVal = _rdwr( *h, arg );
+    break;
+
+  case I2C_SMBUS:
+    rVal = _smbus( *h, arg );
+    break;
+
+  default:
+    errno = ENOTTY;
+
+  }
+
+  return rVal;
+}
+
+
+int
+i2c_sim::_rdwr( handle& h, void* arg ) noexcept {
+
+  const auto* data = static_cast< const i2c_rdwr_ioctl_data* >( arg );
+
+  if(( data == nullptr ) || ( data->nmsgs == 0 ) ||
+     ( data->nmsgs > I2C_RDWR_IOCTL_MAX_MSGS )) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // Like the Pi's adapter, a read MUST be the last message.
+
+  for( __u32 i = 0; i + 1 < data->nmsgs; ++i )
+    if( data->msgs[i].flags & I2C_M_RD ) {
+      errno = EOPNOTSUPP;
+      return -1;
+    }
+
+  if( _begin( int16_t( data->msgs[0].addr )) == false ) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  for( __u32 i = 0; i < data->nmsgs; ++i ) {
+
+    const i2c_msg& m  = data->msgs[i];
+    sim_device*    d  = _device( h, int16_t( m.addr ));
+    bool           ok = d != nullptr;
+
+    if( ok ) {
+
+      if( m.flags & I2C_M_RD ) {
+
+	sim_device::time stretch( 0 );
+
+	ok = d->read( m.buf, m.len, now(), stretch );
+	_sleep( stretch );
+
+	if( ok )
+	  _garble( int16_t( m.addr ), m.buf, m.len );
+
+      } else
+	ok = d->write( m.buf, m.len, now());
+
+    }
+
+    if( ok == false ) {
+      errno = EREMOTEIO;
+      return -1;
+    }
+  }
+
+  return int( data->nmsgs );
+}
+
+
+int
+i2c_sim::_smbus( handle& h, void* arg ) noexcept {
+
+  auto* data = static_cast< i2c_smbus_ioctl_data* >( arg );
+
+  if(( data == nullptr ) || ( _begin( h.bound ) == false )) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  sim_device*      d  = _device( h, h.bound );
+  sim_device::time stretch( 0 );
+  bool             ok = d != nullptr;
+
+  if( ok ) {
+
+    const bool rd = data->read_write == I2C_SMBUS_READ;
+
+    switch( data->size ) {
+
+    case I2C_SMBUS_QUICK:
+      ok = d->quick();
+      break;
+
+    case I2C_SMBUS_BYTE:
+      if( rd )
+	ok = d->read( &data->data->byte, 1, now(), stretch );
+      else
+	ok = d->write( &data->command, 1, now());
+      break;
+
+    case I2C_SMBUS_BYTE_DATA:
+      if( rd )
+	ok = d->write( &data->command, 1, now()) &&
+	     d->read( &data->data->byte, 1, now(), stretch );
+      else {
+	const uint8_t w_buf[] { data->command, data->data->byte };
+	ok = d->write( w_buf, sizeof( w_buf ), now());
+      }
+      break;
+
+    case I2C_SMBUS_WORD_DATA:
+
+      // LSB first on the wire.
+
+      if( rd ) {
+
+	uint8_t r_buf[2];
+
+	ok = d->write( &data->command, 1, now()) &&
+	     d->read( r_buf, sizeof( r_buf ), now(), stretch );
+	data->data->word = __u16( r_buf[0] | ( r_buf[1] << 8 ));
+
+      } else {
+
+	const uint8_t w_buf[] { data->command,
+				uint8_t( data->data->word & 0xff ),
+				uint8_t( data->data->word >> 8 ) };
+	ok = d->write( w_buf, sizeof( w_buf ), now());
+
+      }
+      break;
+
+    default:
+      errno = EOPNOTSUPP;
+      return -1;
+
+    }
+  }
+
+  _sleep( stretch );
+
+  if( ok == false ) {
+    errno = EREMOTEIO;
+    return -1;
+  }
+
+  return 0;
+}
+
+
+ssize_t
+i2c_sim::read( const int fd, void* buf, const size_t len ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  handle* h = _handle( fd );
+
+  if( h == nullptr ) {
+    errno = EBADF;
+    return -1;
+  }
+
+  if( _begin( h->bound ) == false ) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  sim_device*      d = _device( *h, h->bound );
+  sim_device::time stretch( 0 );
+
+  if(( d == nullptr ) ||
+     ( d->read( static_cast< uint8_t* >( buf ), len, now(), stretch ) == false )) {
+    errno = EREMOTEIO;
+    return -1;
+  }
+
+  _sleep( stretch );
+  _garble( h->bound, static_cast< uint8_t* >( buf ), len );
+
+  return ssize_t( len );
+}
+
+
+ssize_t
+i2c_sim::write( const int fd, const void* buf, const size_t len ) noexcept {
+
+  std::lock_guard< std::mutex > lck( myLock );
+
+  handle* h = _handle( fd );
+
+  if( h == nullptr ) {
+    errno = EBADF;
+    return -1;
+  }
+
+  if( _begin( h->bound ) == false ) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  sim_device* d = _device( *h, h->bound );
+
+  if(( d == nullptr ) ||
+     ( d->write( static_cast< const uint8_t* >( buf ), len, now()) == false )) {
+    errno = EREMOTEIO;
+    return -1;
+  }
+
+  return ssize_t( len );
+}
+
+
+// LocalWords:  RDWR SMBus NAK NAKed EREMOTEIO
@@ -0,0 +1,356 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019, Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * $Log$
+ *
+ */
+
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+extern "C" {
+
+#include <sys/types.h>
+
+}
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+
+#include "gpio.h"
+#include "transport.h"
+
+
+#define _SIM_H_ID "$Id$"
+
+
+// A device on the simulated bus. The bus calls write() and read()
+// for each message addressed to the device, passing the simulated
+// time (since the simulation started). Either returns false to NAK
+// the message.
+//
+// A read can stretch the clock (e.g., a Si7021 hold master
+// measurement) by setting stretch to how long the device holds SCL
+// low before the data is valid; the bus waits that long.
+
+class sim_device {
+
+public:
+
+  typedef std::chrono::nanoseconds time;
+
+  explicit sim_device( const int16_t addr ) : myAddr( addr ) {}
+  virtual ~sim_device( void ) {}
+
+  int16_t addr( void ) const noexcept { return myAddr; }
+
+  virtual bool write( const uint8_t* buf, const size_t len,
+		      const time now ) noexcept = 0;
+  virtual bool read(  uint8_t* buf, const size_t len,
+		      const time now, time& stretch ) noexcept = 0;
+
+  // An SMBus quick write. Nearly everything ACKs one.
+
+  virtual bool quick( void ) noexcept { return true; }
+
+  // The device's alert output, for devices with one, brought up to
+  // now: the number of edges so far, when the last was, and when the
+  // next is due (negative if none is). Returns false if the device
+  // has no alert output.
+
+  virtual bool alert( const time now, uint64_t& edges,
+		      time& last, time& next ) noexcept {
+    (void)now; (void)edges; (void)last; (void)next;
+    return false;
+  }
+
+private:
+
+  const int16_t myAddr;
+
+};
+
+
+// An ADS1015 ADC: the pointer, conversion, config, and threshold
+// registers, single-shot and continuous modes, and a conversion
+// time set by the data rate. A config write during a continuous
+// conversion takes effect as that conversion completes, so it
+// completes with the old input. The input voltages come from a
+// function of the input (AIN0 - AIN3) and the simulated time in
+// seconds. The ALERT/RDY pin's conversion-ready function (the HI
+// threshold's MSB set, the LO threshold's clear, and the comparator
+// queue enabled) pulses at the end of each conversion. Otherwise,
+// with the queue enabled, the comparator (traditional or window)
+// asserts it on the first conversion out of bounds. The queue's
+// count and latching are ignored.
+
+class sim_ads1015 : public sim_device {
+
+public:
+
+  typedef std::function< double( const int ain, const double t ) > source;
+
+  sim_ads1015( const int16_t addr, source src );
+
+  bool write( const uint8_t* buf, const size_t len,
+	      const time now ) noexcept override;
+  bool read(  uint8_t* buf, const size_t len,
+	      const time now, time& stretch ) noexcept override;
+  bool alert( const time now, uint64_t& edges,
+	      time& last, time& next ) noexcept override;
+
+  // Conversions completed, for tests and benchmarks.
+
+  uint64_t conversions( void ) const noexcept { return myConvs; }
+
+private:
+
+  inline static constexpr uint16_t cfg_default = 0x8583;
+  inline static constexpr uint16_t cfg_os      = 0x8000;
+  inline static constexpr uint16_t cfg_mode    = 0x0100;
+
+  source   mySource;
+  uint8_t  myPtr;
+  uint16_t myConv;
+  uint16_t myCfg;
+  uint16_t myNext;     // written during a continuous conversion
+  bool     myPending;
+  uint16_t myLo;
+  uint16_t myHi;
+  bool     myBusy;
+  time     myDone;
+  uint64_t myConvs;
+  uint64_t myEdges;
+  time     myEdgeAt;
+  bool     myAsserted;
+
+  bool     _rdy( void ) const noexcept;
+  void     _compare( const time at, const uint64_t n ) noexcept;
+  time     _conv_time( void ) const noexcept;
+  uint16_t _convert( const time t ) const noexcept;
+  void     _update( const time now ) noexcept;
+
+};
+
+
+// A Si7021 humidity and temperature sensor: the hold and no hold
+// master measurement commands with their conversion times, reading
+// the temperature of the previous RH measurement, the user and
+// heater registers, reset, the serial number, and the firmware
+// revision, with CRCs where the part sends them. In no hold mode a
+// read before the measurement completes is NAKed.
+
+class sim_si7021 : public sim_device {
+
+public:
+
+  // The environment: temperature (C) and relative humidity (%) as a
+  // function of the simulated time in seconds.
+
+  typedef std::function< double( const double t ) > source;
+
+  sim_si7021( const int16_t addr, source temp, source rh );
+
+  bool write( const uint8_t* buf, const size_t len,
+	      const time now ) noexcept override;
+  bool read(  uint8_t* buf, const size_t len,
+	      const time now, time& stretch ) noexcept override;
+
+  static uint8_t crc( const uint8_t* buf, const size_t len ) noexcept;
+
+private:
+
+  enum class PENDING { NONE, TEMP, RH, PREV_TEMP, USER, HEATER,
+		       SN_A, SN_B, FW };
+
+  inline static constexpr std::chrono::microseconds temp_time { 10800 };
+  inline static constexpr std::chrono::microseconds rh_time   { 12000 };
+
+  source   myTemp;
+  source   myRH;
+  PENDING  myPending;
+  bool     myHold;
+  time     myDone;
+  uint16_t myTempCode;
+  uint16_t myRHCode;
+  uint8_t  myUser;
+  uint8_t  myHeater;
+
+  double   _temp( const time t ) const noexcept;
+
+};
+
+
+// An IS31FL3730 LED matrix driver. It's write only - reads are
+// NAKed. Writes auto-increment the register address and a write to
+// the update register latches the matrix registers to the display.
+
+class sim_is31fl3730 : public sim_device {
+
+public:
+
+  explicit sim_is31fl3730( const int16_t addr );
+
+  bool write( const uint8_t* buf, const size_t len,
+	      const time now ) noexcept override;
+  bool read(  uint8_t* buf, const size_t len,
+	      const time now, time& stretch ) noexcept override;
+
+  // Updates latched and data bytes written, for tests and benchmarks.
+
+  uint64_t updates( void ) const noexcept { return myUpdates; }
+  uint64_t written( void ) const noexcept { return myWritten; }
+
+  // What is displayed, matrix 1 and 2.
+
+  const std::array< uint8_t, 11 >& matrix( const int m ) const noexcept {
+    return myShown[ m ? 1 : 0 ];
+  }
+
+private:
+
+  std::array< uint8_t, 256 >                  myRegs;
+  std::array< std::array< uint8_t, 11 >, 2 >  myShown;
+  uint64_t                                    myUpdates;
+  uint64_t                                    myWritten;
+
+  void _reset( void ) noexcept;
+
+};
+
+
+// A simulated i2c-dev transport. Buses are names (e.g.,
+// "/dev/i2c-1") with devices on them and descriptors are handles
+// onto a bus. The adapter supports plain i2c (I2C_RDWR) and SMBus
+// emulation (quick, byte, byte data, and word data), and rejects a
+// read anywhere but last in an I2C_RDWR, as the Pi's adapter does.
+//
+// Simulated time runs speed times faster than real time. Every
+// transaction costs the configured latency (in simulated time) and
+// a clock stretch costs its length, both slept in real time divided
+// by speed. Faults fail a transaction with EREMOTEIO, as a NAK does:
+// at random at fault_rate (0 - 1) or the next n to an address. The
+// next n plain reads from an address can be corrupted too, a bit
+// flipped, for checking checksums.
+//
+// Transactions on the simulated bus are serialized, like a real bus.
+//
+// alert() is a device's alert output (e.g., an ADS1015's ALERT/RDY)
+// as an alert_line, reporting edges at their real time.
+
+class i2c_sim : public i2c_transport,
+		public std::enable_shared_from_this< i2c_sim > {
+
+public:
+
+  explicit i2c_sim( const double speed = 1.0 );
+
+  // The attic: two ADS1015s, a Si7021, and a Micro Dot pHAT on
+  // /dev/i2c-1.
+
+  static std::shared_ptr< i2c_sim > attic( const double speed = 1.0 );
+
+  void add( const std::string& bus, std::shared_ptr< sim_device > d );
+
+  std::shared_ptr< alert_line > alert( const std::string& bus,
+				       const int16_t addr );
+
+  void latency(    const std::chrono::microseconds l  ) noexcept;
+  void fault_rate( const double                    r  ) noexcept;
+  void fail(       const int16_t addr, const unsigned n ) noexcept;
+  void corrupt(    const int16_t addr, const unsigned n ) noexcept;
+
+  double            speed( void ) const noexcept;
+  sim_device::time  now(   void ) const noexcept;
+
+  uint64_t transactions( void ) const noexcept;
+  uint64_t faults(       void ) const noexcept;
+
+  bool    exists( const std::string& bus ) noexcept override;
+  int     open(   const std::string& bus ) noexcept override;
+  int     close(  const int fd           ) noexcept override;
+
+  int     ioctl( const int fd, const unsigned long req,
+		 void* arg ) noexcept override;
+  ssize_t read(  const int fd, void* buf,
+		 const size_t len ) noexcept override;
+  ssize_t write( const int fd, const void* buf,
+		 const size_t len ) noexcept override;
+
+private:
+
+  typedef std::map< int16_t, std::shared_ptr< sim_device >> devices;
+
+  struct handle {
+    std::string bus;
+    int16_t     bound;
+  };
+
+  class pin;
+
+  // Fake descriptors start well clear of real ones to make mix ups
+  // obvious.
+
+  inline static constexpr int first_fd = 1000;
+
+  mutable std::mutex                    myLock;
+  const double                          mySpeed;
+  const std::chrono::steady_clock::time_point myStart;
+  std::map< std::string, devices >      myBuses;
+  std::map< int, handle >               myFDs;
+  int                                   myNextFD;
+  std::chrono::microseconds             myLatency;
+  double                                myFaultRate;
+  std::map< int16_t, unsigned >         myFail;
+  std::map< int16_t, unsigned >         myCorrupt;
+  std::mt19937                          myRand;
+  uint64_t                              myXacts;
+  uint64_t                              myFaults;
+
+  handle*     _handle( const int fd ) noexcept;
+  sim_device* _device( const handle& h, const int16_t addr ) noexcept;
+  bool        _begin(  const int16_t addr ) noexcept;
+  void        _garble( const int16_t addr, uint8_t* buf,
+		       const size_t len ) noexcept;
+  void        _sleep(  const sim_device::time d ) const noexcept;
+
+  std::chrono::steady_clock::time_point _real( const sim_device::time t )
+    const noexcept;
+
+  int         _rdwr(  handle& h, void* arg ) noexcept;
+  int         _smbus( handle& h, void* arg ) noexcept;
+
+};
+
+
+#endif
@@ -46,9 +46,14 @@ extern "C" {
   
 }
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <functional>
-#include <map>
+#include <initializer_list>
 #include <memory>
+#include <type_traits>
+#include <vector>
 
 
 #define _TEMPLATES_H_ID "$Id: templates.h,v 1.2 2019/10/20 04:39:37 root Exp $"
@@ -56,78 +61,279 @@ extern "C" {
 
 //***************************************************************************
 
-// The templates in this section are used in the _check() routines and
-// exist only when the code is compiled for debugging.
+// Register fields.
+//
+// A field is WIDTH bits starting at bit OFFSET of a register of type
+// V along with what each bit pattern of the field means. The meaning
+// is an enumeration holding _NONE in addition to the specific values
+// (the _x enumerations in the device classes), for example:
+//
+//   enum class FILTER_x : int { _NONE = -1, _MASK = -2, OFF = 1, x2, x4 };
+//
+//   inline static constexpr field< FILTER_x, uint8_t, 2, 3 > FILTER_FIELD {{
+//     { FILTER_x::OFF, 0b000 },
+//     { FILTER_x::x2,  0b001 },
+//     { FILTER_x::x4,  0b010 }
+//   }};
+//
+// The codes are the field's bits shifted down to bit zero. The
+// compiler builds two tables, code to key and key to code, so
+// decode() and encode() are an index and a shift rather than a
+// search and there's nothing to build at run time. A pattern that
+// isn't in the table decodes to _NONE and a key that isn't in the
+// table encodes to zero bits.
+//
+// Keys MUST be in [0,max_keys) and both keys and codes MUST be
+// unique. ok() says whether they are, and _disjoint() whether the
+// fields of a register overlap, both for static_assert().
 
+template< typename K, typename V, unsigned OFFSET, unsigned WIDTH >
+class field {
 
-// enum class A { aa, bb, cc, ... }
-// enum class B { aa, bb, cc, ... }
-//
-//  const std::map< A, uint16_t > A_MAP {
-//    { A::aa,    0b0010000000000000 },
-//    { A:bb,     0b0110000000000000 },
-//    { A:cc,     0b1010000000000000 },
-//    ...
-//    { A::_MASK, 0b1110000000000000 }
-//  };
-//  const std::map< B, uint16_t > A_MAP {
-//    { B::aa,    0b0000000000100000 },
-//    { B:bb,     0b0000000000010000 },                                      
-//    { B:cc,     0b0000000000001000 },
-//    ...
-//    { B::_MASK, 0b0000000000111000 }
-//  };
-
-// The declarations above are used to represent bit maps in a single
-// register. The _check_masking() routine goes through a bit map and
-// tests whether there are any bit settings outside the mask.
-
-template< typename K, typename V >
-inline
-void
-_check_masking( const std::map< K, V >& m ) {
-#ifdef _DPG_DEBUG
-  
-  // The map size MUST always be greater than zero (i.e., there MUST
-  // be something to map).
-  
-  assert( m.size());
-  
-  // Test:
-  // 1, If I mask the bits against the mask's complement then
-  //    there shouldn't be any extraneous bits set.
-  // 2, If I mask the bits against the mask then the result MUST
-  //    be the bits.
-  
-  const V mask = m.at( K::_MASK );
-  for( const auto& [tag,value] : m )
-    if(( tag != K::_NONE ) && ( tag != K::_MASK )) {
-	assert(( value & ~mask ) == 0 );
-	assert(( value & mask ) == value );
+public:
+
+  static_assert( std::is_enum_v< K > && std::is_unsigned_v< V > );
+  static_assert(( WIDTH > 0 ) && (( OFFSET + WIDTH ) <= ( 8 * sizeof( V ))));
+
+  using key_type   = K;
+  using value_type = V;
+
+  inline static constexpr unsigned offset   = OFFSET;
+  inline static constexpr unsigned width    = WIDTH;
+  inline static constexpr V        mask     =
+    V((( 1u << WIDTH ) - 1u ) << OFFSET );
+  inline static constexpr size_t   max_keys = 16;
+
+  struct entry {
+    K        key;
+    unsigned code;
+  };
+
+  template< size_t N >
+  constexpr field( const entry (&e)[N] ) noexcept
+    : myKeys{}, myCodes{}, myOk( N > 0 ) {
+
+    for( auto& k : myKeys )
+      k = K::_NONE;
+    for( auto& c : myCodes )
+      c = -1;
+
+    for( size_t i = 0; i < N; ++i ) {
+
+      const int k = int( e[i].key );
+
+      if(( k < 0 ) || ( size_t( k ) >= max_keys )
+	 || ( e[i].code >= myKeys.size())
+	 || ( myCodes[k] >= 0 ) || ( myKeys[ e[i].code ] != K::_NONE ))
+	myOk = false;
+      else {
+	myKeys[ e[i].code ] = e[i].key;
+	myCodes[ k ]        = int( e[i].code );
       }
-  
-#endif
+    }
+  }
+
+  constexpr bool ok( void ) const noexcept { return myOk; }
+
+  // The key of the field's bits in reg, or _NONE.
+
+  constexpr K decode( const V reg ) const noexcept {
+
+    return myKeys[( reg & mask ) >> OFFSET ];
+  }
+
+  // The field's bits for k, in place, or zero.
+
+  constexpr V encode( const K k ) const noexcept {
+
+    const int i = int( k );
+
+    return (( i >= 0 ) && ( size_t( i ) < max_keys ) && ( myCodes[i] >= 0 ))
+      ? V( unsigned( myCodes[i] ) << OFFSET ) : V( 0 );
+  }
+
+  // reg with the field replaced by k's bits.
+
+  constexpr V set( const V reg, const K k ) const noexcept {
+
+    return V(( reg & ~mask ) | encode( k ));
+  }
+
+private:
+
+  std::array< K,   ( 1u << WIDTH ) > myKeys;
+  std::array< int, max_keys        > myCodes;
+  bool                               myOk;
+
+};
+
+
+// The union of a register's field masks, or zero if any two fields
+// share a bit:
+//
+//   static_assert( _disjoint< uint8_t >({ A_FIELD.mask, B_FIELD.mask }));
+
+template< typename V >
+constexpr
+V
+_disjoint( std::initializer_list< V > masks ) noexcept {
+
+  V seen = 0;
+
+  for( const V m : masks ) {
+    if( seen & m )
+      return 0;
+    seen |= m;
+  }
+
+  return seen;
 }
 
-// The declarations above are used to represent bit maps in a single
-// register. The _check_bit_overlap() routine goes through both bit
-// maps and tests whether there are any bit overlaps (i.e., two
-// different maps that manipulate the same bit(s)).
+//***************************************************************************
+
+// A single producer, single consumer ring. Neither side locks or
+// blocks: push() drops what doesn't fit, counting it as an overrun,
+// and pop() returns false when there's nothing. The storage,
+// capacity rounded up to a power of two, is allocated once when the
+// ring is built. One thread pushes and one thread pops.
 
-template< typename A, typename B >
-inline
-void _check_bit_overlap( const A& a, const B& b ) {
-#ifdef _DPG_DEBUG
-  
-  // Test:
-  // 1, Two different function bit maps exist in the same register
-  //    but the bits in each map MUST not overlap.
-  
-  for( auto& i : a )
-    for( auto& j : b )
-      assert(( i.second & j.second ) == 0 );
+template< typename T >
+class spsc_ring {
 
-#endif
+public:
+
+  explicit spsc_ring( const size_t capacity );
+
+  spsc_ring( const spsc_ring&  r ) = delete;
+  spsc_ring( const spsc_ring&& r ) = delete;
+
+  spsc_ring& operator=( const spsc_ring&  r ) = delete;
+  spsc_ring& operator=( const spsc_ring&& r ) = delete;
+
+  bool push( const T& t ) noexcept;
+  bool pop(        T& t ) noexcept;
+
+  size_t   size(     void ) const noexcept;
+  size_t   capacity( void ) const noexcept;
+  uint64_t overruns( void ) const noexcept;
+
+private:
+
+  // The head is the producer's, the tail the consumer's. They only
+  // grow and are kept apart so the two sides don't share a cache
+  // line.
+
+  std::vector< T >                    myBuf;
+  const size_t                        myMask;
+  alignas( 64 ) std::atomic< size_t > myHead;
+  alignas( 64 ) std::atomic< size_t > myTail;
+  std::atomic< uint64_t >             myOverruns;
+
+  static size_t _pow2( const size_t n ) noexcept {
+    size_t p = 1;
+    while( p < n )
+      p <<= 1;
+    return p;
+  }
+
+};
+
+
+template< typename T >
+spsc_ring< T >::spsc_ring( const size_t capacity )
+  : myBuf( _pow2( capacity )), myMask( myBuf.size() - 1 ),
+    myHead( 0 ), myTail( 0 ), myOverruns( 0 ) {}
+
+
+template< typename T >
+bool
+spsc_ring< T >::push( const T& t ) noexcept {
+
+  const size_t head = myHead.load( std::memory_order_relaxed );
+
+  if( head - myTail.load( std::memory_order_acquire ) > myMask ) {
+    myOverruns.fetch_add( 1, std::memory_order_relaxed );
+    return false;
+  }
+
+  myBuf[ head & myMask ] = t;
+  myHead.store( head + 1, std::memory_order_release );
+
+  return true;
+}
+
+
+template< typename T >
+bool
+spsc_ring< T >::pop( T& t ) noexcept {
+
+  const size_t tail = myTail.load( std::memory_order_relaxed );
+
+  if( tail == myHead.load( std::memory_order_acquire ))
+    return false;
+
+  t = myBuf[ tail & myMask ];
+  myTail.store( tail + 1, std::memory_order_release );
+
+  return true;
+}
+
+
+template< typename T >
+size_t
+spsc_ring< T >::size( void ) const noexcept {
+
+  return myHead.load( std::memory_order_acquire )
+    - myTail.load( std::memory_order_acquire );
+}
+
+
+template< typename T >
+size_t
+spsc_ring< T >::capacity( void ) const noexcept {
+
+  return myMask + 1;
+}
+
+
+template< typename T >
+uint64_t
+spsc_ring< T >::overruns( void ) const noexcept {
+
+  return myOverruns.load( std::memory_order_relaxed );
+}
+
+//***************************************************************************
+
+// CRC-8, MSB first, of polynomial POLY (without the x^8 term), e.g.,
+// 0x31 for x^8 + x^5 + x^4 + 1. The table is built by the compiler,
+// one entry per byte value, so a checksum is one lookup and one XOR
+// per byte:
+//
+//   inline static constexpr std::array< uint8_t, 256 > table = crc8_table< 0x31 >();
+//
+//   uint8_t c = 0;
+//   for( ... )
+//     c = table[ c ^ byte ];
+
+template< uint8_t POLY >
+constexpr std::array< uint8_t, 256 >
+crc8_table( void ) noexcept {
+
+  std::array< uint8_t, 256 > rVal {};
+
+  for( unsigned i = 0; i < 256; ++i ) {
+
+    uint8_t c = uint8_t( i );
+
+    for( int b = 0; b < 8; ++b )
+      c = ( c & 0x80 ) ? uint8_t(( c << 1 ) ^ POLY ) : uint8_t( c << 1 );
+
+    rVal[i] = c;
+
+  }
+
+  return rVal;
 }
 
 //***************************************************************************
@@ -0,0 +1,91 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019, Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * $Log$
+ *
+ */
+
+extern "C" {
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+#include <sys/types.h>
+
+}
+
+#include <string>
+#include <vector>
+
+#include "transport.h"
+
+
+extern const std::vector< std::string > transport_ident {
+  _TRANSPORT_H_ID, "$Id$"
+};
+
+
+bool
+i2c_linux::exists( const std::string& bus ) noexcept {
+
+  return ::access( bus.c_str(), F_OK ) == 0;
+}
+
+
+int
+i2c_linux::open( const std::string& bus ) noexcept {
+
+  return ::open( bus.c_str(), O_RDWR );
+}
+
+
+int
+i2c_linux::close( const int fd ) noexcept {
+
+  return ::close( fd );
+}
+
+
+int
+i2c_linux::ioctl( const int fd, const unsigned long req, void* arg ) noexcept {
+
+  return ::ioctl( fd, req, arg );
+}
+
+
+ssize_t
+i2c_linux::read( const int fd, void* buf, const size_t len ) noexcept {
+
+  return ::read( fd, buf, len );
+}
+
+
+ssize_t
+i2c_linux::write( const int fd, const void* buf, const size_t len ) noexcept {
+
+  return ::write( fd, buf, len );
+}
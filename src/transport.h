@@ -0,0 +1,100 @@
+/* -*- c++ -*- */
+
+/*
+ * Copyright (c) 2019, Dennis Glatting.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * $Log$
+ *
+ */
+
+#ifndef __TRANSPORT_H__
+#define __TRANSPORT_H__
+
+extern "C" {
+
+#include <sys/types.h>
+
+}
+
+#include <string>
+
+
+#define _TRANSPORT_H_ID "$Id$"
+
+
+// What the i2c code sits on. The interface is the handful of
+// i2c-dev system calls the i2c code makes, with the same arguments,
+// return values, and errno conventions, so the i2c code reads the
+// same whichever transport is underneath:
+//
+//   exists() - whether a bus (e.g., "/dev/i2c-1") exists.
+//   open()   - open a bus, returns a descriptor or -1.
+//   close()  - close a descriptor.
+//   ioctl()  - I2C_FUNCS, I2C_SLAVE, I2C_RDWR, and I2C_SMBUS.
+//   read()   - read from the I2C_SLAVE bound address.
+//   write()  - write to the I2C_SLAVE bound address.
+//
+// i2c_linux is the real thing. i2c_sim (sim.h) is a simulated bus.
+
+class i2c_transport {
+
+public:
+
+  virtual ~i2c_transport( void ) {}
+
+  virtual bool    exists( const std::string& bus ) noexcept = 0;
+  virtual int     open(   const std::string& bus ) noexcept = 0;
+  virtual int     close(  const int fd           ) noexcept = 0;
+
+  virtual int     ioctl( const int fd, const unsigned long req,
+			 void* arg ) noexcept = 0;
+  virtual ssize_t read(  const int fd, void* buf,
+			 const size_t len ) noexcept = 0;
+  virtual ssize_t write( const int fd, const void* buf,
+			 const size_t len ) noexcept = 0;
+
+};
+
+
+// The Linux i2c-dev transport.
+
+class i2c_linux : public i2c_transport {
+
+public:
+
+  bool    exists( const std::string& bus ) noexcept override;
+  int     open(   const std::string& bus ) noexcept override;
+  int     close(  const int fd           ) noexcept override;
+
+  int     ioctl( const int fd, const unsigned long req,
+		 void* arg ) noexcept override;
+  ssize_t read(  const int fd, void* buf,
+		 const size_t len ) noexcept override;
+  ssize_t write( const int fd, const void* buf,
+		 const size_t len ) noexcept override;
+
+};
+
+
+#endif
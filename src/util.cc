@@ -181,6 +181,7 @@ extern "C" {
 #include <mntent.h>
 #include <netdb.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -196,6 +197,7 @@ extern "C" {
 #include <map>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <random>
 #include <regex>
 #include <set>
@@ -439,5 +441,81 @@ paren( const char* s ) {
 
 
 
+// The per-thread counter behind alloc_count(). The replacement
+// operators allocate with malloc() and release with free(), exactly
+// as the library versions do, so they only add the count.
+
+static thread_local size_t allocations = 0;
+
+
+size_t
+alloc_count( void ) noexcept {
+
+  return allocations;
+}
+
+
+void*
+operator new( size_t n ) {
+
+  ++allocations;
+
+  if( void* p = ::malloc( n ? n : 1 ))
+    return p;
+
+  throw std::bad_alloc();
+}
+
+
+void*
+operator new[]( size_t n ) {
+
+  return operator new( n );
+}
+
+
+void*
+operator new( size_t n, const std::nothrow_t& ) noexcept {
+
+  ++allocations;
+
+  return ::malloc( n ? n : 1 );
+}
+
+
+void*
+operator new[]( size_t n, const std::nothrow_t& t ) noexcept {
+
+  return operator new( n, t );
+}
+
+
+void
+operator delete( void* p ) noexcept {
+
+  ::free( p );
+}
+
+
+void
+operator delete[]( void* p ) noexcept {
+
+  ::free( p );
+}
+
+
+void
+operator delete( void* p, size_t ) noexcept {
+
+  ::free( p );
+}
+
+
+void
+operator delete[]( void* p, size_t ) noexcept {
+
+  ::free( p );
+}
+
 // LocalWords:  endl IPv URI SQLite
 
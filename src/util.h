@@ -324,6 +324,29 @@ _bit_shift_right( int s ) {
 }
 
 
+// Transpose an 8x8 bit matrix held one row per byte, byte 0 the
+// least significant: bit c of byte r moves to bit r of byte c. The
+// three steps swap 1x1, 2x2, then 4x4 blocks across the diagonal
+// (Hacker's Delight, 7-3).
+
+inline constexpr
+uint64_t
+_transpose8x8( uint64_t x ) {
+
+  x = ( x & 0xaa55aa55aa55aa55ULL ) |
+    (( x & 0x00aa00aa00aa00aaULL ) << 7 ) |
+    (( x >> 7 ) & 0x00aa00aa00aa00aaULL );
+  x = ( x & 0xcccc3333cccc3333ULL ) |
+    (( x & 0x0000cccc0000ccccULL ) << 14 ) |
+    (( x >> 14 ) & 0x0000cccc0000ccccULL );
+  x = ( x & 0xf0f0f0f00f0f0f0fULL ) |
+    (( x & 0x00000000f0f0f0f0ULL ) << 28 ) |
+    (( x >> 28 ) & 0x00000000f0f0f0f0ULL );
+
+  return x;
+}
+
+
 
 // Return a thing inside parenthesis.
 
@@ -339,6 +362,14 @@ const std::string paren( const char* );
 const std::string paren( const std::string& );
 
 
+// Heap allocation accounting. util.cc replaces the global operator
+// new and counts every allocation made by the calling thread. Take
+// the difference across a section of code to show that the section
+// is (or isn't) allocation free.
+
+size_t alloc_count( void ) noexcept;
+
+
 // Template used to create a std::unique_ptr<> with a custom deleter
 
 template< typename T >